@@ -4,6 +4,7 @@
 #include "GLwinDefs.h"
 #include "GLwinTime.h"
 #include "GLwinDialog.h"
+#include "GLwinContext.h"
 
 
 #ifdef __cplusplus
@@ -21,15 +22,24 @@ extern "C" {
 	// ------------------------------------------  End HWND ------------------------------------------
 
     // Window creation & destruction
+    // Any number of windows can be open, each with its own context, swap interval and the hints
+    // in effect when it was created. Closing a window (WM_CLOSE) only makes GLwinWindowShouldClose
+    // return true; destroy it when you're done with it. Windows belong to the creating thread.
     GLWIN_window* GLwin_CreateWindow(int width, int height, const wchar_t* title);
     void GLwin_DestroyWindow(GLWIN_window* window);
+    // Open windows in creation order; the array is valid until a window is created or destroyed
+    GLWIN_window** GLwinGetWindows(int* count);
 	// Enable or disable custom title bar
     void GLwinEnableCustomTitleBar(GLWIN_window* window, int enable);
 
     // Window/context management
+    // Returns straight away if the window's context is already current on this thread
     void GLwinMakeContextCurrent(GLWIN_window* window);
-	void* GLwinGetProcAddress(const char* procname);
+    // Window whose context is current on this thread, or NULL
+    GLWIN_window* GLwinGetCurrentContext(void);
+    // GLwinGetProcAddress and the worker contexts are in GLwinContext.h
     void GLwinSwapBuffers(GLWIN_window* window);
+    // Dispatches pending messages to every window of the calling thread
     void GLwinPollEvents(void);
     //int  GLwinWindowShouldClose(GLWIN_window* window);
     bool GLwinWindowShouldClose(GLWIN_window* window, bool close);
@@ -37,9 +47,25 @@ extern "C" {
 	void GLwinMinimizeWindow(GLWIN_window* window);
 	void GLwinMaximizeWindow(GLWIN_window* window);
 
-    // Window hints (Maximize, Resizeabel, Done)
-   //TO DO GLWIN_CONTEXT_VERSION_MAJOR, GLWIN_CONTEXT_VERSION_MINOR, GLWIN_OPENGL_PROFILE, GLWIN_OPENGL_CORE_PROFILE
+    // Window hints, applied by the next GLwin_CreateWindow
+    //   GLWIN_MAXIMIZED, GLWIN_RESIZABLE
+    //   GLWIN_SCALE_TO_MONITOR              default on: the size passed is at 96 DPI and gets scaled
+    //                                       to the monitor's DPI; off: the size is in pixels
+    //   GLWIN_CONTEXT_VERSION_MAJOR/MINOR   default 1.0: the newest version the driver offers
+    //   GLWIN_OPENGL_PROFILE                GLWIN_OPENGL_CORE_PROFILE, GLWIN_OPENGL_COMPAT_PROFILE or
+    //                                       GLWIN_OPENGL_ANY_PROFILE (default); needs version 3.2+
+    //   GLWIN_OPENGL_FORWARD_COMPAT, GLWIN_OPENGL_DEBUG_CONTEXT
+    //   GLWIN_CONTEXT_NO_ERROR              errors become undefined behaviour, the driver skips validation;
+    //                                       ignored together with GLWIN_OPENGL_DEBUG_CONTEXT
+    //   GLWIN_DEPTH_BITS (24), GLWIN_STENCIL_BITS (8)
+    //   GLWIN_SAMPLES                       MSAA samples of the default framebuffer, 0 = off
+    //   GLWIN_SRGB_CAPABLE                  sRGB default framebuffer; still needs glEnable(GL_FRAMEBUFFER_SRGB)
+    // The context hints go through WGL_ARB_pixel_format/WGL_ARB_create_context. Without those
+    // extensions a legacy context is created and only the depth/stencil hints apply. A context
+    // version or profile the driver can't give makes GLwin_CreateWindow fail.
     void GLwinWindowHint(int hint, int value);
+    // Reset every hint to its default
+    void GLwinDefaultWindowHints(void);
     
     // set window opacity
     // set window focus
@@ -51,11 +77,36 @@ extern "C" {
     void GLwinSetWindowPos(GLWIN_window* window, int posX, int posY);
     int  GLwinGetWidth(GLWIN_window* window);
     int  GLwinGetHeight(GLWIN_window* window);
-    // Optional: callback for resize
+    // Window state callbacks. Sizes are client-area pixels; while the user drags the frame they
+    // arrive at most once per display refresh, and never for the 0x0 of a minimised window.
     typedef void(*GLwinResizeCallback)(int width, int height);
+    void GLwinSetResizeCallback(GLWIN_window* window, GLwinResizeCallback cb);
+    typedef void(*GLwinFramebufferSizeCallback)(int width, int height);
+    void GLwinSetFramebufferSizeCallback(GLWIN_window* window, GLwinFramebufferSizeCallback cb);
+    typedef void(*GLwinFocusCallback)(int focused);
+    void GLwinSetFocusCallback(GLWIN_window* window, GLwinFocusCallback cb);
+    typedef void(*GLwinIconifyCallback)(int iconified);
+    void GLwinSetIconifyCallback(GLWIN_window* window, GLwinIconifyCallback cb);
+    // The contents need redrawing (uncovered, restored); not called during live resize
+    typedef void(*GLwinRefreshCallback)(void);
+    void GLwinSetRefreshCallback(GLWIN_window* window, GLwinRefreshCallback cb);
+    // The app loop is stuck inside GLwinPollEvents while the frame is dragged. This is called from
+    // there, at most once per display refresh and only when the size changed, to draw and swap
+    // a frame at the new size.
+    typedef void(*GLwinLiveResizeCallback)(int width, int height);
+    void GLwinSetLiveResizeCallback(GLWIN_window* window, GLwinLiveResizeCallback cb);
+    // While minimised GLwinSwapBuffers/GLwinPresentBackbuffer present nothing; when all windows
+    // are minimised they wait (up to 100 ms) for a message instead, so the loop stops spinning.
+    int  GLwinWindowIsIconified(GLWIN_window* window);
+    int  GLwinWindowIsFocused(GLWIN_window* window);
 
     // Window icon and maximize
     void GLwinSetWindowIcon(GLWIN_window* window, const wchar_t* iconPath);
+    // Set the icon from the bytes of a .ico file (picks the best image for the big and small sizes).
+    // The data is not kept. Returns 1 on success.
+    int  GLwinSetWindowIconFromMemory(GLWIN_window* window, const void* data, size_t size);
+    // Same, loading the .ico through GLwinLoadResource (mounted pack first, then the disk)
+    int  GLwinSetWindowIconResource(GLWIN_window* window, const char* name);
 
     // Time API
 	void GLwinGetTimer(GLWIN_window* window, int tstart, int tmax);
@@ -110,13 +161,39 @@ extern "C" {
     const char* GLwinGetClipboardString(GLWIN_window* window); // returns internal pointer; copy if you need it
 
     // Swap interval / vsync control (for apps using GLwinSwapBuffers or software present)
-    // Returns previous interval (or 0/-1 on failure).
+    // Applies to the window whose context is current. Returns its previous interval, -1 if no
+    // window's context is current. With several windows, vsync only one of them: each vsynced
+    // swap waits for its own vblank, so N vsynced windows run at 1/N of the refresh rate.
     int GLwinSetSwapInterval(int interval);
 	void GLwinApplySwapIntervalSleep(GLWIN_window* window);
 
     // Get monitor refresh rate (Hz). Useful for timing/vsync decisions.
     int GLwinGetRefreshRate(GLWIN_window* window);
 
+    // DPI / monitors
+    // The process is per-monitor DPI aware (v2 where the OS has it), so window, framebuffer and
+    // cursor coordinates are all real pixels. Scale UI sizes by the content scale (DPI / 96).
+    typedef struct GLwinMonitor {
+        HMONITOR handle;
+        char name[32];                              // device name, UTF-8 ("\\.\DISPLAY1")
+        int x, y, width, height;                    // desktop rect in pixels
+        int workX, workY, workWidth, workHeight;    // same without the taskbar
+        int refreshRate;                            // Hz, 0 if unknown
+        int dpi;
+        float contentScale;                         // dpi / 96
+        int primary;
+    } GLwinMonitor;
+    // Cached; refreshed after display, DPI or work area changes. Valid until the next GLwin call
+    // that refreshes it (GLwinGetMonitors, GLwinGetWindowMonitor, GLwinGetRefreshRate).
+    const GLwinMonitor* GLwinGetMonitors(int* count);
+    // Monitor the window is (mostly) on
+    const GLwinMonitor* GLwinGetWindowMonitor(GLWIN_window* window);
+    void GLwinGetContentScale(GLWIN_window* window, float* xscale, float* yscale);
+    // Called when the window's DPI changes (moved to another monitor, or the scale setting
+    // changed), after the window was resized to keep its physical size.
+    typedef void(*GLwinContentScaleCallback)(float xscale, float yscale);
+    void GLwinSetContentScaleCallback(GLWIN_window* window, GLwinContentScaleCallback cb);
+
     // User pointer to attach app-specific data to a window (like GLFW)
     void GLwinSetUserPointer(GLWIN_window* window, void* ptr);
     void* GLwinGetUserPointer(GLWIN_window* window);
@@ -125,7 +202,7 @@ extern "C" {
     void GLwinSetWindowTitle(GLWIN_window* window, const wchar_t* title);
 
 
-    // Terminate and cleanup library (optional, for symmetry with GLFW)
+    // Terminate and cleanup library: destroys windows still open, unregisters the window classes
     void GLwinTerminate(void);
 
 
@@ -0,0 +1,54 @@
+#pragma once
+
+// Extra OpenGL contexts for worker threads
+// ----------------------------------------------------------------------------
+// A GLWIN_context has no window of its own (draw into FBOs). Contexts created sharing with
+// another one see its textures, buffers, programs, samplers and sync objects, so a worker can
+// upload or compile while the render thread draws. Containers (VAOs, FBOs) are never shared:
+// create those on the context that uses them.
+//
+// Create contexts on the thread that owns the window, then make each current on exactly one
+// worker. Work done on one context is only safe to use from another after a fence placed
+// behind it has signalled (glFenceSync + glFlush on the producer, glClientWaitSync or
+// glWaitSync on the consumer), and objects must be re-bound on the consumer afterwards.
+// GLwinUploadWorker (GLwinGUI) packages this up.
+//
+// Win32 uses WGL, with the pixel format and context hints of the window shared with. Elsewhere
+// contexts come from EGL (surfaceless on Mesa), which needs no display server at all; there the
+// version, profile, forward-compat, debug and no-error hints of GLwinWindowHint still apply.
+
+#include "GLwinDefs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef struct GLWIN_window GLWIN_window;
+    typedef struct GLWIN_context GLWIN_context;
+
+    // Context sharing objects with the window's context. Not current anywhere when returned.
+    GLWIN_context* GLwinCreateSharedContext(GLWIN_window* window);
+    // Context without a window; share (may be NULL) is another GLWIN_context to share objects
+    // with. Uses the hints share was created with, or else the current GLwinWindowHint ones.
+    GLWIN_context* GLwinCreateOffscreenContext(GLWIN_context* share);
+    // Must not be current on another thread
+    void GLwinDestroyContext(GLWIN_context* context);
+
+    // Make context current on the calling thread; NULL releases whatever is current there.
+    // Returns 1 on success.
+    int GLwinMakeOffscreenContextCurrent(GLWIN_context* context);
+
+    // Native handle (HGLRC, EGLContext) of the context current on the calling thread, NULL if none.
+    // Whichever call made it current; caches of GL state use it to notice a context switch.
+    void* GLwinGetCurrentNativeContext(void);
+
+    // GL entry point, for loaders such as gladLoadGLLoader (needs a current context)
+    void* GLwinGetProcAddress(const char* procname);
+
+    // Also declared in GLwin.h, which is Win32-only; see there for the hints
+    void GLwinWindowHint(int hint, int value);
+    void GLwinDefaultWindowHints(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,12 +8,24 @@
 // Window definitions and constants
 #define GLWIN_MAXIMIZED              0x00020008
 #define GLWIN_RESIZABLE              0x00020003
+#define GLWIN_SCALE_TO_MONITOR       0x0002200C
 
 // OpenGl definitions and constants
 #define GLWIN_CONTEXT_VERSION_MAJOR  0x00022002
 #define GLWIN_CONTEXT_VERSION_MINOR  0x00022003
 #define GLWIN_OPENGL_PROFILE         0x00022008
 #define GLWIN_OPENGL_CORE_PROFILE    0x00032001
+#define GLWIN_OPENGL_COMPAT_PROFILE  0x00032002
+#define GLWIN_OPENGL_ANY_PROFILE     0
+#define GLWIN_OPENGL_FORWARD_COMPAT  0x00022006
+#define GLWIN_OPENGL_DEBUG_CONTEXT   0x00022007
+#define GLWIN_CONTEXT_NO_ERROR       0x0002200A
+
+// Framebuffer definitions and constants
+#define GLWIN_DEPTH_BITS             0x00021005
+#define GLWIN_STENCIL_BITS           0x00021006
+#define GLWIN_SAMPLES                0x0002100D
+#define GLWIN_SRGB_CAPABLE           0x0002100E
 
 
 
@@ -55,7 +67,7 @@
 #define GLWIN_COMMA                   44 //0x2C ,
 #define GLWIN_SEMICOLON               59 //0x3B ;
 #define GLWIN_SLASH                   47 //0x2F /
-#define GLWIN_BACKSLASH               92 //0x5C \
+#define GLWIN_BACKSLASH               92 //0x5C '\'
 
 #define GLWIN_LEFT_BRACKET            91 //0x5B [
 #define GLWIN_RIGHT_BRACKET           93 //0x5D ]
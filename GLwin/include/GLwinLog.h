@@ -1,6 +1,13 @@
 #pragma once
-#include <iostream>
-#include <sstream>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 enum GLWIN_LOG_LEVEL {
     GLWIN_LOG_LEVEL_INIT = 0,
@@ -19,11 +26,6 @@ enum GLWIN_LOG_LEVEL {
 #define GLWIN_COLOR_CYAN    "\x1b[36m"
 #define GLWIN_COLOR_BLUE   "\x1b[34m"
 
-#ifdef _DEBUG
-#ifndef GLWIN_LOG_LEVEL_ACTIVE
-#define GLWIN_LOG_LEVEL_ACTIVE GLWIN_LOG_LEVEL_DEBUG
-#endif
-
 //Select color based on level
 #define GLWIN_LOG_COLOR(level) \
         ((level) == GLWIN_LOG_LEVEL_INIT ? GLWIN_COLOR_GREEN : \
@@ -33,34 +35,304 @@ enum GLWIN_LOG_LEVEL {
          (level) == GLWIN_LOG_LEVEL_TRACE ? GLWIN_COLOR_CYAN : \
          GLWIN_COLOR_BLUE)
 
-// Internal macro for logging with level and color
-#define GLWIN_LOG(level, level_name, ...) do { \
-        if ((level) <= GLWIN_LOG_LEVEL_ACTIVE) { \
-            std::ostringstream glwin_log_stream; \
+// Levels above this are compiled out. Debug keeps everything, release keeps errors and warnings.
+#ifndef GLWIN_LOG_LEVEL_ACTIVE
+#ifdef _DEBUG
+#define GLWIN_LOG_LEVEL_ACTIVE GLWIN_LOG_LEVEL_DEBUG
+#else
+#define GLWIN_LOG_LEVEL_ACTIVE GLWIN_LOG_LEVEL_WARNING
+#endif
+#endif
+
+// Longest text per record. Longer messages continue in further records (each starting with
+// "..."), up to GLWIN_LOG_MAX_PARTS of them; anything past that ends in "...[truncated]".
+#define GLWIN_LOG_MAX_MESSAGE 224
+#define GLWIN_LOG_MAX_PARTS 16
+// Records each thread can have in flight before new ones are dropped (power of two)
+#define GLWIN_LOG_RING_SIZE 256
+
+// Asynchronous logger.
+// Each thread writes into its own lock-free ring; a background sink thread drains all rings,
+// orders the records by time and writes them out. Logging never blocks or allocates: when a
+// ring is full the record is dropped and counted, and the sink reports how many were lost.
+extern std::atomic<int> g_GLwinLogLevel;
+
+// Runtime threshold, starts at GLWIN_LOG_LEVEL_ACTIVE. A call above it costs one relaxed load.
+void GLwinLogSetLevel(int level);
+inline int GLwinLogGetLevel() { return g_GLwinLogLevel.load(std::memory_order_relaxed); }
+
+// Queue a finished message on this thread's ring (what the macros call), split into
+// continuation records when it is longer than one
+void GLwinLogWrite(int level, const char* text, size_t length);
+// Reserve this thread's next record and return its payload (capacity bytes), or NULL if the ring
+// is full (the record is counted as dropped). Must be followed by GLwinLogCommit on the same thread.
+char* GLwinLogBegin(int level, uint32_t site, size_t* capacity);
+void GLwinLogCommit(size_t length);
+// Block until everything logged so far has been written
+void GLwinLogFlush();
+// Stop the sink thread after draining it; later records are written synchronously.
+// Registered with atexit when the sink starts.
+void GLwinLogShutdown();
+uint64_t GLwinLogGetDroppedCount();
+// "INIT", "ERROR", "WARN", "INFO", "TRACE" or "DEBUG"
+const char* GLwinLogLevelName(int level);
+
+// Binary log file (see GLwinLogFile.h), read back with the GLwinLogDecode tool.
+// Opening a file replaces any open one. In release builds it also turns the console output off,
+// since that is what production runs want; GLwinLogSetConsole overrides it either way.
+// Returns 1 on success.
+int GLwinLogOpenFile(const char* path);
+void GLwinLogCloseFile();
+void GLwinLogSetConsole(int enabled);
+
+// ostream over a fixed stack buffer, so the << syntax works without touching the heap.
+// A message that outgrows the buffer (shader info logs, say) moves to a string instead.
+class GLwinLogStream : private std::streambuf, public std::ostream {
+public:
+    GLwinLogStream() : std::ostream(static_cast<std::streambuf*>(this)) { setp(buffer, buffer + sizeof(buffer)); }
+    const char* data() const { return spilled ? spill.data() : pbase(); }
+    size_t size() const { return spilled ? spill.size() : (size_t)(pptr() - pbase()); }
+
+private:
+    // More than GLwinLogWrite will keep is not worth holding on to
+    static const size_t MaxSpill = GLWIN_LOG_MAX_MESSAGE * GLWIN_LOG_MAX_PARTS + 1;
+
+    void Spill(const char* s, size_t n) {
+        if (!spilled) {
+            spill.assign(pbase(), pptr());
+            setp(buffer, buffer); // every later write comes through overflow / xsputn
+            spilled = true;
+        }
+        if (spill.size() < MaxSpill) spill.append(s, n < MaxSpill - spill.size() ? n : MaxSpill - spill.size());
+    }
+    std::streambuf::int_type overflow(std::streambuf::int_type c) override {
+        if (!std::streambuf::traits_type::eq_int_type(c, std::streambuf::traits_type::eof())) {
+            char ch = std::streambuf::traits_type::to_char_type(c);
+            Spill(&ch, 1);
+        }
+        return std::streambuf::traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        if (!spilled && n <= epptr() - pptr()) return std::streambuf::xsputn(s, n);
+        Spill(s, (size_t)n);
+        return n;
+    }
+
+    char buffer[GLWIN_LOG_MAX_MESSAGE];
+    bool spilled = false;
+    std::string spill;
+};
+
+// Internal macro for logging with level
+#define GLWIN_LOG(level, ...) do { \
+        if ((level) <= GLwinLogGetLevel()) { \
+            GLwinLogStream glwin_log_stream; \
             glwin_log_stream << __VA_ARGS__; \
-            std::cout << GLWIN_LOG_COLOR(level) \
-                      << "[GLWIN][" << level_name << "] " << glwin_log_stream.str() \
-                      << GLWIN_COLOR_RESET << std::endl; \
+            GLwinLogWrite((level), glwin_log_stream.data(), glwin_log_stream.size()); \
         } \
     } while (0)
 
+#define GLWIN_LOG_INIT(...)    GLWIN_LOG(GLWIN_LOG_LEVEL_INIT, __VA_ARGS__)
 
-//#define GLWIN_LOG_INIT(x) std::cout << x << std::endl
-#define GLWIN_LOG_INIT(...)   GLWIN_LOG(GLWIN_LOG_LEVEL_INIT, "INIT", __VA_ARGS__)
-#define GLWIN_LOG_ERROR(...)   GLWIN_LOG(GLWIN_LOG_LEVEL_ERROR, "ERROR", __VA_ARGS__)
-#define GLWIN_LOG_WARNING(...) GLWIN_LOG(GLWIN_LOG_LEVEL_WARNING, "WARN", __VA_ARGS__)
-#define GLWIN_LOG_INFO(...)    GLWIN_LOG(GLWIN_LOG_LEVEL_INFO, "INFO", __VA_ARGS__)
-#define GLWIN_LOG_TRACE(...)   GLWIN_LOG(GLWIN_LOG_LEVEL_TRACE, "TRACE", __VA_ARGS__)
-#define GLWIN_LOG_DEBUG(...)   GLWIN_LOG(GLWIN_LOG_LEVEL_DEBUG, "DEBUG", __VA_ARGS__)
-
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_ERROR
+#define GLWIN_LOG_ERROR(...)   GLWIN_LOG(GLWIN_LOG_LEVEL_ERROR, __VA_ARGS__)
 #else
-// In release: macros do nothing
-#define GLWIN_LOG_INIT(x)
 #define GLWIN_LOG_ERROR(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_WARNING
+#define GLWIN_LOG_WARNING(...) GLWIN_LOG(GLWIN_LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
 #define GLWIN_LOG_WARNING(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_INFO
+#define GLWIN_LOG_INFO(...)    GLWIN_LOG(GLWIN_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
 #define GLWIN_LOG_INFO(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_TRACE
+#define GLWIN_LOG_TRACE(...)   GLWIN_LOG(GLWIN_LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
 #define GLWIN_LOG_TRACE(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_DEBUG
+#define GLWIN_LOG_DEBUG(...)   GLWIN_LOG(GLWIN_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
 #define GLWIN_LOG_DEBUG(...)
 #endif
 
+// ----------------------------------------------------------------------------
+// Structured logging: GLWIN_LOGF_*("x={} y={}", x, y)
+// ----------------------------------------------------------------------------
+// Each call site is described at compile time (format string, level, argument types) and
+// registered once, the first time it runs. After that a call only copies the site id and the raw
+// argument bytes into the ring; the text is put together on the sink thread, or offline from a
+// binary log. "{}" takes the next argument, "{{" and "}}" are literal braces.
+
+#define GLWIN_LOG_MAX_ARGS 16
+
+enum GLwinLogArgType : uint8_t {
+    GLWIN_LOG_ARG_I32 = 1,
+    GLWIN_LOG_ARG_U32 = 2,
+    GLWIN_LOG_ARG_I64 = 3,
+    GLWIN_LOG_ARG_U64 = 4,
+    GLWIN_LOG_ARG_F64 = 5,
+    GLWIN_LOG_ARG_BOOL = 6,
+    GLWIN_LOG_ARG_CHAR = 7,
+    GLWIN_LOG_ARG_STRING = 8,   // uint16 length + bytes, cut to fit the record
+    GLWIN_LOG_ARG_POINTER = 9
+};
+
+struct GLwinLogSite {
+    const char* format;
+    const char* file;
+    int line;
+    int level;
+    int argCount;
+    uint8_t argTypes[GLWIN_LOG_MAX_ARGS];
+};
+
+// Returns the site id (ids start at 1; 0 marks a plain text record)
+uint32_t GLwinLogRegisterSite(const GLwinLogSite* site);
+const GLwinLogSite* GLwinLogGetSite(uint32_t id);
+uint32_t GLwinLogGetSiteCount();
+// Turn a format string and encoded arguments back into text (sink thread and offline decoder)
+void GLwinLogFormatArgs(const char* format, const uint8_t* argTypes, int argCount,
+    const void* payload, size_t length, std::string& out);
+
+template<typename T>
+constexpr GLwinLogArgType GLwinLogArgTypeOf()
+{
+    using U = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_same_v<U, bool>) return GLWIN_LOG_ARG_BOOL;
+    else if constexpr (std::is_same_v<U, char>) return GLWIN_LOG_ARG_CHAR;
+    else if constexpr (std::is_enum_v<U>) return GLWIN_LOG_ARG_I64;
+    else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) return sizeof(U) <= 4 ? GLWIN_LOG_ARG_I32 : GLWIN_LOG_ARG_I64;
+    else if constexpr (std::is_integral_v<U>) return sizeof(U) <= 4 ? GLWIN_LOG_ARG_U32 : GLWIN_LOG_ARG_U64;
+    else if constexpr (std::is_floating_point_v<U>) return GLWIN_LOG_ARG_F64;
+    else if constexpr (std::is_convertible_v<const U&, std::string_view>) return GLWIN_LOG_ARG_STRING;
+    else if constexpr (std::is_pointer_v<U> || std::is_array_v<U>) return GLWIN_LOG_ARG_POINTER;
+    else static_assert(sizeof(U) == 0, "GLWIN_LOGF: unsupported argument type");
+}
+
+template<typename... Args> struct GLwinLogTypes {};
+// Only used in decltype: drops the format string and keeps the argument types
+template<typename F, typename... Args>
+GLwinLogTypes<Args...> GLwinLogTypeList(const F&, const Args&...);
 
+template<typename... Args>
+constexpr GLwinLogSite GLwinMakeLogSite(GLwinLogTypes<Args...>, const char* format, const char* file, int line, int level)
+{
+    static_assert(sizeof...(Args) <= GLWIN_LOG_MAX_ARGS, "GLWIN_LOGF: too many arguments");
+    return { format, file, line, level, (int)sizeof...(Args), { (uint8_t)GLwinLogArgTypeOf<Args>()... } };
+}
+
+constexpr int GLwinLogCountPlaceholders(const char* format)
+{
+    int n = 0;
+    for (const char* p = format; *p; ++p) {
+        if ((p[0] == '{' && p[1] == '{') || (p[0] == '}' && p[1] == '}')) ++p;
+        else if (p[0] == '{' && p[1] == '}') { ++n; ++p; }
+    }
+    return n;
+}
+
+template<typename T, typename U>
+inline bool GLwinLogPutRaw(char*& p, char* end, U value)
+{
+    T v = (T)value;
+    if ((size_t)(end - p) < sizeof(T)) return false;
+    memcpy(p, &v, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+template<typename T>
+inline bool GLwinLogPut(char*& p, char* end, const T& value)
+{
+    constexpr GLwinLogArgType type = GLwinLogArgTypeOf<T>();
+    if constexpr (type == GLWIN_LOG_ARG_I32) return GLwinLogPutRaw<int32_t>(p, end, value);
+    else if constexpr (type == GLWIN_LOG_ARG_U32) return GLwinLogPutRaw<uint32_t>(p, end, value);
+    else if constexpr (type == GLWIN_LOG_ARG_I64) return GLwinLogPutRaw<int64_t>(p, end, value);
+    else if constexpr (type == GLWIN_LOG_ARG_U64) return GLwinLogPutRaw<uint64_t>(p, end, value);
+    else if constexpr (type == GLWIN_LOG_ARG_F64) return GLwinLogPutRaw<double>(p, end, value);
+    else if constexpr (type == GLWIN_LOG_ARG_BOOL || type == GLWIN_LOG_ARG_CHAR) return GLwinLogPutRaw<char>(p, end, value);
+    else if constexpr (type == GLWIN_LOG_ARG_POINTER) return GLwinLogPutRaw<uint64_t>(p, end, (uint64_t)(uintptr_t)(const void*)value);
+    else {
+        std::string_view s(value);
+        if ((size_t)(end - p) < sizeof(uint16_t)) return false;
+        size_t n = s.size();
+        if (n > (size_t)(end - p) - sizeof(uint16_t)) n = (size_t)(end - p) - sizeof(uint16_t);
+        uint16_t len = (uint16_t)n;
+        memcpy(p, &len, sizeof(len));
+        memcpy(p + sizeof(len), s.data(), n);
+        p += sizeof(len) + n;
+        return n == s.size();
+    }
+}
+
+template<typename F, typename... Args>
+inline void GLwinLogStructured(uint32_t site, int level, const F&, const Args&... args)
+{
+    size_t capacity;
+    char* begin = GLwinLogBegin(level, site, &capacity);
+    if (!begin) return;
+    char* p = begin;
+    char* end = begin + capacity;
+    (void)end; // unused when there are no arguments
+    // stops at the first argument that doesn't fit; the formatter shows the rest as missing
+    bool ok = true;
+    ((ok = ok && GLwinLogPut(p, end, args)), ...);
+    (void)ok;
+    GLwinLogCommit((size_t)(p - begin));
+}
+
+// MSVC's traditional preprocessor passes __VA_ARGS__ on as one argument without the extra expansion
+#define GLWIN_LOG_EXPAND(x) x
+#define GLWIN_LOG_FIRST_ARG(first, ...) first
+
+#define GLWIN_LOGF(level, ...) do { \
+        if ((level) <= GLwinLogGetLevel()) { \
+            static constexpr GLwinLogSite glwin_log_site = GLwinMakeLogSite(decltype(GLwinLogTypeList(__VA_ARGS__))(), \
+                GLWIN_LOG_EXPAND(GLWIN_LOG_FIRST_ARG(__VA_ARGS__, 0)), __FILE__, __LINE__, (level)); \
+            static_assert(GLwinLogCountPlaceholders(glwin_log_site.format) == glwin_log_site.argCount, \
+                "GLWIN_LOGF: the number of {} doesn't match the arguments"); \
+            static const uint32_t glwin_log_site_id = GLwinLogRegisterSite(&glwin_log_site); \
+            GLwinLogStructured(glwin_log_site_id, (level), __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define GLWIN_LOGF_INIT(...)    GLWIN_LOGF(GLWIN_LOG_LEVEL_INIT, __VA_ARGS__)
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_ERROR
+#define GLWIN_LOGF_ERROR(...)   GLWIN_LOGF(GLWIN_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define GLWIN_LOGF_ERROR(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_WARNING
+#define GLWIN_LOGF_WARNING(...) GLWIN_LOGF(GLWIN_LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define GLWIN_LOGF_WARNING(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_INFO
+#define GLWIN_LOGF_INFO(...)    GLWIN_LOGF(GLWIN_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define GLWIN_LOGF_INFO(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_TRACE
+#define GLWIN_LOGF_TRACE(...)   GLWIN_LOGF(GLWIN_LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define GLWIN_LOGF_TRACE(...)
+#endif
+
+#if GLWIN_LOG_LEVEL_ACTIVE >= GLWIN_LOG_LEVEL_DEBUG
+#define GLWIN_LOGF_DEBUG(...)   GLWIN_LOGF(GLWIN_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define GLWIN_LOGF_DEBUG(...)
+#endif
@@ -0,0 +1,166 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Binary log file
+// ----------------------------------------------------------------------------
+// What the sink writes instead of (or next to) the coloured console output when a log file is
+// open (GLwinLogOpenFile). Records are stored as the ring holds them: raw ticks, thread, site id
+// and the encoded arguments, so writing costs a memcpy and the text is only put together by the
+// decoder (GLwinLogDecode).
+//
+// Layout: a header, then a stream of chunks, each starting with its kind byte:
+//   SITE    a call site (format string, file, line, argument types), written the first time one
+//           of its records goes into the file, so together the site chunks form the string table
+//   RECORD  one log record; site 0 means the payload is plain text
+//   DROPPED records lost because a ring was full
+// The file is grown ahead of the data and the unused tail is zero, which reads as END. After a
+// crash everything up to the last complete chunk is still readable.
+
+#define GLWIN_LOGFILE_VERSION 1
+// Header and every chunk are padded to this
+#define GLWIN_LOGFILE_ALIGN 8
+
+enum GLwinLogFileChunk : uint8_t {
+    GLWIN_LOGFILE_END = 0,
+    GLWIN_LOGFILE_SITE = 1,
+    GLWIN_LOGFILE_RECORD = 2,
+    GLWIN_LOGFILE_DROPPED = 3
+};
+
+#pragma pack(push, 1)
+struct GLwinLogFileHeader {
+    char magic[4];              // "GLWL"
+    uint32_t version;
+    uint32_t headerSize;        // first chunk starts here
+    uint32_t reserved;
+    uint64_t tickFrequency;     // GLwinGetTickFrequency of the writer
+    uint64_t startTicks;        // GLwinGetTicks when the file was opened
+    int64_t startTime;          // same moment, seconds since 1970 (UTC)
+};
+// followed by argTypes[argCount], format[formatLength], file[fileLength]
+struct GLwinLogFileSite {
+    uint8_t kind;
+    uint8_t level;
+    uint8_t argCount;
+    uint8_t reserved;
+    uint32_t id;
+    uint32_t line;
+    uint16_t formatLength;
+    uint16_t fileLength;
+};
+// followed by payload[length]
+struct GLwinLogFileRecord {
+    uint8_t kind;
+    uint8_t level;
+    uint16_t length;
+    uint32_t thread;
+    uint32_t site;
+    uint32_t reserved;
+    uint64_t ticks;
+};
+struct GLwinLogFileDropped {
+    uint8_t kind;
+    uint8_t reserved[7];
+    uint64_t ticks;
+    uint64_t count;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(GLwinLogFileHeader) == 40, "GLwinLogFileHeader is written as is");
+static_assert(sizeof(GLwinLogFileRecord) == 24, "GLwinLogFileRecord is written as is");
+
+// Bytes a chunk takes in the file, padding included
+inline size_t GLwinLogFileChunkSize(size_t bytes)
+{
+    return (bytes + GLWIN_LOGFILE_ALIGN - 1) & ~(size_t)(GLWIN_LOGFILE_ALIGN - 1);
+}
+
+// Append-only file written through a memory mapping. The mapping is grown (doubled) ahead of
+// the data, so an append is a memcpy; Sync hands the dirty pages to the OS (FlushViewOfFile /
+// msync) and Close cuts the file back to what was written.
+class GLwinLogFileWriter {
+public:
+    GLwinLogFileWriter() = default;
+    ~GLwinLogFileWriter() { Close(); }
+
+    GLwinLogFileWriter(const GLwinLogFileWriter&) = delete;
+    GLwinLogFileWriter& operator=(const GLwinLogFileWriter&) = delete;
+
+    // Create (or truncate) path, UTF-8
+    bool Open(const char* path, size_t initialSize = 1 << 20);
+    // Copy size bytes to the end of the file; false if the mapping couldn't be grown
+    bool Append(const void* data, size_t size);
+    // Reserve size bytes at the end and return them for writing (zeroed), or NULL
+    unsigned char* Reserve(size_t size);
+    // Start writing the dirty pages back; wait also waits for the disk (FlushFileBuffers / MS_SYNC)
+    void Sync(bool wait = false);
+    void Close();
+
+    bool IsOpen() const { return view != nullptr; }
+    size_t GetSize() const { return size; }
+
+private:
+    bool Map(size_t newCapacity);
+    void Unmap();
+
+    unsigned char* view = nullptr;
+    size_t size = 0;        // bytes written
+    size_t capacity = 0;    // bytes mapped (file size until Close)
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// Call site as read back from a file
+struct GLwinLogFileSiteInfo {
+    uint32_t id = 0;
+    int line = 0;
+    int level = 0;
+    std::string format;
+    std::string file;
+    std::vector<uint8_t> argTypes;
+};
+
+struct GLwinLogFileEntry {
+    GLwinLogFileChunk kind;           // GLWIN_LOGFILE_RECORD or GLWIN_LOGFILE_DROPPED
+    uint64_t ticks;
+    uint32_t thread;
+    int level;
+    const GLwinLogFileSiteInfo* site; // NULL for plain text records (or an unknown site id)
+    uint32_t siteId;
+    const char* payload;
+    size_t length;
+    uint64_t dropped;                 // GLWIN_LOGFILE_DROPPED only
+};
+
+// Walks a log file held in memory (e.g. a GLwinMapFile view, which must outlive the reader)
+class GLwinLogFileReader {
+public:
+    bool Open(const void* data, size_t size);
+    const GLwinLogFileHeader& GetHeader() const { return header; }
+
+    // Next record or drop note in file order, taking in site chunks on the way.
+    // False at the end of the data; IsDamaged tells a clean end from a cut or corrupt chunk.
+    bool Next(GLwinLogFileEntry* out);
+    bool IsDamaged() const { return damaged; }
+
+    const GLwinLogFileSiteInfo* GetSite(uint32_t id) const;
+    // Seconds since the file was opened
+    double GetSeconds(uint64_t ticks) const;
+    // The record's text: plain records as stored, structured ones formatted from their site
+    void FormatText(const GLwinLogFileEntry& entry, std::string& out) const;
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    bool damaged = false;
+    GLwinLogFileHeader header = {};
+    std::vector<GLwinLogFileSiteInfo> sites;    // id - 1, gaps have id 0
+};
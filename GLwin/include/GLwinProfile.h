@@ -0,0 +1,90 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "GLwinTime.h"
+
+// Scoped profiling zones
+// ----------------------------------------------------------------------------
+//   void Update() { GLWIN_PROFILE_SCOPE("Update"); ... }
+//
+// While profiling is enabled each zone stores its name and begin/end ticks in a ring owned by the
+// calling thread (no locks, no allocation). The rings keep the most recent GLWIN_PROFILE_RING_SIZE
+// zones per thread and can be written out as Chrome trace JSON, which chrome://tracing, Perfetto
+// and Speedscope open directly. When profiling is disabled a zone costs one relaxed load; define
+// GLWIN_PROFILE to 0 to compile the zones out completely.
+//
+// Zone names must outlive the capture: string literals, in practice.
+
+#ifndef GLWIN_PROFILE
+#define GLWIN_PROFILE 1
+#endif
+
+// Zones kept per thread (power of two); older ones are overwritten
+#define GLWIN_PROFILE_RING_SIZE 65536
+// Distinct zone names summed per frame by GLwinProfileFrameMark
+#define GLWIN_PROFILE_MAX_FRAME_ZONES 64
+
+struct GLwinProfileZone {
+    const char* name;
+    uint64_t begin;     // GLwinGetTicks
+    uint64_t end;
+};
+
+// Time spent in one zone name over the last completed frame, summed across threads
+struct GLwinProfileZoneStats {
+    const char* name;
+    int calls;
+    double milliseconds;
+    int gpu;            // 1: GPU zone, which reaches the stats a few frames after it was drawn
+};
+
+extern std::atomic<bool> g_GLwinProfileEnabled;
+
+inline bool GLwinProfileIsEnabled() { return g_GLwinProfileEnabled.load(std::memory_order_relaxed); }
+// Enabling starts a new capture: zones recorded before it are left out of the trace
+void GLwinProfileEnable(bool enabled);
+
+// Store a finished zone on the calling thread's ring (what GLWIN_PROFILE_SCOPE calls)
+void GLwinProfileRecord(const char* name, uint64_t begin, uint64_t end);
+// Store a zone measured on the GPU, already converted to GLwinGetTicks time. GPU zones get a
+// track of their own in the trace. Call from one thread (the one owning the GL context).
+void GLwinProfileRecordGpu(const char* name, uint64_t begin, uint64_t end);
+// Label the calling thread in the trace, e.g. "Main" or "Loader". Cheap: the thread's ring is
+// only allocated by its first zone recorded while profiling is enabled.
+void GLwinProfileSetThreadName(const char* name);
+
+// End of a frame: sums the zones finished since the previous mark. GLwinSwapBuffers and
+// GLwinPresentBackbuffer call it, so it only needs calling by hand for other present paths.
+void GLwinProfileFrameMark();
+// Per-zone totals of the last frame, valid until the next GLwinProfileFrameMark
+int GLwinProfileGetFrameStats(const GLwinProfileZoneStats** stats);
+
+// Write the zones recorded since GLwinProfileEnable(true) as Chrome trace JSON. Best called after
+// disabling: zones still being recorded may or may not make it in. Returns 1 on success.
+int GLwinProfileWriteTrace(const char* path);
+
+class GLwinProfileScope {
+public:
+    explicit GLwinProfileScope(const char* name)
+        : name(name), begin(GLwinProfileIsEnabled() ? GLwinGetTicks() : 0) {}
+    ~GLwinProfileScope() {
+        if (begin) GLwinProfileRecord(name, begin, GLwinGetTicks());
+    }
+
+    GLwinProfileScope(const GLwinProfileScope&) = delete;
+    GLwinProfileScope& operator=(const GLwinProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;     // 0 when profiling was off as the zone opened
+};
+
+#define GLWIN_PROFILE_CONCAT_INNER(a, b) a##b
+#define GLWIN_PROFILE_CONCAT(a, b) GLWIN_PROFILE_CONCAT_INNER(a, b)
+
+#if GLWIN_PROFILE
+#define GLWIN_PROFILE_SCOPE(name) GLwinProfileScope GLWIN_PROFILE_CONCAT(glwin_profile_scope_, __LINE__)(name)
+#else
+#define GLWIN_PROFILE_SCOPE(name) do {} while (0)
+#endif
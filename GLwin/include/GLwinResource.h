@@ -0,0 +1,59 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __cplusplus
+#include <string_view>
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	// Read-only view of a file's bytes. Comes either from a memory mapping of its own
+	// (handle != NULL, release with GLwinUnmapFile) or from inside a mounted pack (handle == NULL,
+	// valid until the pack is closed). Empty files map to data == NULL, size == 0.
+	typedef struct GLwinFileView {
+		const unsigned char* data;
+		size_t size;
+		void* handle;
+	} GLwinFileView;
+
+	// Map a whole file read-only (MapViewOfFile / mmap). Path is UTF-8. Returns 1 on success.
+	int GLwinMapFile(const char* path, GLwinFileView* out);
+	void GLwinUnmapFile(GLwinFileView* view);
+
+	// --- Pack archive: many assets in one mapped file ---
+	// Layout: header ("GLPK", version, count, index offset), then the file contents (16 byte
+	// aligned), then an index sorted by name hash with offset, size and a 64-bit content hash.
+	typedef struct GLWIN_pack GLWIN_pack;
+
+	GLWIN_pack* GLwinOpenPack(const char* path);
+	void GLwinClosePack(GLWIN_pack* pack);
+	// Look up an entry by its stored name (forward slashes). Returns 1 and a view into the pack.
+	int GLwinPackFind(GLWIN_pack* pack, const char* name, GLwinFileView* out);
+	// Recompute an entry's content hash; returns 1 if it matches the index
+	int GLwinPackVerify(GLWIN_pack* pack, const char* name);
+	int GLwinPackGetCount(GLWIN_pack* pack);
+	const char* GLwinPackGetName(GLWIN_pack* pack, int index);
+	// Build a pack from files on disk; names[i] is what GLwinPackFind will look for. Returns 1 on success.
+	int GLwinWritePack(const char* packPath, const char* const* names, const char* const* files, int count);
+
+	// 64-bit FNV-1a, the hash used for pack names and contents
+	uint64_t GLwinHash64(const void* data, size_t size);
+
+	// --- Resource lookup: mounted pack first, then the file system ---
+	// Mounting replaces (and closes) any previously mounted pack; NULL unmounts.
+	int GLwinMountPack(const char* path);
+	int GLwinLoadResource(const char* name, GLwinFileView* out);
+	// Safe for both kinds of view
+	void GLwinReleaseResource(GLwinFileView* view);
+
+#ifdef __cplusplus
+}
+
+inline std::string_view GLwinViewAsString(const GLwinFileView& view)
+{
+	return std::string_view(reinterpret_cast<const char*>(view.data), view.size);
+}
+#endif
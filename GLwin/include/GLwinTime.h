@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 
 
 #ifdef __cplusplus
@@ -8,6 +9,11 @@ extern "C" {
 	// Returns time in seconds since program start (high resolution)
 	double GLwinGetTime(void);
 
+	// Raw high resolution counter (QueryPerformanceCounter) and its ticks per second.
+	// Cheaper than GLwinGetTime when only differences are needed, e.g. log timestamps.
+	uint64_t GLwinGetTicks(void);
+	uint64_t GLwinGetTickFrequency(void);
+
 	// Optional: add more time/fps utilities here
 
 #ifdef __cplusplus
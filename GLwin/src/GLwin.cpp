@@ -2,9 +2,13 @@
 #include <iostream>
 
 #include "../GLwinLog.h"
+#include "../GLwinResource.h"
+#include "../GLwinProfile.h"
+#include "GLwinContextHints.h"
 
 #include <windows.h>
 
+#include <string.h>
 #include <vector>
 #include <unordered_map>
 
@@ -19,6 +23,10 @@ void GLwinHelloFromGLwin()
 // windows hints
 static int g_GLwinMaximizedHint = 0;
 static int g_GLwinResizableHint = 1; // Default to resizable
+static int g_GLwinScaleToMonitorHint = 1; // size given to GLwin_CreateWindow is at 96 DPI
+
+// context and framebuffer hints (defaults documented at GLwinWindowHint)
+static glwin_internal_ContextHints g_GLwinContextHints;
 
 // Internal struct definition
 struct GLWIN_window {
@@ -57,9 +65,39 @@ struct GLWIN_window {
 
 	void* userPointer = nullptr; // for user data
 
+    // Icons created by GLwinSetWindowIconFromMemory (owned, destroyed with the window)
+    HICON iconBig = NULL;
+    HICON iconSmall = NULL;
+
     // Cursor visible state cache (keeps track of desired visibility)
     bool cursorVisible = true;
 
+    // Hints the window was created with (context ones reused by GLwinCreateSharedContext)
+    glwin_internal_ContextHints contextHints;
+    bool resizable = true;
+
+    // Frame pacing (GLwinSetSwapInterval / GLwinApplySwapIntervalSleep)
+    int swapInterval = 0;
+    LARGE_INTEGER lastPresentTime = {};
+
+    // DPI of the monitor the window is on, kept current by WM_DPICHANGED
+    UINT dpi = USER_DEFAULT_SCREEN_DPI;
+    GLwinContentScaleCallback contentScaleCallback = nullptr;
+
+    // Window state callbacks
+    GLwinFramebufferSizeCallback framebufferSizeCallback = nullptr;
+    GLwinFocusCallback focusCallback = nullptr;
+    GLwinIconifyCallback iconifyCallback = nullptr;
+    GLwinRefreshCallback refreshCallback = nullptr;
+    GLwinLiveResizeCallback liveResizeCallback = nullptr;
+    bool iconified = false;
+    bool focused = false;
+
+    // Inside the modal sizing loop WM_SIZE only sets sizePending; the live resize timer applies it
+    bool inSizeMove = false;
+    bool sizePending = false;
+    int reportedWidth = 0, reportedHeight = 0;  // last size the callbacks were given
+
 	
 };
 
@@ -67,15 +105,224 @@ struct GLWIN_window {
 static const wchar_t* GLWIN_WINDOW_CLASS = L"GLWIN_WindowClass";
 static bool classRegistered = false;
 
-// Helper: Set pixel format for OpenGL
-static bool SetPixelFormatForGL(HDC hdc) {
+// Every open window in creation order. Windows belong to the thread that created them, so the
+// registry is only touched from there.
+static std::vector<GLWIN_window*> g_GLwinWindows;
+
+// -----------------------------------------------------------------------------
+// DPI awareness and monitors
+// -----------------------------------------------------------------------------
+
+#ifndef WM_DPICHANGED
+#define WM_DPICHANGED 0x02E0
+#endif
+// DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2 (Windows 10 1703), PROCESS_PER_MONITOR_DPI_AWARE, MDT_EFFECTIVE_DPI
+#define GLWIN_DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2 ((HANDLE)(LONG_PTR)-4)
+#define GLWIN_PROCESS_PER_MONITOR_DPI_AWARE 2
+#define GLWIN_MDT_EFFECTIVE_DPI 0
+
+// Looked up at run time so GLwin still starts on Windows versions without them
+typedef BOOL(WINAPI* PFNSETPROCESSDPIAWARENESSCONTEXT)(HANDLE value);
+typedef UINT(WINAPI* PFNGETDPIFORWINDOW)(HWND hwnd);
+typedef HRESULT(WINAPI* PFNSETPROCESSDPIAWARENESS)(int value);
+typedef HRESULT(WINAPI* PFNGETDPIFORMONITOR)(HMONITOR monitor, int type, UINT* dpiX, UINT* dpiY);
+
+static PFNGETDPIFORWINDOW g_GetDpiForWindow = nullptr;
+static PFNGETDPIFORMONITOR g_GetDpiForMonitor = nullptr;
+
+// Per-monitor v2 where available (Windows 10 1703+), else per-monitor v1 (8.1), else system aware.
+// Once per process, before the first window; fails harmlessly when a manifest already set it.
+static void glwin_internal_InitDpiAwareness()
+{
+    static bool done = false;
+    if (done) return;
+    done = true;
+
+    HMODULE user32 = GetModuleHandleW(L"user32.dll");
+    HMODULE shcore = LoadLibraryW(L"shcore.dll");
+    PFNSETPROCESSDPIAWARENESSCONTEXT setContext = user32 ?
+        (PFNSETPROCESSDPIAWARENESSCONTEXT)GetProcAddress(user32, "SetProcessDpiAwarenessContext") : nullptr;
+    PFNSETPROCESSDPIAWARENESS setAwareness = shcore ?
+        (PFNSETPROCESSDPIAWARENESS)GetProcAddress(shcore, "SetProcessDpiAwareness") : nullptr;
+    if (user32) g_GetDpiForWindow = (PFNGETDPIFORWINDOW)GetProcAddress(user32, "GetDpiForWindow");
+    if (shcore) g_GetDpiForMonitor = (PFNGETDPIFORMONITOR)GetProcAddress(shcore, "GetDpiForMonitor");
+
+    if (setContext && setContext(GLWIN_DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2)) return;
+    if (setAwareness && SUCCEEDED(setAwareness(GLWIN_PROCESS_PER_MONITOR_DPI_AWARE))) return;
+    if (!setContext && !setAwareness) SetProcessDPIAware();
+}
+
+static UINT glwin_internal_GetMonitorDpi(HMONITOR monitor)
+{
+    UINT dpiX = 0, dpiY = 0;
+    if (monitor && g_GetDpiForMonitor && SUCCEEDED(g_GetDpiForMonitor(monitor, GLWIN_MDT_EFFECTIVE_DPI, &dpiX, &dpiY)) && dpiX)
+        return dpiX;
+    // system DPI: the same for every monitor
+    HDC screen = GetDC(NULL);
+    int dpi = screen ? GetDeviceCaps(screen, LOGPIXELSX) : 0;
+    if (screen) ReleaseDC(NULL, screen);
+    return dpi > 0 ? (UINT)dpi : USER_DEFAULT_SCREEN_DPI;
+}
+
+static UINT glwin_internal_GetWindowDpi(HWND hwnd)
+{
+    if (g_GetDpiForWindow) {
+        UINT dpi = g_GetDpiForWindow(hwnd);
+        if (dpi) return dpi;
+    }
+    return glwin_internal_GetMonitorDpi(MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST));
+}
+
+// Monitor topology, rebuilt on first use after WM_DISPLAYCHANGE/WM_DPICHANGED/work area changes.
+// Those only reach open windows, so without any the list is rebuilt on every call.
+static std::vector<GLwinMonitor> g_GLwinMonitors;
+static bool g_GLwinMonitorsValid = false;
+
+static BOOL CALLBACK glwin_internal_AddMonitor(HMONITOR handle, HDC, LPRECT, LPARAM)
+{
+    MONITORINFOEXW mi = {};
+    mi.cbSize = sizeof(mi);
+    if (!GetMonitorInfoW(handle, &mi)) return TRUE;
+
+    GLwinMonitor m = {};
+    m.handle = handle;
+    WideCharToMultiByte(CP_UTF8, 0, mi.szDevice, -1, m.name, (int)sizeof(m.name) - 1, NULL, NULL);
+    m.x = mi.rcMonitor.left;
+    m.y = mi.rcMonitor.top;
+    m.width = mi.rcMonitor.right - mi.rcMonitor.left;
+    m.height = mi.rcMonitor.bottom - mi.rcMonitor.top;
+    m.workX = mi.rcWork.left;
+    m.workY = mi.rcWork.top;
+    m.workWidth = mi.rcWork.right - mi.rcWork.left;
+    m.workHeight = mi.rcWork.bottom - mi.rcWork.top;
+    m.primary = (mi.dwFlags & MONITORINFOF_PRIMARY) ? 1 : 0;
+    m.dpi = (int)glwin_internal_GetMonitorDpi(handle);
+    m.contentScale = (float)m.dpi / (float)USER_DEFAULT_SCREEN_DPI;
+
+    DEVMODEW dm = {};
+    dm.dmSize = sizeof(dm);
+    if (EnumDisplaySettingsW(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm) && dm.dmDisplayFrequency > 1) {
+        m.refreshRate = (int)dm.dmDisplayFrequency;
+    }
+    else {
+        HDC dc = CreateDCW(mi.szDevice, mi.szDevice, NULL, NULL);
+        if (dc) {
+            int vrefresh = GetDeviceCaps(dc, VREFRESH);
+            if (vrefresh > 1) m.refreshRate = vrefresh;   // 0 and 1 mean "hardware default"
+            DeleteDC(dc);
+        }
+    }
+    g_GLwinMonitors.push_back(m);
+    return TRUE;
+}
+
+static void glwin_internal_RefreshMonitors()
+{
+    if (g_GLwinMonitorsValid && !g_GLwinWindows.empty()) return;
+    g_GLwinMonitors.clear();
+    EnumDisplayMonitors(NULL, NULL, glwin_internal_AddMonitor, 0);
+    g_GLwinMonitorsValid = true;
+}
+
+const GLwinMonitor* GLwinGetMonitors(int* count)
+{
+    glwin_internal_InitDpiAwareness();
+    glwin_internal_RefreshMonitors();
+    if (count) *count = (int)g_GLwinMonitors.size();
+    return g_GLwinMonitors.empty() ? nullptr : g_GLwinMonitors.data();
+}
+
+const GLwinMonitor* GLwinGetWindowMonitor(GLWIN_window* window)
+{
+    if (!window || !window->hwnd) return nullptr;
+    HMONITOR handle = MonitorFromWindow(window->hwnd, MONITOR_DEFAULTTONEAREST);
+    for (int pass = 0; pass < 2; ++pass) {
+        glwin_internal_RefreshMonitors();
+        for (const GLwinMonitor& m : g_GLwinMonitors) {
+            if (m.handle == handle) return &m;
+        }
+        // a monitor we haven't heard about: the change message hasn't arrived yet
+        g_GLwinMonitorsValid = false;
+    }
+    return nullptr;
+}
+
+void GLwinGetContentScale(GLWIN_window* window, float* xscale, float* yscale)
+{
+    float scale = window ? (float)window->dpi / (float)USER_DEFAULT_SCREEN_DPI : 1.0f;
+    if (xscale) *xscale = scale;
+    if (yscale) *yscale = scale;
+}
+
+void GLwinSetContentScaleCallback(GLWIN_window* window, GLwinContentScaleCallback cb)
+{
+    if (window) window->contentScaleCallback = cb;
+}
+
+// WGL_ARB_pixel_format, WGL_ARB_multisample, WGL_ARB_framebuffer_sRGB
+#define WGL_DRAW_TO_WINDOW_ARB                    0x2001
+#define WGL_ACCELERATION_ARB                      0x2003
+#define WGL_SUPPORT_OPENGL_ARB                    0x2010
+#define WGL_DOUBLE_BUFFER_ARB                     0x2011
+#define WGL_PIXEL_TYPE_ARB                        0x2013
+#define WGL_COLOR_BITS_ARB                        0x2014
+#define WGL_ALPHA_BITS_ARB                        0x201B
+#define WGL_DEPTH_BITS_ARB                        0x2022
+#define WGL_STENCIL_BITS_ARB                      0x2023
+#define WGL_FULL_ACCELERATION_ARB                 0x2027
+#define WGL_TYPE_RGBA_ARB                         0x202B
+#define WGL_SAMPLE_BUFFERS_ARB                    0x2041
+#define WGL_SAMPLES_ARB                           0x2042
+#define WGL_FRAMEBUFFER_SRGB_CAPABLE_ARB          0x20A9
+// WGL_ARB_create_context, WGL_ARB_create_context_profile, WGL_ARB_create_context_no_error
+#define WGL_CONTEXT_MAJOR_VERSION_ARB             0x2091
+#define WGL_CONTEXT_MINOR_VERSION_ARB             0x2092
+#define WGL_CONTEXT_FLAGS_ARB                     0x2094
+#define WGL_CONTEXT_DEBUG_BIT_ARB                 0x0001
+#define WGL_CONTEXT_FORWARD_COMPATIBLE_BIT_ARB    0x0002
+#define WGL_CONTEXT_PROFILE_MASK_ARB              0x9126
+#define WGL_CONTEXT_CORE_PROFILE_BIT_ARB          0x0001
+#define WGL_CONTEXT_COMPATIBILITY_PROFILE_BIT_ARB 0x0002
+#define WGL_CONTEXT_OPENGL_NO_ERROR_ARB           0x31B3
+
+typedef const char* (WINAPI* PFNWGLGETEXTENSIONSSTRINGARB)(HDC hdc);
+typedef BOOL(WINAPI* PFNWGLCHOOSEPIXELFORMATARB)(HDC hdc, const int* iAttribs, const FLOAT* fAttribs,
+    UINT maxFormats, int* formats, UINT* numFormats);
+typedef HGLRC(WINAPI* PFNWGLCREATECONTEXTATTRIBSARB)(HDC hdc, HGLRC share, const int* attribs);
+
+// WGL extension entry points, fetched once by the first window creation
+struct glwin_internal_WGL {
+    bool loaded = false;
+    PFNWGLCHOOSEPIXELFORMATARB choosePixelFormat = nullptr;
+    PFNWGLCREATECONTEXTATTRIBSARB createContextAttribs = nullptr;
+    bool profile = false;       // WGL_ARB_create_context_profile
+    bool noError = false;       // WGL_ARB_create_context_no_error
+    bool multisample = false;   // WGL_ARB_multisample
+    bool srgb = false;          // WGL_ARB_framebuffer_sRGB / WGL_EXT_framebuffer_sRGB
+};
+static glwin_internal_WGL g_GLwinWGL;
+
+// Whole-word match in a space separated extension list
+static bool glwin_internal_HasExtension(const char* list, const char* name)
+{
+    if (!list) return false;
+    size_t n = strlen(name);
+    for (const char* p = list; (p = strstr(p, name)) != nullptr; p += n) {
+        if ((p == list || p[-1] == ' ') && (p[n] == ' ' || p[n] == '\0')) return true;
+    }
+    return false;
+}
+
+// Helper: Set pixel format for OpenGL (legacy path, no MSAA or sRGB)
+static bool SetPixelFormatForGL(HDC hdc, int depthBits, int stencilBits) {
     PIXELFORMATDESCRIPTOR pfd = {};
     pfd.nSize = sizeof(PIXELFORMATDESCRIPTOR);
     pfd.nVersion = 1;
     pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
     pfd.iPixelType = PFD_TYPE_RGBA;
     pfd.cColorBits = 24;
-    pfd.cDepthBits = 24;
+    pfd.cDepthBits = (BYTE)depthBits;
+    pfd.cStencilBits = (BYTE)stencilBits;
     pfd.iLayerType = PFD_MAIN_PLANE;
 
     int pf = ChoosePixelFormat(hdc, &pfd);
@@ -84,6 +331,186 @@ static bool SetPixelFormatForGL(HDC hdc) {
     return true;
 }
 
+// Hidden 1x1 window, there only for a DC to create or bind a context on. It belongs to the
+// calling thread and must be destroyed there.
+static const wchar_t* GLWIN_HELPER_WINDOW_CLASS = L"GLWIN_HelperWindowClass";
+static bool helperClassRegistered = false;
+
+static HWND glwin_internal_CreateHelperWindow()
+{
+    HINSTANCE instance = GetModuleHandle(nullptr);
+    if (!helperClassRegistered) {
+        WNDCLASS wc = {};
+        wc.style = CS_OWNDC;
+        wc.lpfnWndProc = DefWindowProc;
+        wc.hInstance = instance;
+        wc.lpszClassName = GLWIN_HELPER_WINDOW_CLASS;
+        if (!RegisterClass(&wc)) {
+            GLWIN_LOG_ERROR("Could not register the GL helper window class (error " << GetLastError() << ")");
+            return NULL;
+        }
+        helperClassRegistered = true;
+    }
+    return CreateWindowEx(0, GLWIN_HELPER_WINDOW_CLASS, L"", WS_OVERLAPPEDWINDOW | WS_CLIPSIBLINGS | WS_CLIPCHILDREN,
+        0, 0, 1, 1, nullptr, nullptr, instance, nullptr);
+}
+
+// wglGetProcAddress only answers with a context current, and a window's pixel format can't be
+// changed once set, so the extensions are loaded through a helper window with a legacy context.
+static void glwin_internal_LoadWGL()
+{
+    glwin_internal_WGL& wgl = g_GLwinWGL;
+    if (wgl.loaded) return;
+    wgl.loaded = true;
+
+    HWND hwnd = glwin_internal_CreateHelperWindow();
+    HDC hdc = hwnd ? GetDC(hwnd) : NULL;
+    HGLRC rc = (hdc && SetPixelFormatForGL(hdc, 24, 8)) ? wglCreateContext(hdc) : NULL;
+
+    HDC prevDC = wglGetCurrentDC();
+    HGLRC prevRC = wglGetCurrentContext();
+    if (rc && wglMakeCurrent(hdc, rc)) {
+        PFNWGLGETEXTENSIONSSTRINGARB getExtensions =
+            (PFNWGLGETEXTENSIONSSTRINGARB)wglGetProcAddress("wglGetExtensionsStringARB");
+        const char* ext = getExtensions ? getExtensions(hdc) : nullptr;
+        if (glwin_internal_HasExtension(ext, "WGL_ARB_pixel_format"))
+            wgl.choosePixelFormat = (PFNWGLCHOOSEPIXELFORMATARB)wglGetProcAddress("wglChoosePixelFormatARB");
+        if (glwin_internal_HasExtension(ext, "WGL_ARB_create_context"))
+            wgl.createContextAttribs = (PFNWGLCREATECONTEXTATTRIBSARB)wglGetProcAddress("wglCreateContextAttribsARB");
+        wgl.profile = glwin_internal_HasExtension(ext, "WGL_ARB_create_context_profile");
+        wgl.noError = glwin_internal_HasExtension(ext, "WGL_ARB_create_context_no_error");
+        wgl.multisample = glwin_internal_HasExtension(ext, "WGL_ARB_multisample");
+        wgl.srgb = glwin_internal_HasExtension(ext, "WGL_ARB_framebuffer_sRGB") ||
+            glwin_internal_HasExtension(ext, "WGL_EXT_framebuffer_sRGB");
+        wglMakeCurrent(prevDC, prevRC);
+    }
+    else {
+        GLWIN_LOG_WARNING("Could not create the WGL helper context, using legacy contexts");
+    }
+    if (!wgl.choosePixelFormat || !wgl.createContextAttribs)
+        GLWIN_LOG_INFO("WGL_ARB_pixel_format/WGL_ARB_create_context missing, context hints are limited");
+
+    if (rc) wglDeleteContext(rc);
+    if (hdc) ReleaseDC(hwnd, hdc);
+    if (hwnd) DestroyWindow(hwnd);
+}
+
+static bool glwin_internal_ChoosePixelFormatARB(HDC hdc, const glwin_internal_ContextHints& hints, bool multisample, bool srgb)
+{
+    int attribs[32];
+    int n = 0;
+    auto set = [&](int key, int value) { attribs[n++] = key; attribs[n++] = value; };
+    set(WGL_DRAW_TO_WINDOW_ARB, TRUE);
+    set(WGL_SUPPORT_OPENGL_ARB, TRUE);
+    set(WGL_DOUBLE_BUFFER_ARB, TRUE);
+    set(WGL_ACCELERATION_ARB, WGL_FULL_ACCELERATION_ARB);
+    set(WGL_PIXEL_TYPE_ARB, WGL_TYPE_RGBA_ARB);
+    set(WGL_COLOR_BITS_ARB, 24);
+    set(WGL_ALPHA_BITS_ARB, 8);
+    set(WGL_DEPTH_BITS_ARB, hints.depthBits);
+    set(WGL_STENCIL_BITS_ARB, hints.stencilBits);
+    if (multisample) {
+        set(WGL_SAMPLE_BUFFERS_ARB, 1);
+        set(WGL_SAMPLES_ARB, hints.samples);
+    }
+    if (srgb) set(WGL_FRAMEBUFFER_SRGB_CAPABLE_ARB, TRUE);
+    attribs[n] = 0;
+
+    int pf = 0;
+    UINT count = 0;
+    if (!g_GLwinWGL.choosePixelFormat(hdc, attribs, nullptr, 1, &pf, &count) || count == 0) return false;
+    PIXELFORMATDESCRIPTOR pfd = {};
+    DescribePixelFormat(hdc, pf, sizeof(pfd), &pfd);
+    return SetPixelFormat(hdc, pf, &pfd) != FALSE;
+}
+
+// Pixel format from the framebuffer hints; MSAA and sRGB are dropped (with a warning) rather
+// than failing the window when no format has them
+static bool glwin_internal_SetPixelFormat(HDC hdc, const glwin_internal_ContextHints& hints)
+{
+    const glwin_internal_WGL& wgl = g_GLwinWGL;
+    if (!wgl.choosePixelFormat) {
+        if (hints.samples > 0 || hints.srgb)
+            GLWIN_LOG_WARNING("WGL_ARB_pixel_format missing, GLWIN_SAMPLES/GLWIN_SRGB_CAPABLE ignored");
+        return SetPixelFormatForGL(hdc, hints.depthBits, hints.stencilBits);
+    }
+
+    bool multisample = hints.samples > 0;
+    bool srgb = hints.srgb != 0;
+    if (multisample && !wgl.multisample) {
+        GLWIN_LOG_WARNING("WGL_ARB_multisample missing, GLWIN_SAMPLES ignored");
+        multisample = false;
+    }
+    if (srgb && !wgl.srgb) {
+        GLWIN_LOG_WARNING("WGL_ARB_framebuffer_sRGB missing, GLWIN_SRGB_CAPABLE ignored");
+        srgb = false;
+    }
+    if (glwin_internal_ChoosePixelFormatARB(hdc, hints, multisample, srgb)) return true;
+    if (multisample || srgb) {
+        GLWIN_LOG_WARNING("No pixel format with " << hints.samples << " samples" << (srgb ? " and sRGB" : "")
+            << ", falling back to a plain one");
+        if (glwin_internal_ChoosePixelFormatARB(hdc, hints, false, false)) return true;
+    }
+    return SetPixelFormatForGL(hdc, hints.depthBits, hints.stencilBits);
+}
+
+// Context from the context hints; share (may be NULL) shares its objects with the new context
+static HGLRC glwin_internal_CreateContext(HDC hdc, HGLRC share, const glwin_internal_ContextHints& hints)
+{
+    const glwin_internal_WGL& wgl = g_GLwinWGL;
+    bool versioned = hints.major != 1 || hints.minor != 0;
+
+    if (!wgl.createContextAttribs) {
+        if (versioned || hints.profile != GLWIN_OPENGL_ANY_PROFILE) {
+            GLWIN_LOG_ERROR("WGL_ARB_create_context missing, can't create an OpenGL "
+                << hints.major << "." << hints.minor << " context");
+            return NULL;
+        }
+        HGLRC rc = wglCreateContext(hdc);
+        if (rc && share && !wglShareLists(share, rc)) {
+            GLWIN_LOG_ERROR("wglShareLists failed (error " << GetLastError() << ")");
+            wglDeleteContext(rc);
+            return NULL;
+        }
+        return rc;
+    }
+
+    int attribs[16];
+    int n = 0;
+    auto set = [&](int key, int value) { attribs[n++] = key; attribs[n++] = value; };
+    if (versioned) {
+        set(WGL_CONTEXT_MAJOR_VERSION_ARB, hints.major);
+        set(WGL_CONTEXT_MINOR_VERSION_ARB, hints.minor);
+    }
+    int flags = 0;
+    if (hints.debug) flags |= WGL_CONTEXT_DEBUG_BIT_ARB;
+    if (hints.forwardCompat) flags |= WGL_CONTEXT_FORWARD_COMPATIBLE_BIT_ARB;
+    if (flags) set(WGL_CONTEXT_FLAGS_ARB, flags);
+    if (hints.profile != GLWIN_OPENGL_ANY_PROFILE) {
+        if (!wgl.profile) {
+            GLWIN_LOG_ERROR("WGL_ARB_create_context_profile missing, can't pick a context profile");
+            return NULL;
+        }
+        set(WGL_CONTEXT_PROFILE_MASK_ARB, hints.profile == GLWIN_OPENGL_CORE_PROFILE
+            ? WGL_CONTEXT_CORE_PROFILE_BIT_ARB : WGL_CONTEXT_COMPATIBILITY_PROFILE_BIT_ARB);
+    }
+    if (hints.noError) {
+        // a debug context asking for no errors is an invalid combination
+        if (hints.debug) GLWIN_LOG_WARNING("GLWIN_CONTEXT_NO_ERROR ignored for a debug context");
+        else if (!wgl.noError) GLWIN_LOG_WARNING("WGL_ARB_create_context_no_error missing, GLWIN_CONTEXT_NO_ERROR ignored");
+        else set(WGL_CONTEXT_OPENGL_NO_ERROR_ARB, TRUE);
+    }
+    attribs[n] = 0;
+
+    HGLRC rc = wgl.createContextAttribs(hdc, share, attribs);
+    if (!rc) {
+        GLWIN_LOG_ERROR("Could not create an OpenGL " << hints.major << "." << hints.minor
+            << (hints.profile == GLWIN_OPENGL_CORE_PROFILE ? " core" : "")
+            << " context (error 0x" << std::hex << GetLastError() << ")");
+    }
+    return rc;
+}
+
 // Forward declaration
 static LRESULT CALLBACK GLwin_WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
@@ -106,20 +533,29 @@ static std::string wstring_to_utf8(const std::wstring& wstr) {
     return str;
 }
 
-// Note: g_GLwinSwapInterval is defined/cached in your GLwin_set_swap implementation file.
-extern int g_GLwinSwapInterval; // 0 = no vsync, 1 = vsync, etc.
-
 static LARGE_INTEGER g_perfFreq;
-static LARGE_INTEGER g_lastPresentTime;
-static int g_vsyncInited = 0;
 
-static void vsync_init_if_needed() {
-    if (!g_vsyncInited) {
-        QueryPerformanceFrequency(&g_perfFreq);
-        QueryPerformanceCounter(&g_lastPresentTime);
-        g_vsyncInited = 1;
+static void vsync_init_if_needed(GLWIN_window* window) {
+    if (!g_perfFreq.QuadPart) QueryPerformanceFrequency(&g_perfFreq);
+    if (!window->lastPresentTime.QuadPart) QueryPerformanceCounter(&window->lastPresentTime);
+}
+
+// How long a present call waits for messages while every window is minimised
+#define GLWIN_ICONIFIED_WAIT_MS 100
+
+// Minimised windows present nothing. Once all of them are minimised the render loop would spin
+// flat out with nothing to show, so the present call waits for a message instead (bounded, so
+// timers in the app loop still run).
+static bool glwin_internal_SkipIconified(GLWIN_window* window)
+{
+    if (!window->iconified) return false;
+    for (GLWIN_window* w : g_GLwinWindows) {
+        if (!w->iconified) return true;
     }
+    MsgWaitForMultipleObjectsEx(0, nullptr, GLWIN_ICONIFIED_WAIT_MS, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    return true;
 }
+
 // -----------------------------------------------------------------------------
 // Backbuffer helpers (CreateDIBSection-backed, zero-copy)
 // -----------------------------------------------------------------------------
@@ -203,8 +639,6 @@ static int glwin_internal_create_backbuffer(GLWIN_window* window, int reqW, int
 
     return 1;
 }
-static int g_GLwinSwapInterval = 0;
-
 // typedef for wglSwapIntervalEXT
 typedef BOOL(WINAPI* PFNWGLSWAPINTERVALEXT)(int interval);
 
@@ -215,8 +649,11 @@ int GLwinSetSwapInterval(int interval)
 {
     if (interval < 0) interval = 0; // clamp negative values
 
-    int prev = g_GLwinSwapInterval;
-    g_GLwinSwapInterval = interval;
+    // the interval belongs to the window whose context is current
+    GLWIN_window* window = GLwinGetCurrentContext();
+    if (!window) return -1;
+    int prev = window->swapInterval;
+    window->swapInterval = interval;
 
     // Try to get and cache wglSwapIntervalEXT. This requires a current context on the calling thread.
     if (!g_wglSwapIntervalEXT) {
@@ -226,7 +663,7 @@ int GLwinSetSwapInterval(int interval)
 
     if (g_wglSwapIntervalEXT) {
         // call extension (no harm if it fails)
-        g_wglSwapIntervalEXT(g_GLwinSwapInterval);
+        g_wglSwapIntervalEXT(interval);
     }
 
     return prev;
@@ -236,34 +673,34 @@ int GLwinSetSwapInterval(int interval)
 void GLwinApplySwapIntervalSleep(GLWIN_window* window)
 {
     if (!window) return;
-    vsync_init_if_needed();
+    vsync_init_if_needed(window);
 
-    if (g_GLwinSwapInterval <= 0) {
-        QueryPerformanceCounter(&g_lastPresentTime);
+    if (window->swapInterval <= 0) {
+        QueryPerformanceCounter(&window->lastPresentTime);
         return;
     }
 
     int refreshHz = GLwinGetRefreshRate(window);
     if (refreshHz <= 0) {
         // unknown refresh rate => update lastPresent and return
-        QueryPerformanceCounter(&g_lastPresentTime);
+        QueryPerformanceCounter(&window->lastPresentTime);
         return;
     }
 
     // desired interval in seconds = interval / refreshHz
-    double desiredSec = (double)g_GLwinSwapInterval / (double)refreshHz;
+    double desiredSec = (double)window->swapInterval / (double)refreshHz;
     double desiredTicks = desiredSec * (double)g_perfFreq.QuadPart;
 
     LARGE_INTEGER now;
     QueryPerformanceCounter(&now);
 
-    double last = (double)g_lastPresentTime.QuadPart;
+    double last = (double)window->lastPresentTime.QuadPart;
     double target = last + desiredTicks;
     double nowd = (double)now.QuadPart;
 
     if (nowd >= target) {
         // we're late or on time - update lastPresent and return
-        g_lastPresentTime = now;
+        window->lastPresentTime = now;
         return;
     }
 
@@ -281,56 +718,12 @@ void GLwinApplySwapIntervalSleep(GLWIN_window* window)
         QueryPerformanceCounter(&now);
     } while ((double)now.QuadPart < target);
 
-    g_lastPresentTime = now;
+    window->lastPresentTime = now;
 }
 
 int GLwinGetRefreshRate(GLWIN_window* window) {
-    if (!window || !window->hwnd) return 0;
-
-    // Get the nearest monitor for the window
-    HMONITOR hMon = MonitorFromWindow(window->hwnd, MONITOR_DEFAULTTONEAREST);
-    if (!hMon) return 0;
-
-    MONITORINFOEX mi;
-    ZeroMemory(&mi, sizeof(mi));
-    mi.cbSize = sizeof(mi);
-    if (!GetMonitorInfo(hMon, &mi)) {
-        // Couldn't get monitor info
-        return 0;
-    }
-
-    // Primary method: EnumDisplaySettings for the monitor device name
-    DEVMODE dm;
-    ZeroMemory(&dm, sizeof(dm));
-    dm.dmSize = sizeof(dm);
-    if (EnumDisplaySettings(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm)) {
-        int freq = (int)dm.dmDisplayFrequency;
-        if (freq > 0) return freq;
-    }
-
-    // Fallback: GetDeviceCaps on the monitor's HDC
-    HDC hdc = NULL;
-    // Create a DC for the monitor device name (use CreateDC when device name available).
-    if (mi.szDevice[0] != 0) {
-        hdc = CreateDC(mi.szDevice, mi.szDevice, NULL, NULL);
-    }
-    if (!hdc) {
-        // Fallback to the window DC for the window's screen
-        hdc = GetDC(window->hwnd);
-    }
-    if (hdc) {
-        int vrefresh = GetDeviceCaps(hdc, VREFRESH);
-        if (hdc != GetDC(NULL)) { // if we created the DC using CreateDC, release it with DeleteDC
-            if (mi.szDevice[0] != 0) DeleteDC(hdc);
-        }
-        else {
-            ReleaseDC(window->hwnd, hdc);
-        }
-        if (vrefresh > 0) return vrefresh;
-    }
-
-    // Unknown
-    return 0;
+    const GLwinMonitor* monitor = GLwinGetWindowMonitor(window);
+    return monitor ? monitor->refreshRate : 0;
 }
 
 /* GLwinSetUserPointer & GLwinGetUserPointer they read/write the existing userPointer field already present in your internal GLWIN_window struct.
@@ -400,14 +793,9 @@ extern "C" {
         window->backHeight = 0;
     }
 
-    void GLwinPresentBackbuffer(GLWIN_window* window)
+    static void glwin_internal_PresentBackbuffer(GLWIN_window* window)
     {
-        if (!window || !window->hwnd) return;
-
-        if (!window->backBitmap || !window->backMemDC) {
-            // Nothing to present
-            return;
-        }
+        GLWIN_PROFILE_SCOPE("GLwinPresentBackbuffer");
 
         // Get window client size to determine destination rectangle
         RECT rc;
@@ -434,6 +822,19 @@ extern "C" {
         ReleaseDC(window->hwnd, hdcWindow);
     }
 
+    void GLwinPresentBackbuffer(GLWIN_window* window)
+    {
+        if (!window || !window->hwnd) return;
+
+        if (!window->backBitmap || !window->backMemDC) {
+            // Nothing to present
+            return;
+        }
+        if (glwin_internal_SkipIconified(window)) return;
+        glwin_internal_PresentBackbuffer(window);
+        GLwinProfileFrameMark();
+    }
+
 #ifdef __cplusplus
 }
 #endif
@@ -472,12 +873,15 @@ GLWIN_window* GLwin_CreateWindow(int width, int height, const wchar_t* title) {
         classRegistered = true;
     }
 
+    glwin_internal_InitDpiAwareness();
+
     GLWIN_window* win = new GLWIN_window();
     win->width = width;
     win->height = height;
+    win->resizable = g_GLwinResizableHint != 0;
     // Window hints
     DWORD style = WS_OVERLAPPEDWINDOW;
-    if (!g_GLwinResizableHint) {
+    if (!win->resizable) {
         style &= ~(WS_THICKFRAME | WS_MAXIMIZEBOX); // Remove resizing and maximize
     }
 
@@ -497,6 +901,13 @@ GLWIN_window* GLwin_CreateWindow(int width, int height, const wchar_t* title) {
     }
     win->hwnd = hwnd;
 
+    // The monitor is only known once the window exists; resize before it's shown
+    win->dpi = glwin_internal_GetWindowDpi(hwnd);
+    if (g_GLwinScaleToMonitorHint && win->dpi != USER_DEFAULT_SCREEN_DPI) {
+        SetWindowPos(hwnd, nullptr, 0, 0, MulDiv(width, win->dpi, USER_DEFAULT_SCREEN_DPI),
+            MulDiv(height, win->dpi, USER_DEFAULT_SCREEN_DPI), SWP_NOMOVE | SWP_NOZORDER | SWP_NOACTIVATE);
+    }
+
     // windows hints
     // Apply maximized hint BEFORE showing window
     if (g_GLwinMaximizedHint) {
@@ -512,14 +923,16 @@ GLWIN_window* GLwin_CreateWindow(int width, int height, const wchar_t* title) {
     DragAcceptFiles(hwnd, TRUE); // darg adn drop
 
     // Setup OpenGL
+    glwin_internal_LoadWGL();
+    win->contextHints = g_GLwinContextHints;
     win->hdc = GetDC(hwnd);
-    if (!win->hdc || !SetPixelFormatForGL(win->hdc)) {
+    if (!win->hdc || !glwin_internal_SetPixelFormat(win->hdc, win->contextHints)) {
         DestroyWindow(hwnd);
         delete win;
         return nullptr;
     }
 
-    win->hglrc = wglCreateContext(win->hdc);
+    win->hglrc = glwin_internal_CreateContext(win->hdc, NULL, win->contextHints);
     if (!win->hglrc) {
         ReleaseDC(hwnd, win->hdc);
         DestroyWindow(hwnd);
@@ -534,6 +947,7 @@ GLWIN_window* GLwin_CreateWindow(int width, int height, const wchar_t* title) {
         return nullptr;
     }
 
+    g_GLwinWindows.push_back(win);
     return win;
 }
 
@@ -543,8 +957,16 @@ void GLwin_DestroyWindow(GLWIN_window* window) {
 	// Destroy backbuffer if any presant
 	GLwinDestroyBackbuffer(window);
 
+    for (size_t i = 0; i < g_GLwinWindows.size(); ++i) {
+        if (g_GLwinWindows[i] == window) {
+            g_GLwinWindows.erase(g_GLwinWindows.begin() + i);
+            break;
+        }
+    }
+
     if (window->hglrc) {
-        wglMakeCurrent(nullptr, nullptr);
+        // another window's context may be the current one
+        if (wglGetCurrentContext() == window->hglrc) wglMakeCurrent(nullptr, nullptr);
         wglDeleteContext(window->hglrc);
         window->hglrc = nullptr;
     }
@@ -553,9 +975,13 @@ void GLwin_DestroyWindow(GLWIN_window* window) {
         window->hdc = nullptr;
     }
     if (window->hwnd) {
+        // no messages may reach the window once it's deleted
+        SetWindowLongPtr(window->hwnd, GWLP_USERDATA, 0);
         DestroyWindow(window->hwnd);
         window->hwnd = nullptr;
     }
+    if (window->iconBig) DestroyIcon(window->iconBig);
+    if (window->iconSmall) DestroyIcon(window->iconSmall);
     delete window;
 }
 
@@ -572,7 +998,8 @@ void GLwinEnableCustomTitleBar(GLWIN_window* window, int enable)
     }
     else {
         // Restore default style
-        style |= (WS_CAPTION | WS_SYSMENU | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX);
+        style |= (WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX);
+        if (window->resizable) style |= (WS_THICKFRAME | WS_MAXIMIZEBOX);
     }
     SetWindowLongPtr(window->hwnd, GWL_STYLE, style);
     SetWindowPos(window->hwnd, nullptr, 0, 0, 0, 0,
@@ -582,9 +1009,27 @@ void GLwinEnableCustomTitleBar(GLWIN_window* window, int enable)
 
 void GLwinMakeContextCurrent(GLWIN_window* window) {
     if (!window || !window->hdc || !window->hglrc) return;
+    // wglGetCurrent* only read thread state; wglMakeCurrent flushes and goes through the driver
+    if (wglGetCurrentContext() == window->hglrc && wglGetCurrentDC() == window->hdc) return;
     wglMakeCurrent(window->hdc, window->hglrc);
 }
 
+GLWIN_window* GLwinGetCurrentContext(void)
+{
+    HGLRC current = wglGetCurrentContext();
+    if (!current) return nullptr;
+    for (GLWIN_window* window : g_GLwinWindows) {
+        if (window->hglrc == current) return window;
+    }
+    return nullptr;
+}
+
+GLWIN_window** GLwinGetWindows(int* count)
+{
+    if (count) *count = (int)g_GLwinWindows.size();
+    return g_GLwinWindows.empty() ? nullptr : g_GLwinWindows.data();
+}
+
 void* GLwinGetProcAddress(const char* procname)
 {
     void* p = (void*)wglGetProcAddress(procname);
@@ -597,19 +1042,138 @@ void* GLwinGetProcAddress(const char* procname)
     return p;
 }
 
+// Worker contexts (GLwinContext.h). Each one binds on a helper window's DC, which WGL needs
+// to have the same pixel format as the context it shares with.
+struct GLWIN_context {
+    HWND hwnd = nullptr;
+    HDC hdc = nullptr;
+    HGLRC hglrc = nullptr;
+    glwin_internal_ContextHints hints;
+};
+
+static GLWIN_context* glwin_internal_CreateOffscreen(HDC shareDC, HGLRC share, const glwin_internal_ContextHints& hints)
+{
+    glwin_internal_LoadWGL();
+    GLWIN_context* context = new GLWIN_context();
+    context->hints = hints;
+    context->hwnd = glwin_internal_CreateHelperWindow();
+    context->hdc = context->hwnd ? GetDC(context->hwnd) : NULL;
+
+    bool formatSet = false;
+    if (context->hdc && shareDC) {
+        PIXELFORMATDESCRIPTOR pfd = {};
+        int pf = GetPixelFormat(shareDC);
+        formatSet = pf != 0 && DescribePixelFormat(shareDC, pf, sizeof(pfd), &pfd) != 0 &&
+            SetPixelFormat(context->hdc, pf, &pfd) != FALSE;
+    }
+    else if (context->hdc) {
+        formatSet = glwin_internal_SetPixelFormat(context->hdc, hints);
+    }
+    if (formatSet) context->hglrc = glwin_internal_CreateContext(context->hdc, share, hints);
+    if (!context->hglrc) {
+        GLWIN_LOG_ERROR("Could not create an offscreen OpenGL context");
+        GLwinDestroyContext(context);
+        return nullptr;
+    }
+    return context;
+}
+
+GLWIN_context* GLwinCreateSharedContext(GLWIN_window* window)
+{
+    if (!window || !window->hdc || !window->hglrc) return nullptr;
+    return glwin_internal_CreateOffscreen(window->hdc, window->hglrc, window->contextHints);
+}
+
+GLWIN_context* GLwinCreateOffscreenContext(GLWIN_context* share)
+{
+    if (share) return glwin_internal_CreateOffscreen(share->hdc, share->hglrc, share->hints);
+    return glwin_internal_CreateOffscreen(NULL, NULL, g_GLwinContextHints);
+}
+
+void GLwinDestroyContext(GLWIN_context* context)
+{
+    if (!context) return;
+    if (context->hglrc) {
+        if (wglGetCurrentContext() == context->hglrc) wglMakeCurrent(nullptr, nullptr);
+        wglDeleteContext(context->hglrc);
+    }
+    if (context->hdc) ReleaseDC(context->hwnd, context->hdc);
+    if (context->hwnd) DestroyWindow(context->hwnd);
+    delete context;
+}
+
+int GLwinMakeOffscreenContextCurrent(GLWIN_context* context)
+{
+    BOOL ok = context ? wglMakeCurrent(context->hdc, context->hglrc) : wglMakeCurrent(nullptr, nullptr);
+    if (!ok) GLWIN_LOG_ERROR("wglMakeCurrent failed (error " << GetLastError() << ")");
+    return ok ? 1 : 0;
+}
+
+void* GLwinGetCurrentNativeContext(void)
+{
+    return (void*)wglGetCurrentContext();
+}
+
 void GLwinSwapBuffers(GLWIN_window* window) {
-    if (window && window->hdc) {
-        ::SwapBuffers(window->hdc);
+    if (window && glwin_internal_SkipIconified(window)) return;
+    {
+        GLWIN_PROFILE_SCOPE("GLwinSwapBuffers");
+        if (window && window->hdc) {
+            ::SwapBuffers(window->hdc);
+        }
     }
+    GLwinProfileFrameMark();
 }
 
 void GLwinPollEvents(void) {
+    GLWIN_PROFILE_SCOPE("GLwinPollEvents");
     MSG msg;
     while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
 }
+
+int GLwinWindowIsIconified(GLWIN_window* window)
+{
+    return (window && window->iconified) ? 1 : 0;
+}
+
+int GLwinWindowIsFocused(GLWIN_window* window)
+{
+    return (window && window->focused) ? 1 : 0;
+}
+
+void GLwinSetResizeCallback(GLWIN_window* window, GLwinResizeCallback cb)
+{
+    if (window) window->resizeCallback = cb;
+}
+
+void GLwinSetFramebufferSizeCallback(GLWIN_window* window, GLwinFramebufferSizeCallback cb)
+{
+    if (window) window->framebufferSizeCallback = cb;
+}
+
+void GLwinSetFocusCallback(GLWIN_window* window, GLwinFocusCallback cb)
+{
+    if (window) window->focusCallback = cb;
+}
+
+void GLwinSetIconifyCallback(GLWIN_window* window, GLwinIconifyCallback cb)
+{
+    if (window) window->iconifyCallback = cb;
+}
+
+void GLwinSetRefreshCallback(GLWIN_window* window, GLwinRefreshCallback cb)
+{
+    if (window) window->refreshCallback = cb;
+}
+
+void GLwinSetLiveResizeCallback(GLWIN_window* window, GLwinLiveResizeCallback cb)
+{
+    if (window) window->liveResizeCallback = cb;
+}
+
 bool GLwinWindowShouldClose(GLWIN_window* window, bool close) {
 	if (window) {
 		if (close) {
@@ -710,6 +1274,80 @@ void GLwinSetWindowIcon(GLWIN_window* window, const wchar_t* iconPath) {
     }
 }
 
+// .ico file layout: ICONDIR followed by ICONDIRENTRY[count], each pointing at a BMP or PNG image
+#pragma pack(push, 2)
+struct glwin_internal_IconDirEntry {
+    BYTE width, height, colorCount, reserved;
+    WORD planes, bitCount;
+    DWORD bytesInRes;
+    DWORD imageOffset;
+};
+#pragma pack(pop)
+
+static HICON glwin_internal_IconFromMemory(const BYTE* data, size_t size, int cx, int cy)
+{
+    if (size < 6) return NULL;
+    WORD type = *(const WORD*)(data + 2);
+    WORD count = *(const WORD*)(data + 4);
+    if (type != 1 || count == 0 || size < 6 + (size_t)count * sizeof(glwin_internal_IconDirEntry)) return NULL;
+
+    // Smallest image at least as big as requested, else the biggest; deeper colour breaks ties
+    const glwin_internal_IconDirEntry* entries = (const glwin_internal_IconDirEntry*)(data + 6);
+    int best = -1, bestW = 0, bestBits = 0;
+    for (int i = 0; i < count; ++i) {
+        const glwin_internal_IconDirEntry& e = entries[i];
+        if ((size_t)e.imageOffset > size || e.bytesInRes > size - e.imageOffset) continue;
+        int w = e.width ? e.width : 256;
+        bool better;
+        if (best < 0) better = true;
+        else if ((w >= cx) != (bestW >= cx)) better = w >= cx;
+        else if (w != bestW) better = (w >= cx) ? w < bestW : w > bestW;
+        else better = e.bitCount > bestBits;
+        if (better) {
+            best = i;
+            bestW = w;
+            bestBits = e.bitCount;
+        }
+    }
+    if (best < 0) return NULL;
+    const glwin_internal_IconDirEntry& e = entries[best];
+    return CreateIconFromResourceEx((PBYTE)(data + e.imageOffset), e.bytesInRes, TRUE, 0x00030000,
+        cx, cy, LR_DEFAULTCOLOR);
+}
+
+int GLwinSetWindowIconFromMemory(GLWIN_window* window, const void* data, size_t size)
+{
+    if (!window || !window->hwnd || !data) return 0;
+    const BYTE* bytes = (const BYTE*)data;
+    HICON bigIcon = glwin_internal_IconFromMemory(bytes, size, GetSystemMetrics(SM_CXICON), GetSystemMetrics(SM_CYICON));
+    HICON smallIcon = glwin_internal_IconFromMemory(bytes, size, GetSystemMetrics(SM_CXSMICON), GetSystemMetrics(SM_CYSMICON));
+    if (!bigIcon || !smallIcon) {
+        GLWIN_LOG_ERROR("Invalid icon data");
+        if (bigIcon) DestroyIcon(bigIcon);
+        if (smallIcon) DestroyIcon(smallIcon);
+        return 0;
+    }
+    SendMessage(window->hwnd, WM_SETICON, ICON_BIG, (LPARAM)bigIcon);
+    SendMessage(window->hwnd, WM_SETICON, ICON_SMALL, (LPARAM)smallIcon);
+    if (window->iconBig) DestroyIcon(window->iconBig);
+    if (window->iconSmall) DestroyIcon(window->iconSmall);
+    window->iconBig = bigIcon;
+    window->iconSmall = smallIcon;
+    return 1;
+}
+
+int GLwinSetWindowIconResource(GLWIN_window* window, const char* name)
+{
+    GLwinFileView view;
+    if (!name || !GLwinLoadResource(name, &view)) {
+        GLWIN_LOG_ERROR("Icon resource not found: " << (name ? name : "(null)"));
+        return 0;
+    }
+    int ok = GLwinSetWindowIconFromMemory(window, view.data, view.size);
+    GLwinReleaseResource(&view);
+    return ok;
+}
+
 void GLwinGetTimer(GLWIN_window* window, int tstart, int tmax)
 {
 	if (!window) return;
@@ -745,11 +1383,31 @@ void GLwinWindowHint(int hint, int value) {
         std::cout << "GLwinWindowHint: GLWIN_RESIZABLE hint set to " << value << " (implemented)\n";
         g_GLwinResizableHint = value;
         break;
+    case GLWIN_SCALE_TO_MONITOR:      g_GLwinScaleToMonitorHint = value; break;
+    case GLWIN_CONTEXT_VERSION_MAJOR: g_GLwinContextHints.major = value; break;
+    case GLWIN_CONTEXT_VERSION_MINOR: g_GLwinContextHints.minor = value; break;
+    case GLWIN_OPENGL_PROFILE:        g_GLwinContextHints.profile = value; break;
+    case GLWIN_OPENGL_FORWARD_COMPAT: g_GLwinContextHints.forwardCompat = value; break;
+    case GLWIN_OPENGL_DEBUG_CONTEXT:  g_GLwinContextHints.debug = value; break;
+    case GLWIN_CONTEXT_NO_ERROR:      g_GLwinContextHints.noError = value; break;
+    case GLWIN_DEPTH_BITS:            g_GLwinContextHints.depthBits = value; break;
+    case GLWIN_STENCIL_BITS:          g_GLwinContextHints.stencilBits = value; break;
+    case GLWIN_SAMPLES:               g_GLwinContextHints.samples = value; break;
+    case GLWIN_SRGB_CAPABLE:          g_GLwinContextHints.srgb = value; break;
     default:
+        GLWIN_LOG_DEBUG("GLwinWindowHint: unknown hint 0x" << std::hex << hint);
         break;
     }
 }
 
+void GLwinDefaultWindowHints(void)
+{
+    g_GLwinMaximizedHint = 0;
+    g_GLwinResizableHint = 1;
+    g_GLwinScaleToMonitorHint = 1;
+    g_GLwinContextHints = glwin_internal_ContextHints();
+}
+
 
 // Keyboard state 
 int GLwinGetKey(GLWIN_window* window, int keycode) {
@@ -1016,7 +1674,13 @@ void GLwinSetWindowTitle(GLWIN_window* window, const wchar_t* title)
 
 // Optional: terminate function
 void GLwinTerminate(void) {
-    // For now, nothing (all handled per-window)
+    if (!g_GLwinWindows.empty())
+        GLWIN_LOG_WARNING("GLwinTerminate: destroying " << g_GLwinWindows.size() << " window(s) still open");
+    while (!g_GLwinWindows.empty()) GLwin_DestroyWindow(g_GLwinWindows.back());
+
+    HINSTANCE instance = GetModuleHandle(nullptr);
+    if (classRegistered && UnregisterClass(GLWIN_WINDOW_CLASS, instance)) classRegistered = false;
+    if (helperClassRegistered && UnregisterClass(GLWIN_HELPER_WINDOW_CLASS, instance)) helperClassRegistered = false;
 }
 
 // Helper: compute modifier flags for callbacks
@@ -1032,6 +1696,25 @@ static int glwin_get_mods_from_key_state()
 }
 
 
+// Live resize timer id; SetTimer ids are per window
+static const UINT_PTR GLWIN_LIVE_RESIZE_TIMER = 0x474C;
+
+// Hand a new client size to the backbuffer and the size callbacks (once per distinct size)
+static void glwin_internal_ApplySize(GLWIN_window* window)
+{
+    window->sizePending = false;
+    if (window->width == window->reportedWidth && window->height == window->reportedHeight) return;
+    window->reportedWidth = window->width;
+    window->reportedHeight = window->height;
+    // Recreate backbuffer on resize (if present)
+    if (window->backBitmap) {
+        GLwinDestroyBackbuffer(window);
+        glwin_internal_create_backbuffer(window, window->width, window->height);
+    }
+    if (window->resizeCallback) window->resizeCallback(window->width, window->height);
+    if (window->framebufferSizeCallback) window->framebufferSizeCallback(window->width, window->height);
+}
+
 // Window procedure (handles messages and input)
 static LRESULT CALLBACK GLwin_WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     GLWIN_window* window = nullptr;
@@ -1046,25 +1729,99 @@ static LRESULT CALLBACK GLwin_WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
     }
 
     switch (msg) {
+    case WM_DPICHANGED:
+        g_GLwinMonitorsValid = false;
+        if (window) {
+            window->dpi = HIWORD(wParam);
+            // the suggested rect keeps the window the same physical size on its new monitor;
+            // applying it sends the WM_SIZE that resizes the framebuffer
+            const RECT* r = reinterpret_cast<const RECT*>(lParam);
+            SetWindowPos(hwnd, nullptr, r->left, r->top, r->right - r->left, r->bottom - r->top,
+                SWP_NOZORDER | SWP_NOACTIVATE);
+            if (window->contentScaleCallback) {
+                float scale = (float)window->dpi / (float)USER_DEFAULT_SCREEN_DPI;
+                window->contentScaleCallback(scale, scale);
+            }
+        }
+        return 0;
+    case WM_DISPLAYCHANGE:
+        g_GLwinMonitorsValid = false;
+        break;
+    case WM_SETTINGCHANGE:
+        if (wParam == SPI_SETWORKAREA) g_GLwinMonitorsValid = false;
+        break;
     case WM_CLOSE:
+        // only flag it: the app decides when (and whether) the window goes away
         if (window) window->closed = true;
-        PostQuitMessage(0);
         return 0;
     case WM_SIZE:
         if (window) {
+            bool iconified = wParam == SIZE_MINIMIZED;
+            if (iconified != window->iconified) {
+                window->iconified = iconified;
+                if (window->iconifyCallback) window->iconifyCallback(iconified ? 1 : 0);
+            }
+            // minimising reports 0x0: keep the last real size
+            if (iconified) return 0;
             window->width = LOWORD(lParam);
             window->height = HIWORD(lParam);
-            // Recreate backbuffer on resize (if present)
-            if (window->backBitmap) {
-                // Destroy and recreate with new size
-                GLwinDestroyBackbuffer(window);
-                glwin_internal_create_backbuffer(window, window->width, window->height);
-            }
-            if (window->resizeCallback) {
-                window->resizeCallback(window->width, window->height);
-            }
+            // while the user drags the frame, WM_SIZE comes in bursts: coalesce to the timer
+            if (window->inSizeMove) window->sizePending = true;
+            else glwin_internal_ApplySize(window);
         }
         return 0;
+    case WM_ENTERSIZEMOVE:
+        // DispatchMessage doesn't return until the drag ends, so the app loop is stalled; a
+        // timer at the display refresh rate lets the live resize callback draw meanwhile
+        if (window) {
+            window->inSizeMove = true;
+            int hz = GLwinGetRefreshRate(window);
+            UINT period = hz > 0 ? (UINT)(1000 / hz) : 16;
+            SetTimer(hwnd, GLWIN_LIVE_RESIZE_TIMER, period < USER_TIMER_MINIMUM ? USER_TIMER_MINIMUM : period, nullptr);
+        }
+        break;
+    case WM_EXITSIZEMOVE:
+        if (window) {
+            KillTimer(hwnd, GLWIN_LIVE_RESIZE_TIMER);
+            window->inSizeMove = false;
+            if (window->sizePending) glwin_internal_ApplySize(window);
+        }
+        break;
+    case WM_TIMER:
+        if (window && wParam == GLWIN_LIVE_RESIZE_TIMER) {
+            if (window->sizePending) {
+                glwin_internal_ApplySize(window);
+                if (window->liveResizeCallback) window->liveResizeCallback(window->width, window->height);
+            }
+            return 0;
+        }
+        break;
+    case WM_SETFOCUS:
+        if (window) {
+            window->focused = true;
+            if (window->focusCallback) window->focusCallback(1);
+        }
+        break;
+    case WM_KILLFOCUS:
+        if (window) {
+            window->focused = false;
+            // the key-ups will go to whichever window has focus now; don't leave keys held
+            window->keyState.clear();
+            if (window->focusCallback) window->focusCallback(0);
+        }
+        break;
+    case WM_PAINT:
+        // contents lost (uncovered, restored...): let the app redraw. During live resize the
+        // timer does the drawing, at a bounded rate.
+        if (window && window->refreshCallback && !window->inSizeMove && !window->iconified) {
+            window->refreshCallback();
+            ValidateRect(hwnd, nullptr);
+            return 0;
+        }
+        break;
+    case WM_ERASEBKGND:
+        // GL or the backbuffer covers the whole client area; erasing first only flickers
+        return 1;
 	case WM_DROPFILES:
         if (window && window->dropCallback) {
             HDROP hDrop = (HDROP)wParam;
@@ -0,0 +1,184 @@
+// GLwinContext.h on top of EGL, for platforms without WGL. Win32 builds use GLwin.cpp.
+#ifndef _WIN32
+#include "../GLwinContext.h"
+#include "../GLwinLog.h"
+#include "GLwinContextHints.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <string.h>
+#include <mutex>
+
+struct GLWIN_context {
+    EGLContext context = EGL_NO_CONTEXT;
+    glwin_internal_ContextHints hints;
+};
+
+static EGLDisplay g_GLwinEGLDisplay = EGL_NO_DISPLAY;
+static EGLConfig g_GLwinEGLConfig = nullptr;     // EGL_NO_CONFIG_KHR when the driver allows it
+static bool g_GLwinEGLNoError = false;           // EGL_KHR_create_context_no_error
+static std::once_flag g_GLwinEGLOnce;
+
+// only the context hints mean anything without windows (defaults documented at GLwinWindowHint)
+static glwin_internal_ContextHints g_GLwinContextHints;
+
+void GLwinWindowHint(int hint, int value)
+{
+    switch (hint)
+    {
+    case GLWIN_CONTEXT_VERSION_MAJOR: g_GLwinContextHints.major = value; break;
+    case GLWIN_CONTEXT_VERSION_MINOR: g_GLwinContextHints.minor = value; break;
+    case GLWIN_OPENGL_PROFILE:        g_GLwinContextHints.profile = value; break;
+    case GLWIN_OPENGL_FORWARD_COMPAT: g_GLwinContextHints.forwardCompat = value; break;
+    case GLWIN_OPENGL_DEBUG_CONTEXT:  g_GLwinContextHints.debug = value; break;
+    case GLWIN_CONTEXT_NO_ERROR:      g_GLwinContextHints.noError = value; break;
+    default:
+        GLWIN_LOG_DEBUG("GLwinWindowHint: hint 0x" << std::hex << hint << " has no effect without windows");
+        break;
+    }
+}
+
+void GLwinDefaultWindowHints(void)
+{
+    g_GLwinContextHints = glwin_internal_ContextHints();
+}
+
+// Mesa's surfaceless platform needs no display server; other drivers get the default display
+static void glwin_internal_InitEGL()
+{
+    const char* clientExt = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay display = EGL_NO_DISPLAY;
+    if (getPlatformDisplay && clientExt && strstr(clientExt, "EGL_MESA_platform_surfaceless"))
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        GLWIN_LOG_ERROR("Could not initialise EGL (error 0x" << std::hex << eglGetError() << ")");
+        return;
+    }
+
+    const char* ext = eglQueryString(display, EGL_EXTENSIONS);
+    if (!ext || !strstr(ext, "EGL_KHR_surfaceless_context")) {
+        GLWIN_LOG_ERROR("EGL " << major << "." << minor << " without EGL_KHR_surfaceless_context, no offscreen contexts");
+        eglTerminate(display);
+        return;
+    }
+    if (!strstr(ext, "EGL_KHR_no_config_context")) {
+        const EGLint attribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLint count = 0;
+        if (!eglChooseConfig(display, attribs, &g_GLwinEGLConfig, 1, &count) || count == 0) {
+            GLWIN_LOG_ERROR("No EGL config supports desktop OpenGL");
+            eglTerminate(display);
+            return;
+        }
+    }
+    g_GLwinEGLNoError = strstr(ext, "EGL_KHR_create_context_no_error") != nullptr;
+    g_GLwinEGLDisplay = display;
+    GLWIN_LOG_INFO("EGL " << major << "." << minor << " (" << eglQueryString(display, EGL_VENDOR) << ")");
+}
+
+GLWIN_context* GLwinCreateSharedContext(GLWIN_window* window)
+{
+    (void)window;
+    GLWIN_LOG_ERROR("GLwinCreateSharedContext: no windows on this platform, use GLwinCreateOffscreenContext");
+    return nullptr;
+}
+
+// Attribute list for eglCreateContext from the hints; the version and profile are left out when
+// neither is hinted. Returns the number of entries before EGL_NONE.
+static int glwin_internal_ContextAttribs(const glwin_internal_ContextHints& hints, bool versioned, EGLint* attribs)
+{
+    int n = 0;
+    auto set = [&](EGLint key, EGLint value) { attribs[n++] = key; attribs[n++] = value; };
+    if (versioned) {
+        set(EGL_CONTEXT_MAJOR_VERSION, hints.major);
+        set(EGL_CONTEXT_MINOR_VERSION, hints.minor);
+    }
+    if (hints.profile != GLWIN_OPENGL_ANY_PROFILE) {
+        set(EGL_CONTEXT_OPENGL_PROFILE_MASK, hints.profile == GLWIN_OPENGL_CORE_PROFILE
+            ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT);
+    }
+    if (hints.forwardCompat) set(EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE, EGL_TRUE);
+    if (hints.debug) set(EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE);
+    if (hints.noError) {
+        // a debug context asking for no errors is an invalid combination
+        if (hints.debug) GLWIN_LOG_WARNING("GLWIN_CONTEXT_NO_ERROR ignored for a debug context");
+        else if (!g_GLwinEGLNoError) GLWIN_LOG_WARNING("EGL_KHR_create_context_no_error missing, GLWIN_CONTEXT_NO_ERROR ignored");
+        else set(EGL_CONTEXT_OPENGL_NO_ERROR_KHR, EGL_TRUE);
+    }
+    attribs[n] = EGL_NONE;
+    return n;
+}
+
+GLWIN_context* GLwinCreateOffscreenContext(GLWIN_context* share)
+{
+    std::call_once(g_GLwinEGLOnce, glwin_internal_InitEGL);
+    if (g_GLwinEGLDisplay == EGL_NO_DISPLAY) return nullptr;
+    // the bound API is per thread and picks what eglCreateContext makes
+    eglBindAPI(EGL_OPENGL_API);
+
+    // a shared context gets the hints its share was made with, like on Win32
+    const glwin_internal_ContextHints hints = share ? share->hints : g_GLwinContextHints;
+    const bool versioned = hints.major != 1 || hints.minor != 0;
+    EGLContext shareContext = share ? share->context : EGL_NO_CONTEXT;
+    EGLint attribs[16];
+    EGLContext context = EGL_NO_CONTEXT;
+    if (!versioned && hints.profile == GLWIN_OPENGL_ANY_PROFILE) {
+        // nothing asked for: 3.2 core is a floor (drivers hand out the newest core version they
+        // have), and whatever the driver's default is otherwise
+        glwin_internal_ContextHints core = hints;
+        core.major = 3;
+        core.minor = 2;
+        core.profile = GLWIN_OPENGL_CORE_PROFILE;
+        glwin_internal_ContextAttribs(core, true, attribs);
+        context = eglCreateContext(g_GLwinEGLDisplay, g_GLwinEGLConfig, shareContext, attribs);
+    }
+    if (context == EGL_NO_CONTEXT) {
+        glwin_internal_ContextAttribs(hints, versioned, attribs);
+        context = eglCreateContext(g_GLwinEGLDisplay, g_GLwinEGLConfig, shareContext, attribs);
+    }
+    if (context == EGL_NO_CONTEXT) {
+        GLWIN_LOG_ERROR("Could not create an offscreen OpenGL " << hints.major << "." << hints.minor
+            << (hints.profile == GLWIN_OPENGL_CORE_PROFILE ? " core" : "")
+            << " context (error 0x" << std::hex << eglGetError() << ")");
+        return nullptr;
+    }
+    GLWIN_context* result = new GLWIN_context();
+    result->context = context;
+    result->hints = hints;
+    return result;
+}
+
+void GLwinDestroyContext(GLWIN_context* context)
+{
+    if (!context) return;
+    if (eglGetCurrentContext() == context->context)
+        eglMakeCurrent(g_GLwinEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(g_GLwinEGLDisplay, context->context);
+    delete context;
+}
+
+int GLwinMakeOffscreenContextCurrent(GLWIN_context* context)
+{
+    if (g_GLwinEGLDisplay == EGL_NO_DISPLAY) return context ? 0 : 1;
+    EGLContext egl = context ? context->context : EGL_NO_CONTEXT;
+    if (!eglMakeCurrent(g_GLwinEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, egl)) {
+        GLWIN_LOG_ERROR("eglMakeCurrent failed (error 0x" << std::hex << eglGetError() << ")");
+        return 0;
+    }
+    return 1;
+}
+
+void* GLwinGetCurrentNativeContext(void)
+{
+    EGLContext context = eglGetCurrentContext();
+    return context == EGL_NO_CONTEXT ? nullptr : (void*)context;
+}
+
+void* GLwinGetProcAddress(const char* procname)
+{
+    return (void*)eglGetProcAddress(procname);
+}
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+// Context and framebuffer hints shared by the WGL (GLwin.cpp) and EGL (GLwinContextEGL.cpp)
+// backends. Set through GLwinWindowHint; defaults documented there.
+#include "../GLwinDefs.h"
+
+struct glwin_internal_ContextHints {
+    int major = 1;
+    int minor = 0;
+    int profile = GLWIN_OPENGL_ANY_PROFILE;
+    int forwardCompat = 0;
+    int debug = 0;
+    int noError = 0;
+    int depthBits = 24;
+    int stencilBits = 8;
+    int samples = 0;
+    int srgb = 0;
+};
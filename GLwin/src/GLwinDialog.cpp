@@ -32,7 +32,7 @@ std::string GLwinOpenDialog()
 		DWORD err = CommDlgExtendedError();
 		if (err != 0) {
 			// Handle the error as needed
-			GLWIN_LOG_ERROR("GetOpenFileName failed with error code: " << err << std::endl);
+			GLWIN_LOG_ERROR("GetOpenFileName failed with error code: " << err);
 
 			return "";
 		}
@@ -69,7 +69,7 @@ std::string GLwinSaveDialog()
 	else {
 		DWORD err = CommDlgExtendedError();
 		if (err != 0) {
-			GLWIN_LOG_ERROR("GetSaveFileName failed with error code: " << err << std::endl);
+			GLWIN_LOG_ERROR("GetSaveFileName failed with error code: " << err);
 		}
 		return "";
 	}
@@ -0,0 +1,679 @@
+#include "../GLwinLog.h"
+#include "../GLwinLogFile.h"
+#include "../GLwinTime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+std::atomic<int> g_GLwinLogLevel{ GLWIN_LOG_LEVEL_ACTIVE };
+
+struct glwin_internal_LogRecord {
+    uint64_t ticks;
+    uint32_t thread;
+    uint32_t site;                     // 0: text holds the message, else the encoded arguments
+    uint16_t length;
+    uint8_t level;
+    char text[GLWIN_LOG_MAX_MESSAGE];
+};
+
+// Single producer (the owning thread), single consumer (the sink)
+struct glwin_internal_LogRing {
+    alignas(64) std::atomic<uint32_t> head{ 0 };   // next slot the producer writes
+    alignas(64) std::atomic<uint32_t> tail{ 0 };   // next slot the sink reads
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<bool> retired{ false };            // owning thread has exited
+    uint32_t thread = 0;
+    glwin_internal_LogRecord records[GLWIN_LOG_RING_SIZE];
+};
+
+static_assert((GLWIN_LOG_RING_SIZE & (GLWIN_LOG_RING_SIZE - 1)) == 0, "GLWIN_LOG_RING_SIZE must be a power of two");
+
+struct glwin_internal_Logger {
+    std::mutex ringsMutex;                         // only taken when a thread logs for the first time
+    std::vector<glwin_internal_LogRing*> rings;
+    uint32_t nextThread = 1;
+
+    std::thread sink;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> stopped{ false };
+    std::once_flag startOnce;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+
+    std::atomic<uint64_t> droppedRetired{ 0 };     // from rings already freed
+    uint64_t droppedReported = 0;
+    std::mutex writeMutex;                         // sink vs. synchronous fallback
+
+    std::mutex sitesMutex;
+    std::vector<const GLwinLogSite*> sites;        // id - 1
+
+    // binary output, only touched under writeMutex
+    GLwinLogFileWriter file;
+    std::vector<bool> fileSites;                   // site ids already in the file
+    bool fileDirty = false;
+    uint64_t fileSyncTicks = 0;
+    std::atomic<int> console{ -1 };                // -1: decided by GLwinLogOpenFile
+};
+
+// Pages of the log file are handed to the OS at least this often (errors go out right away)
+#define GLWIN_LOGFILE_SYNC_MS 1000
+
+// Never destroyed: records may still arrive from static destructors
+static glwin_internal_Logger& glwin_internal_GetLogger()
+{
+    static glwin_internal_Logger* logger = new glwin_internal_Logger;
+    return *logger;
+}
+
+const char* GLwinLogLevelName(int level)
+{
+    switch (level) {
+    case GLWIN_LOG_LEVEL_INIT:    return "INIT";
+    case GLWIN_LOG_LEVEL_ERROR:   return "ERROR";
+    case GLWIN_LOG_LEVEL_WARNING: return "WARN";
+    case GLWIN_LOG_LEVEL_INFO:    return "INFO";
+    case GLWIN_LOG_LEVEL_TRACE:   return "TRACE";
+    default:                      return "DEBUG";
+    }
+}
+
+static void glwin_internal_FormatRecord(int level, const char* text, size_t length, std::string& out)
+{
+    out += GLWIN_LOG_COLOR(level);
+    out += "[GLWIN][";
+    out += GLwinLogLevelName(level);
+    out += "] ";
+    out.append(text, length);
+    out += GLWIN_COLOR_RESET;
+    out += '\n';
+}
+
+// Message text of a record, formatting structured records from their site
+static void glwin_internal_FormatMessage(int level, uint32_t site, const char* payload, size_t length, std::string& out)
+{
+    if (site == 0) {
+        glwin_internal_FormatRecord(level, payload, length, out);
+        return;
+    }
+    const GLwinLogSite* desc = GLwinLogGetSite(site);
+    if (!desc) {
+        std::string unknown = "<unknown log site " + std::to_string(site) + ">";
+        glwin_internal_FormatRecord(level, unknown.data(), unknown.size(), out);
+        return;
+    }
+    std::string message;
+    GLwinLogFormatArgs(desc->format, desc->argTypes, desc->argCount, payload, length, message);
+    glwin_internal_FormatRecord(level, message.data(), message.size(), out);
+}
+
+static void glwin_internal_WriteOut(const std::string& text)
+{
+    if (text.empty()) return;
+    fwrite(text.data(), 1, text.size(), stdout);
+    fflush(stdout);
+}
+
+// Whether records still go to stdout; call with writeMutex held
+static bool glwin_internal_ConsoleEnabled(glwin_internal_Logger& log)
+{
+    int console = log.console.load(std::memory_order_relaxed);
+    if (console >= 0) return console != 0;
+#ifdef _DEBUG
+    return true;
+#else
+    return !log.file.IsOpen();
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Binary file output (all under writeMutex)
+// ----------------------------------------------------------------------------
+
+static void glwin_internal_WriteFileSite(glwin_internal_Logger& log, uint32_t id)
+{
+    if (id < log.fileSites.size() && log.fileSites[id]) return;
+    const GLwinLogSite* desc = GLwinLogGetSite(id);
+    if (!desc) return; // the record shows up as an unknown site
+
+    size_t formatLength = desc->format ? strlen(desc->format) : 0;
+    size_t fileLength = desc->file ? strlen(desc->file) : 0;
+    if (formatLength > UINT16_MAX) formatLength = UINT16_MAX;
+    if (fileLength > UINT16_MAX) fileLength = UINT16_MAX;
+
+    GLwinLogFileSite h = {};
+    h.kind = GLWIN_LOGFILE_SITE;
+    h.level = (uint8_t)desc->level;
+    h.argCount = (uint8_t)desc->argCount;
+    h.id = id;
+    h.line = (uint32_t)desc->line;
+    h.formatLength = (uint16_t)formatLength;
+    h.fileLength = (uint16_t)fileLength;
+    size_t total = sizeof(h) + h.argCount + formatLength + fileLength;
+    unsigned char* p = log.file.Reserve(GLwinLogFileChunkSize(total));
+    if (!p) return;
+    memcpy(p, &h, sizeof(h));
+    p += sizeof(h);
+    memcpy(p, desc->argTypes, h.argCount);
+    p += h.argCount;
+    memcpy(p, desc->format, formatLength);
+    p += formatLength;
+    memcpy(p, desc->file, fileLength);
+
+    if (log.fileSites.size() <= id) log.fileSites.resize(id + 1, false);
+    log.fileSites[id] = true;
+}
+
+static void glwin_internal_WriteFileRecord(glwin_internal_Logger& log, const glwin_internal_LogRecord& r)
+{
+    if (r.site != 0) glwin_internal_WriteFileSite(log, r.site);
+
+    GLwinLogFileRecord h = {};
+    h.kind = GLWIN_LOGFILE_RECORD;
+    h.level = r.level;
+    h.length = r.length;
+    h.thread = r.thread;
+    h.site = r.site;
+    h.ticks = r.ticks;
+    unsigned char* p = log.file.Reserve(GLwinLogFileChunkSize(sizeof(h) + r.length));
+    if (!p) return;
+    memcpy(p, &h, sizeof(h));
+    memcpy(p + sizeof(h), r.text, r.length);
+    log.fileDirty = true;
+}
+
+static void glwin_internal_WriteFileDropped(glwin_internal_Logger& log, uint64_t count)
+{
+    GLwinLogFileDropped d = {};
+    d.kind = GLWIN_LOGFILE_DROPPED;
+    d.ticks = GLwinGetTicks();
+    d.count = count;
+    if (log.file.Append(&d, sizeof(d))) log.fileDirty = true;
+}
+
+// Hand written pages to the OS now and then, so a crash loses as little as possible
+static void glwin_internal_SyncFile(glwin_internal_Logger& log, bool urgent)
+{
+    if (!log.fileDirty) return;
+    uint64_t now = GLwinGetTicks();
+    if (!urgent && now - log.fileSyncTicks < GLwinGetTickFrequency() / 1000 * GLWIN_LOGFILE_SYNC_MS) return;
+    log.file.Sync();
+    log.fileSyncTicks = now;
+    log.fileDirty = false;
+}
+
+// Everything a drained batch turns into: text for the console, chunks for the file
+static void glwin_internal_WriteBatch(glwin_internal_Logger& log, const std::vector<glwin_internal_LogRecord>& batch,
+    uint64_t newlyDropped, std::string& text)
+{
+    bool console = glwin_internal_ConsoleEnabled(log);
+    bool toFile = log.file.IsOpen();
+    bool urgent = false;
+    text.clear();
+    for (const glwin_internal_LogRecord& r : batch) {
+        if (console) glwin_internal_FormatMessage(r.level, r.site, r.text, r.length, text);
+        if (toFile) glwin_internal_WriteFileRecord(log, r);
+        urgent |= r.level <= GLWIN_LOG_LEVEL_ERROR;
+    }
+    if (newlyDropped) {
+        if (console) {
+            std::string note = std::to_string(newlyDropped) + " log records dropped (ring full)";
+            glwin_internal_FormatRecord(GLWIN_LOG_LEVEL_WARNING, note.data(), note.size(), text);
+        }
+        if (toFile) glwin_internal_WriteFileDropped(log, newlyDropped);
+    }
+    if (console) glwin_internal_WriteOut(text);
+    if (toFile) glwin_internal_SyncFile(log, urgent);
+}
+
+// ----------------------------------------------------------------------------
+// Sink thread
+// ----------------------------------------------------------------------------
+
+// Move everything currently queued into batch; returns true if anything was taken
+static bool glwin_internal_Drain(glwin_internal_Logger& log, std::vector<glwin_internal_LogRecord>& batch, uint64_t* dropped)
+{
+    bool any = false;
+    std::lock_guard<std::mutex> lock(log.ringsMutex);
+    *dropped = log.droppedRetired.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < log.rings.size();) {
+        glwin_internal_LogRing* ring = log.rings[i];
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const glwin_internal_LogRecord& r = ring->records[tail & (GLWIN_LOG_RING_SIZE - 1)];
+            batch.push_back(r);
+            any = true;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+        uint64_t ringDropped = ring->dropped.load(std::memory_order_relaxed);
+
+        if (retired && ring->head.load(std::memory_order_acquire) == tail) {
+            log.droppedRetired.fetch_add(ringDropped, std::memory_order_relaxed);
+            *dropped += ringDropped;
+            delete ring;
+            log.rings[i] = log.rings.back();
+            log.rings.pop_back();
+            continue;
+        }
+        *dropped += ringDropped;
+        ++i;
+    }
+    return any;
+}
+
+static void glwin_internal_SinkLoop()
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    std::vector<glwin_internal_LogRecord> batch;
+    std::string text;
+    batch.reserve(GLWIN_LOG_RING_SIZE);
+    text.reserve(GLWIN_LOG_RING_SIZE * 64);
+
+    for (;;) {
+        bool stopping = !log.running.load(std::memory_order_acquire);
+        batch.clear();
+        uint64_t dropped = 0;
+        // held for the whole pass so GLwinLogFlush can't return between drain and write
+        std::unique_lock<std::mutex> writeLock(log.writeMutex);
+        bool any = glwin_internal_Drain(log, batch, &dropped);
+
+        if (any || dropped != log.droppedReported) {
+            // rings are drained one after another, so restore the global order
+            std::stable_sort(batch.begin(), batch.end(),
+                [](const glwin_internal_LogRecord& a, const glwin_internal_LogRecord& b) { return a.ticks < b.ticks; });
+            glwin_internal_WriteBatch(log, batch, dropped - log.droppedReported, text);
+            log.droppedReported = dropped;
+        }
+        else {
+            glwin_internal_SyncFile(log, false);
+        }
+        writeLock.unlock();
+
+        if (stopping && !any) break;
+        if (!any) {
+            std::unique_lock<std::mutex> lock(log.wakeMutex);
+            log.wake.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+}
+
+// Write out whatever is queued from the calling thread (shutdown and late records)
+static void glwin_internal_DrainAndWrite(glwin_internal_Logger& log)
+{
+    std::vector<glwin_internal_LogRecord> rest;
+    uint64_t dropped = 0;
+    std::lock_guard<std::mutex> lock(log.writeMutex);
+    if (glwin_internal_Drain(log, rest, &dropped)) {
+        std::stable_sort(rest.begin(), rest.end(),
+            [](const glwin_internal_LogRecord& a, const glwin_internal_LogRecord& b) { return a.ticks < b.ticks; });
+        std::string text;
+        glwin_internal_WriteBatch(log, rest, 0, text);
+    }
+}
+
+static void glwin_internal_StartSink()
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    std::call_once(log.startOnce, [&log]() {
+        if (log.stopped.load()) return;
+        log.running.store(true, std::memory_order_release);
+        log.sink = std::thread(glwin_internal_SinkLoop);
+        atexit(GLwinLogShutdown);
+    });
+}
+
+// ----------------------------------------------------------------------------
+// Producer side
+// ----------------------------------------------------------------------------
+
+// The calling thread's ring. Trivially destructible, so it stays usable while other
+// thread_locals are destroyed (their destructors may log); see glwin_internal_ThreadRingOwner.
+struct glwin_internal_ThreadRing {
+    glwin_internal_LogRing* ring = nullptr;
+    // between GLwinLogBegin and GLwinLogCommit
+    glwin_internal_LogRecord* open = nullptr;
+    glwin_internal_LogRecord fallback;   // written straight through: after shutdown or thread exit
+    bool exited = false;                 // ring handed back to the sink
+};
+
+static thread_local glwin_internal_ThreadRing t_ring;
+
+// Marks the ring retired on thread exit so the sink can free it; later records from this
+// thread (destructors of other thread_locals) take the synchronous path
+struct glwin_internal_ThreadRingOwner {
+    bool active = false;
+    ~glwin_internal_ThreadRingOwner() {
+        if (t_ring.ring) t_ring.ring->retired.store(true, std::memory_order_release);
+        t_ring.ring = nullptr;
+        t_ring.exited = true;
+    }
+};
+
+static thread_local glwin_internal_ThreadRingOwner t_ringOwner;
+
+static glwin_internal_LogRing* glwin_internal_GetThreadRing()
+{
+    if (!t_ring.ring) {
+        t_ringOwner.active = true; // constructs the owner on this thread
+        glwin_internal_StartSink();
+        glwin_internal_Logger& log = glwin_internal_GetLogger();
+        glwin_internal_LogRing* ring = new glwin_internal_LogRing;
+        std::lock_guard<std::mutex> lock(log.ringsMutex);
+        ring->thread = log.nextThread++;
+        log.rings.push_back(ring);
+        t_ring.ring = ring;
+    }
+    return t_ring.ring;
+}
+
+char* GLwinLogBegin(int level, uint32_t site, size_t* capacity)
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    glwin_internal_LogRecord* r;
+    if (t_ring.exited || (!log.running.load(std::memory_order_acquire) && log.stopped.load(std::memory_order_acquire))) {
+        // after shutdown or thread exit: GLwinLogCommit writes straight through
+        r = &t_ring.fallback;
+        r->thread = 0;
+    }
+    else {
+        glwin_internal_LogRing* ring = glwin_internal_GetThreadRing();
+        uint32_t head = ring->head.load(std::memory_order_relaxed);
+        uint32_t tail = ring->tail.load(std::memory_order_acquire);
+        if (head - tail >= GLWIN_LOG_RING_SIZE) {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        r = &ring->records[head & (GLWIN_LOG_RING_SIZE - 1)];
+        r->thread = ring->thread;
+    }
+    r->ticks = GLwinGetTicks();
+    r->site = site;
+    r->level = (uint8_t)level;
+    t_ring.open = r;
+    if (capacity) *capacity = sizeof(r->text);
+    return r->text;
+}
+
+void GLwinLogCommit(size_t length)
+{
+    glwin_internal_LogRecord* r = t_ring.open;
+    if (!r) return;
+    t_ring.open = nullptr;
+    r->length = (uint16_t)(length > sizeof(r->text) ? sizeof(r->text) : length);
+
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    if (r == &t_ring.fallback) {
+        std::vector<glwin_internal_LogRecord> one(1, *r);
+        std::string text;
+        std::lock_guard<std::mutex> lock(log.writeMutex);
+        glwin_internal_WriteBatch(log, one, 0, text);
+        return;
+    }
+    glwin_internal_LogRing* ring = t_ring.ring;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    // Shutdown may have taken its last look at the rings between GLwinLogBegin and here
+    // (it sets stopped, then drains; the fences make sure one of the two sees the other)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (log.stopped.load(std::memory_order_relaxed)) {
+        glwin_internal_DrainAndWrite(log);
+        return;
+    }
+
+    // errors shouldn't sit in the ring if the process is about to go down
+    if (r->level <= GLWIN_LOG_LEVEL_ERROR) log.wake.notify_one();
+}
+
+// Cut so a UTF-8 sequence isn't split between two records
+static size_t glwin_internal_Utf8Cut(const char* text, size_t length, size_t limit)
+{
+    if (length <= limit) return length;
+    size_t cut = limit;
+    while (cut > 0 && ((unsigned char)text[cut] & 0xC0) == 0x80) --cut;
+    return cut ? cut : limit;
+}
+
+void GLwinLogWrite(int level, const char* text, size_t length)
+{
+    if (!text) return;
+    static const char continued[] = "...";
+    static const char truncated[] = "...[truncated]";
+    uint64_t ticks = 0;
+    for (int part = 0; part < GLWIN_LOG_MAX_PARTS; ++part) {
+        size_t capacity;
+        char* payload = GLwinLogBegin(level, 0, &capacity);
+        if (!payload) return;
+        size_t used = 0;
+        if (part == 0) {
+            ticks = t_ring.open->ticks;
+        }
+        else {
+            // same time as the first part, so the sink's sort keeps the parts together
+            t_ring.open->ticks = ticks;
+            memcpy(payload, continued, sizeof(continued) - 1);
+            used = sizeof(continued) - 1;
+        }
+        size_t room = capacity - used;
+        bool last = length <= room;
+        if (!last && part == GLWIN_LOG_MAX_PARTS - 1) room -= sizeof(truncated) - 1;
+        size_t n = glwin_internal_Utf8Cut(text, length, room);
+        memcpy(payload + used, text, n);
+        used += n;
+        text += n;
+        length -= n;
+        if (!last && part == GLWIN_LOG_MAX_PARTS - 1) {
+            memcpy(payload + used, truncated, sizeof(truncated) - 1);
+            used += sizeof(truncated) - 1;
+        }
+        GLwinLogCommit(used);
+        if (length == 0) return;
+    }
+}
+
+void GLwinLogSetLevel(int level)
+{
+    g_GLwinLogLevel.store(level, std::memory_order_relaxed);
+}
+
+void GLwinLogFlush()
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    if (!log.running.load(std::memory_order_acquire)) return;
+    for (;;) {
+        bool empty = true;
+        {
+            std::lock_guard<std::mutex> lock(log.ringsMutex);
+            for (glwin_internal_LogRing* ring : log.rings) {
+                if (ring->head.load(std::memory_order_acquire) != ring->tail.load(std::memory_order_acquire)) {
+                    empty = false;
+                    break;
+                }
+            }
+        }
+        if (empty) break;
+        log.wake.notify_one();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // the sink holds this from drain to write, so the last batch is out once we get it
+    std::lock_guard<std::mutex> lock(log.writeMutex);
+    glwin_internal_SyncFile(log, true);
+}
+
+void GLwinLogShutdown()
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    log.stopped.store(true, std::memory_order_release);
+    // pairs with the fence in GLwinLogCommit: a record this drain misses drains itself
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!log.running.exchange(false, std::memory_order_acq_rel)) return;
+    log.wake.notify_one();
+    if (log.sink.joinable()) log.sink.join();
+
+    // anything that slipped in while the sink was stopping
+    glwin_internal_DrainAndWrite(log);
+    // records after this point are written synchronously, to the console only
+    std::lock_guard<std::mutex> lock(log.writeMutex);
+    log.file.Close();
+}
+
+int GLwinLogOpenFile(const char* path)
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    if (log.stopped.load(std::memory_order_acquire)) return 0;
+    glwin_internal_StartSink();
+    {
+        std::lock_guard<std::mutex> lock(log.writeMutex);
+        log.file.Close();
+        log.fileSites.clear();
+        log.fileDirty = false;
+        if (log.file.Open(path)) {
+            GLwinLogFileHeader header = {};
+            memcpy(header.magic, "GLWL", 4);
+            header.version = GLWIN_LOGFILE_VERSION;
+            header.headerSize = (uint32_t)GLwinLogFileChunkSize(sizeof(header));
+            header.tickFrequency = GLwinGetTickFrequency();
+            header.startTicks = GLwinGetTicks();
+            header.startTime = (int64_t)time(nullptr);
+            unsigned char* p = log.file.Reserve(header.headerSize);
+            if (p) {
+                memcpy(p, &header, sizeof(header));
+                log.fileSyncTicks = header.startTicks;
+                return 1;
+            }
+            log.file.Close();
+        }
+    }
+    // logged outside the lock: the sink needs it to write this out
+    GLWIN_LOG_ERROR("Could not open log file " << (path ? path : "(null)"));
+    return 0;
+}
+
+void GLwinLogCloseFile()
+{
+    GLwinLogFlush();
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    std::lock_guard<std::mutex> lock(log.writeMutex);
+    log.file.Close();
+    log.fileSites.clear();
+    log.fileDirty = false;
+}
+
+void GLwinLogSetConsole(int enabled)
+{
+    glwin_internal_GetLogger().console.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
+
+uint64_t GLwinLogGetDroppedCount()
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    std::lock_guard<std::mutex> lock(log.ringsMutex);
+    uint64_t total = log.droppedRetired.load(std::memory_order_relaxed);
+    for (glwin_internal_LogRing* ring : log.rings) total += ring->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+// ----------------------------------------------------------------------------
+// Structured call sites
+// ----------------------------------------------------------------------------
+
+uint32_t GLwinLogRegisterSite(const GLwinLogSite* site)
+{
+    if (!site) return 0;
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    std::lock_guard<std::mutex> lock(log.sitesMutex);
+    log.sites.push_back(site);
+    return (uint32_t)log.sites.size();
+}
+
+const GLwinLogSite* GLwinLogGetSite(uint32_t id)
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    std::lock_guard<std::mutex> lock(log.sitesMutex);
+    return (id >= 1 && id <= log.sites.size()) ? log.sites[id - 1] : nullptr;
+}
+
+uint32_t GLwinLogGetSiteCount()
+{
+    glwin_internal_Logger& log = glwin_internal_GetLogger();
+    std::lock_guard<std::mutex> lock(log.sitesMutex);
+    return (uint32_t)log.sites.size();
+}
+
+template<typename T>
+static bool glwin_internal_Take(const unsigned char*& p, const unsigned char* end, T* out)
+{
+    if ((size_t)(end - p) < sizeof(T)) return false;
+    memcpy(out, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+// Append one decoded argument; false once the payload runs out
+static bool glwin_internal_FormatArg(uint8_t type, const unsigned char*& p, const unsigned char* end, std::string& out)
+{
+    char buf[32];
+    switch (type) {
+    case GLWIN_LOG_ARG_I32: { int32_t v; if (!glwin_internal_Take(p, end, &v)) return false; out += std::to_string(v); return true; }
+    case GLWIN_LOG_ARG_U32: { uint32_t v; if (!glwin_internal_Take(p, end, &v)) return false; out += std::to_string(v); return true; }
+    case GLWIN_LOG_ARG_I64: { int64_t v; if (!glwin_internal_Take(p, end, &v)) return false; out += std::to_string(v); return true; }
+    case GLWIN_LOG_ARG_U64: { uint64_t v; if (!glwin_internal_Take(p, end, &v)) return false; out += std::to_string(v); return true; }
+    case GLWIN_LOG_ARG_F64: {
+        double v;
+        if (!glwin_internal_Take(p, end, &v)) return false;
+        snprintf(buf, sizeof(buf), "%g", v); // what operator<< prints by default
+        out += buf;
+        return true;
+    }
+    case GLWIN_LOG_ARG_BOOL: { char v; if (!glwin_internal_Take(p, end, &v)) return false; out += v ? "true" : "false"; return true; }
+    case GLWIN_LOG_ARG_CHAR: { char v; if (!glwin_internal_Take(p, end, &v)) return false; out += v; return true; }
+    case GLWIN_LOG_ARG_POINTER: {
+        uint64_t v;
+        if (!glwin_internal_Take(p, end, &v)) return false;
+        snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long)v);
+        out += buf;
+        return true;
+    }
+    case GLWIN_LOG_ARG_STRING: {
+        uint16_t n;
+        if (!glwin_internal_Take(p, end, &n)) return false;
+        size_t avail = (size_t)(end - p);
+        size_t take = n < avail ? n : avail;
+        out.append((const char*)p, take);
+        p += take;
+        return take == n;
+    }
+    default:
+        return false;
+    }
+}
+
+void GLwinLogFormatArgs(const char* format, const uint8_t* argTypes, int argCount,
+    const void* payload, size_t length, std::string& out)
+{
+    const unsigned char* p = (const unsigned char*)payload;
+    const unsigned char* end = p + length;
+    int arg = 0;
+    bool more = true;
+    for (const char* f = format ? format : ""; *f; ++f) {
+        if ((f[0] == '{' && f[1] == '{') || (f[0] == '}' && f[1] == '}')) {
+            out += *f++;
+        }
+        else if (f[0] == '{' && f[1] == '}') {
+            ++f;
+            if (arg < argCount && more) more = glwin_internal_FormatArg(argTypes[arg], p, end, out);
+            if (arg >= argCount || !more) out += "{?}";
+            ++arg;
+        }
+        else {
+            out += *f;
+        }
+    }
+}
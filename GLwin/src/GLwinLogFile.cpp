@@ -0,0 +1,290 @@
+#include "../GLwinLogFile.h"
+#include "../GLwinLog.h"
+#include <string.h>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char GLWIN_LOGFILE_MAGIC[4] = { 'G', 'L', 'W', 'L' };
+
+// ----------------------------------------------------------------------------
+// Writer
+// ----------------------------------------------------------------------------
+// Nothing in here logs: it runs on the sink thread, under the sink's lock.
+
+#ifdef _WIN32
+
+bool GLwinLogFileWriter::Open(const char* path, size_t initialSize)
+{
+    Close();
+    if (!path) return false;
+    int wlen = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+    if (wlen <= 0) return false;
+    std::wstring wpath((size_t)wlen, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path, -1, &wpath[0], wlen);
+
+    HANDLE h = CreateFileW(wpath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    file = h;
+    size = 0;
+    if (!Map(initialSize ? initialSize : 4096)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool GLwinLogFileWriter::Map(size_t newCapacity)
+{
+    Unmap();
+    LARGE_INTEGER length;
+    length.QuadPart = (LONGLONG)newCapacity;
+    // a mapping larger than the file extends it with zeros
+    mapping = CreateFileMappingW((HANDLE)file, NULL, PAGE_READWRITE, length.HighPart, length.LowPart, NULL);
+    if (!mapping) return false;
+    view = (unsigned char*)MapViewOfFile((HANDLE)mapping, FILE_MAP_WRITE, 0, 0, newCapacity);
+    if (!view) {
+        CloseHandle((HANDLE)mapping);
+        mapping = nullptr;
+        return false;
+    }
+    capacity = newCapacity;
+    return true;
+}
+
+void GLwinLogFileWriter::Unmap()
+{
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle((HANDLE)mapping);
+    view = nullptr;
+    mapping = nullptr;
+}
+
+void GLwinLogFileWriter::Sync(bool wait)
+{
+    if (!view) return;
+    FlushViewOfFile(view, size);
+    if (wait) FlushFileBuffers((HANDLE)file);
+}
+
+void GLwinLogFileWriter::Close()
+{
+    if (!file) return;
+    Sync(true);
+    Unmap();
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)size;
+    if (SetFilePointerEx((HANDLE)file, end, NULL, FILE_BEGIN)) SetEndOfFile((HANDLE)file);
+    CloseHandle((HANDLE)file);
+    file = nullptr;
+    size = capacity = 0;
+}
+
+#else
+
+bool GLwinLogFileWriter::Open(const char* path, size_t initialSize)
+{
+    Close();
+    if (!path) return false;
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    size = 0;
+    if (!Map(initialSize ? initialSize : 4096)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool GLwinLogFileWriter::Map(size_t newCapacity)
+{
+    Unmap();
+    if (ftruncate(fd, (off_t)newCapacity) != 0) return false;
+    void* p = mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return false;
+    view = (unsigned char*)p;
+    capacity = newCapacity;
+    return true;
+}
+
+void GLwinLogFileWriter::Unmap()
+{
+    if (view) munmap(view, capacity);
+    view = nullptr;
+}
+
+void GLwinLogFileWriter::Sync(bool wait)
+{
+    if (!view || size == 0) return;
+    msync(view, size, wait ? MS_SYNC : MS_ASYNC);
+}
+
+void GLwinLogFileWriter::Close()
+{
+    if (fd < 0) return;
+    Sync(true);
+    Unmap();
+    if (ftruncate(fd, (off_t)size) != 0) {
+        // the zero tail reads as the end of the log, so the file is still valid
+    }
+    ::close(fd);
+    fd = -1;
+    size = capacity = 0;
+}
+
+#endif
+
+unsigned char* GLwinLogFileWriter::Reserve(size_t bytes)
+{
+    if (!view) return nullptr;
+    if (size + bytes > capacity) {
+        size_t newCapacity = capacity * 2;
+        while (newCapacity < size + bytes) newCapacity *= 2;
+        if (!Map(newCapacity)) return nullptr;
+    }
+    // fresh file pages are zero, but a chunk may be reserved again after a failed write
+    unsigned char* p = view + size;
+    memset(p, 0, bytes);
+    size += bytes;
+    return p;
+}
+
+bool GLwinLogFileWriter::Append(const void* data, size_t bytes)
+{
+    unsigned char* p = Reserve(bytes);
+    if (!p) return false;
+    memcpy(p, data, bytes);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Reader
+// ----------------------------------------------------------------------------
+
+bool GLwinLogFileReader::Open(const void* bytes, size_t length)
+{
+    data = static_cast<const unsigned char*>(bytes);
+    size = length;
+    offset = 0;
+    damaged = false;
+    sites.clear();
+    if (!data || size < sizeof(GLwinLogFileHeader)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, GLWIN_LOGFILE_MAGIC, 4) != 0 || header.version != GLWIN_LOGFILE_VERSION) return false;
+    if (header.headerSize < sizeof(GLwinLogFileHeader) || header.headerSize > size) return false;
+    offset = header.headerSize;
+    return true;
+}
+
+bool GLwinLogFileReader::Next(GLwinLogFileEntry* out)
+{
+    while (data && offset < size) {
+        const unsigned char* p = data + offset;
+        size_t left = size - offset;
+        switch (p[0]) {
+        case GLWIN_LOGFILE_END:
+            return false;
+
+        case GLWIN_LOGFILE_SITE: {
+            GLwinLogFileSite s;
+            if (left < sizeof(s)) break;
+            memcpy(&s, p, sizeof(s));
+            size_t total = sizeof(s) + s.argCount + s.formatLength + s.fileLength;
+            if (left < total || s.id == 0 || s.argCount > GLWIN_LOG_MAX_ARGS) break;
+            if (sites.size() < s.id) sites.resize(s.id);
+            GLwinLogFileSiteInfo& info = sites[s.id - 1];
+            const char* q = (const char*)p + sizeof(s);
+            info.id = s.id;
+            info.line = (int)s.line;
+            info.level = s.level;
+            info.argTypes.assign(q, q + s.argCount);
+            q += s.argCount;
+            info.format.assign(q, s.formatLength);
+            q += s.formatLength;
+            info.file.assign(q, s.fileLength);
+            offset += GLwinLogFileChunkSize(total);
+            continue;
+        }
+
+        case GLWIN_LOGFILE_RECORD: {
+            GLwinLogFileRecord r;
+            if (left < sizeof(r)) break;
+            memcpy(&r, p, sizeof(r));
+            size_t total = sizeof(r) + r.length;
+            if (left < total) break;
+            out->kind = GLWIN_LOGFILE_RECORD;
+            out->ticks = r.ticks;
+            out->thread = r.thread;
+            out->level = r.level;
+            out->siteId = r.site;
+            out->site = GetSite(r.site);
+            out->payload = (const char*)p + sizeof(r);
+            out->length = r.length;
+            out->dropped = 0;
+            offset += GLwinLogFileChunkSize(total);
+            return true;
+        }
+
+        case GLWIN_LOGFILE_DROPPED: {
+            GLwinLogFileDropped d;
+            if (left < sizeof(d)) break;
+            memcpy(&d, p, sizeof(d));
+            out->kind = GLWIN_LOGFILE_DROPPED;
+            out->ticks = d.ticks;
+            out->thread = 0;
+            out->level = GLWIN_LOG_LEVEL_WARNING;
+            out->siteId = 0;
+            out->site = nullptr;
+            out->payload = nullptr;
+            out->length = 0;
+            out->dropped = d.count;
+            offset += GLwinLogFileChunkSize(sizeof(d));
+            return true;
+        }
+
+        default:
+            break;
+        }
+        // cut short or not a chunk we know: nothing after it can be trusted
+        damaged = true;
+        offset = size;
+    }
+    return false;
+}
+
+const GLwinLogFileSiteInfo* GLwinLogFileReader::GetSite(uint32_t id) const
+{
+    if (id == 0 || id > sites.size() || sites[id - 1].id == 0) return nullptr;
+    return &sites[id - 1];
+}
+
+double GLwinLogFileReader::GetSeconds(uint64_t ticks) const
+{
+    if (header.tickFrequency == 0) return 0.0;
+    int64_t delta = (int64_t)(ticks - header.startTicks);
+    return (double)delta / (double)header.tickFrequency;
+}
+
+void GLwinLogFileReader::FormatText(const GLwinLogFileEntry& entry, std::string& out) const
+{
+    if (entry.kind == GLWIN_LOGFILE_DROPPED) {
+        out += std::to_string(entry.dropped) + " log records dropped (ring full)";
+        return;
+    }
+    if (entry.siteId == 0) {
+        out.append(entry.payload, entry.length);
+        return;
+    }
+    if (!entry.site) {
+        out += "<unknown log site " + std::to_string(entry.siteId) + ">";
+        return;
+    }
+    GLwinLogFormatArgs(entry.site->format.c_str(), entry.site->argTypes.data(), (int)entry.site->argTypes.size(),
+        entry.payload, entry.length, out);
+}
@@ -0,0 +1,224 @@
+#include "../GLwinProfile.h"
+#include "../GLwinLog.h"
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> g_GLwinProfileEnabled{ false };
+
+static_assert((GLWIN_PROFILE_RING_SIZE & (GLWIN_PROFILE_RING_SIZE - 1)) == 0, "GLWIN_PROFILE_RING_SIZE must be a power of two");
+
+// Written by its owning thread only; readers take zones below count
+struct glwin_internal_ProfileRing {
+    std::atomic<uint64_t> count{ 0 };      // zones ever recorded on this ring
+    std::atomic<bool> retired{ false };    // owning thread has exited
+    uint64_t statsCursor = 0;              // first zone GLwinProfileFrameMark hasn't summed
+    uint32_t thread = 0;
+    bool gpu = false;                      // fed by GLwinProfileRecordGpu, not owned by a thread
+    std::string name;                      // under the profiler mutex
+    GLwinProfileZone zones[GLWIN_PROFILE_RING_SIZE];
+};
+
+struct glwin_internal_Profiler {
+    std::mutex mutex;
+    std::vector<glwin_internal_ProfileRing*> rings;
+    glwin_internal_ProfileRing* gpuRing = nullptr;
+    uint32_t nextThread = 1;
+    std::atomic<uint64_t> captureStart{ 0 };
+
+    GLwinProfileZoneStats frame[GLWIN_PROFILE_MAX_FRAME_ZONES];
+    int frameCount = 0;
+};
+
+// Never destroyed: zones may still close during static destruction
+static glwin_internal_Profiler& glwin_internal_GetProfiler()
+{
+    static glwin_internal_Profiler* profiler = new glwin_internal_Profiler;
+    return *profiler;
+}
+
+// The ring (~1.5 MB) only exists once the thread has recorded a zone with profiling on;
+// a name set before that waits here
+struct glwin_internal_ThreadProfile {
+    glwin_internal_ProfileRing* ring = nullptr;
+    char name[64] = {};
+    ~glwin_internal_ThreadProfile() {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+static thread_local glwin_internal_ThreadProfile t_profile;
+
+static glwin_internal_ProfileRing* glwin_internal_GetProfileRing()
+{
+    if (!t_profile.ring) {
+        glwin_internal_Profiler& prof = glwin_internal_GetProfiler();
+        glwin_internal_ProfileRing* ring = new glwin_internal_ProfileRing;
+        std::lock_guard<std::mutex> lock(prof.mutex);
+        ring->thread = prof.nextThread++;
+        ring->name = t_profile.name[0] ? std::string(t_profile.name) : "Thread " + std::to_string(ring->thread);
+        prof.rings.push_back(ring);
+        t_profile.ring = ring;
+    }
+    return t_profile.ring;
+}
+
+// Oldest zone still in the ring
+static uint64_t glwin_internal_RingFirst(uint64_t count)
+{
+    return count > GLWIN_PROFILE_RING_SIZE ? count - GLWIN_PROFILE_RING_SIZE : 0;
+}
+
+void GLwinProfileEnable(bool enabled)
+{
+    glwin_internal_Profiler& prof = glwin_internal_GetProfiler();
+    if (enabled && !g_GLwinProfileEnabled.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(prof.mutex);
+        // rings of threads that are gone only held the previous capture
+        for (size_t i = 0; i < prof.rings.size();) {
+            if (prof.rings[i]->retired.load(std::memory_order_acquire)) {
+                delete prof.rings[i];
+                prof.rings[i] = prof.rings.back();
+                prof.rings.pop_back();
+                continue;
+            }
+            prof.rings[i]->statsCursor = prof.rings[i]->count.load(std::memory_order_acquire);
+            ++i;
+        }
+        prof.captureStart.store(GLwinGetTicks(), std::memory_order_relaxed);
+        prof.frameCount = 0;
+    }
+    g_GLwinProfileEnabled.store(enabled, std::memory_order_release);
+}
+
+static void glwin_internal_PushZone(glwin_internal_ProfileRing* ring, const char* name, uint64_t begin, uint64_t end)
+{
+    uint64_t n = ring->count.load(std::memory_order_relaxed);
+    GLwinProfileZone& z = ring->zones[n & (GLWIN_PROFILE_RING_SIZE - 1)];
+    z.name = name;
+    z.begin = begin;
+    z.end = end;
+    ring->count.store(n + 1, std::memory_order_release);
+}
+
+void GLwinProfileRecord(const char* name, uint64_t begin, uint64_t end)
+{
+    glwin_internal_PushZone(glwin_internal_GetProfileRing(), name, begin, end);
+}
+
+void GLwinProfileRecordGpu(const char* name, uint64_t begin, uint64_t end)
+{
+    glwin_internal_Profiler& prof = glwin_internal_GetProfiler();
+    if (!prof.gpuRing) {
+        glwin_internal_ProfileRing* ring = new glwin_internal_ProfileRing;
+        std::lock_guard<std::mutex> lock(prof.mutex);
+        ring->thread = prof.nextThread++;
+        ring->name = "GPU";
+        ring->gpu = true;
+        prof.rings.push_back(ring);
+        prof.gpuRing = ring;
+    }
+    glwin_internal_PushZone(prof.gpuRing, name, begin, end);
+}
+
+void GLwinProfileSetThreadName(const char* name)
+{
+    if (!name) return;
+    if (!t_profile.ring) {
+        // picked up when the first zone creates the ring
+        snprintf(t_profile.name, sizeof(t_profile.name), "%s", name);
+        return;
+    }
+    glwin_internal_Profiler& prof = glwin_internal_GetProfiler();
+    std::lock_guard<std::mutex> lock(prof.mutex);
+    t_profile.ring->name = name;
+}
+
+void GLwinProfileFrameMark()
+{
+    if (!GLwinProfileIsEnabled()) return;
+    glwin_internal_Profiler& prof = glwin_internal_GetProfiler();
+    std::lock_guard<std::mutex> lock(prof.mutex);
+    double toMs = 1000.0 / (double)GLwinGetTickFrequency();
+    prof.frameCount = 0;
+    for (glwin_internal_ProfileRing* ring : prof.rings) {
+        uint64_t count = ring->count.load(std::memory_order_acquire);
+        uint64_t first = glwin_internal_RingFirst(count);
+        for (uint64_t i = ring->statsCursor > first ? ring->statsCursor : first; i < count; ++i) {
+            const GLwinProfileZone& z = ring->zones[i & (GLWIN_PROFILE_RING_SIZE - 1)];
+            int slot = 0;
+            // literals with the same text aren't always merged across translation units
+            while (slot < prof.frameCount && (prof.frame[slot].gpu != (int)ring->gpu ||
+                (prof.frame[slot].name != z.name && strcmp(prof.frame[slot].name, z.name) != 0))) ++slot;
+            if (slot == prof.frameCount) {
+                if (slot == GLWIN_PROFILE_MAX_FRAME_ZONES) continue;
+                prof.frame[slot] = { z.name, 0, 0.0, (int)ring->gpu };
+                ++prof.frameCount;
+            }
+            prof.frame[slot].calls++;
+            prof.frame[slot].milliseconds += (double)(z.end - z.begin) * toMs;
+        }
+        ring->statsCursor = count;
+    }
+}
+
+int GLwinProfileGetFrameStats(const GLwinProfileZoneStats** stats)
+{
+    glwin_internal_Profiler& prof = glwin_internal_GetProfiler();
+    if (stats) *stats = prof.frame;
+    return prof.frameCount;
+}
+
+static void glwin_internal_WriteJsonString(FILE* f, const char* s)
+{
+    fputc('"', f);
+    for (; s && *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+int GLwinProfileWriteTrace(const char* path)
+{
+    if (!path) return 0;
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        GLWIN_LOG_ERROR("Could not write profile trace " << path);
+        return 0;
+    }
+    glwin_internal_Profiler& prof = glwin_internal_GetProfiler();
+    std::lock_guard<std::mutex> lock(prof.mutex);
+    uint64_t start = prof.captureStart.load(std::memory_order_relaxed);
+    double toUs = 1000000.0 / (double)GLwinGetTickFrequency();
+    size_t zones = 0;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GLwin\"}}", f);
+    for (glwin_internal_ProfileRing* ring : prof.rings) {
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", ring->thread);
+        glwin_internal_WriteJsonString(f, ring->name.c_str());
+        fputs("}}", f);
+
+        uint64_t count = ring->count.load(std::memory_order_acquire);
+        for (uint64_t i = glwin_internal_RingFirst(count); i < count; ++i) {
+            const GLwinProfileZone& z = ring->zones[i & (GLWIN_PROFILE_RING_SIZE - 1)];
+            if (z.begin < start) continue;
+            fputs(",\n{\"name\":", f);
+            glwin_internal_WriteJsonString(f, z.name);
+            fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                ring->thread, (double)(z.begin - start) * toUs, (double)(z.end - z.begin) * toUs);
+            ++zones;
+        }
+    }
+    fputs("\n]}\n", f);
+    bool ok = ferror(f) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) GLWIN_LOG_ERROR("Could not write profile trace " << path);
+    else GLWIN_LOG_INFO("Wrote " << zones << " profile zones to " << path);
+    return ok ? 1 : 0;
+}
@@ -0,0 +1,391 @@
+#include "../GLwinResource.h"
+#include "../GLwinLog.h"
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char GLWIN_PACK_MAGIC[4] = { 'G', 'L', 'P', 'K' };
+static const uint32_t GLWIN_PACK_VERSION = 1;
+static const uint64_t GLWIN_PACK_ALIGN = 16;
+
+#pragma pack(push, 1)
+struct GLwinPackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t indexOffset;   // GLwinPackEntry[count], sorted by nameHash
+    uint64_t namesOffset;   // concatenated names, not NUL terminated in the file
+};
+struct GLwinPackEntry {
+    uint64_t nameHash;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t contentHash;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+#pragma pack(pop)
+
+struct GLWIN_pack {
+    GLwinFileView file;
+    const GLwinPackEntry* entries;
+    uint32_t count;
+    std::vector<std::string> names; // NUL terminated copies for GLwinPackGetName
+};
+
+static GLWIN_pack* g_GLwinMountedPack = nullptr;
+
+uint64_t GLwinHash64(const void* data, size_t size)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// ----------------------------------------------------------------------------
+// File mapping
+// ----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+struct glwin_internal_Mapping {
+    HANDLE file;
+    HANDLE mapping;
+};
+
+int GLwinMapFile(const char* path, GLwinFileView* out)
+{
+    if (!path || !out) return 0;
+    out->data = nullptr;
+    out->size = 0;
+    out->handle = nullptr;
+
+    int wlen = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+    if (wlen <= 0) return 0;
+    std::wstring wpath((size_t)wlen, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path, -1, &wpath[0], wlen);
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return 0;
+    }
+    glwin_internal_Mapping* m = new glwin_internal_Mapping{ file, NULL };
+    out->handle = m;
+    if (size.QuadPart == 0) return 1; // nothing to map
+
+    m->mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = m->mapping ? MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        GLWIN_LOG_WARNING("Could not map " << path << " (error " << GetLastError() << ")");
+        GLwinUnmapFile(out);
+        return 0;
+    }
+    out->data = static_cast<const unsigned char*>(view);
+    out->size = (size_t)size.QuadPart;
+    return 1;
+}
+
+void GLwinUnmapFile(GLwinFileView* view)
+{
+    if (!view || !view->handle) return;
+    glwin_internal_Mapping* m = static_cast<glwin_internal_Mapping*>(view->handle);
+    if (view->data) UnmapViewOfFile(view->data);
+    if (m->mapping) CloseHandle(m->mapping);
+    if (m->file != INVALID_HANDLE_VALUE) CloseHandle(m->file);
+    delete m;
+    view->data = nullptr;
+    view->size = 0;
+    view->handle = nullptr;
+}
+
+#else
+
+int GLwinMapFile(const char* path, GLwinFileView* out)
+{
+    if (!path || !out) return 0;
+    out->data = nullptr;
+    out->size = 0;
+    out->handle = nullptr;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    // the handle only has to be non-NULL; the mapping outlives the descriptor
+    out->handle = reinterpret_cast<void*>(1);
+    if (st.st_size > 0) {
+        void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            close(fd);
+            out->handle = nullptr;
+            return 0;
+        }
+        out->data = static_cast<const unsigned char*>(view);
+        out->size = (size_t)st.st_size;
+    }
+    close(fd);
+    return 1;
+}
+
+void GLwinUnmapFile(GLwinFileView* view)
+{
+    if (!view || !view->handle) return;
+    if (view->data) munmap(const_cast<unsigned char*>(view->data), view->size);
+    view->data = nullptr;
+    view->size = 0;
+    view->handle = nullptr;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Pack archive
+// ----------------------------------------------------------------------------
+
+GLWIN_pack* GLwinOpenPack(const char* path)
+{
+    GLwinFileView file;
+    if (!GLwinMapFile(path, &file)) return nullptr;
+
+    const GLwinPackHeader* header = reinterpret_cast<const GLwinPackHeader*>(file.data);
+    bool valid = file.size >= sizeof(GLwinPackHeader) &&
+        memcmp(header->magic, GLWIN_PACK_MAGIC, 4) == 0 && header->version == GLWIN_PACK_VERSION &&
+        header->indexOffset <= file.size &&
+        (uint64_t)header->count * sizeof(GLwinPackEntry) <= file.size - header->indexOffset &&
+        header->namesOffset <= file.size;
+    const GLwinPackEntry* entries = valid ? reinterpret_cast<const GLwinPackEntry*>(file.data + header->indexOffset) : nullptr;
+    for (uint32_t i = 0; valid && i < header->count; ++i) {
+        const GLwinPackEntry& e = entries[i];
+        valid = e.offset <= file.size && e.size <= file.size - e.offset &&
+            (uint64_t)e.nameOffset + e.nameLength <= file.size - header->namesOffset;
+    }
+    if (!valid) {
+        GLWIN_LOG_ERROR("Not a valid GLwin pack: " << path);
+        GLwinUnmapFile(&file);
+        return nullptr;
+    }
+
+    GLWIN_pack* pack = new GLWIN_pack;
+    pack->file = file;
+    pack->entries = entries;
+    pack->count = header->count;
+    pack->names.reserve(header->count);
+    const char* names = reinterpret_cast<const char*>(file.data + header->namesOffset);
+    for (uint32_t i = 0; i < header->count; ++i)
+        pack->names.emplace_back(names + entries[i].nameOffset, entries[i].nameLength);
+    return pack;
+}
+
+void GLwinClosePack(GLWIN_pack* pack)
+{
+    if (!pack) return;
+    if (pack == g_GLwinMountedPack) g_GLwinMountedPack = nullptr;
+    GLwinUnmapFile(&pack->file);
+    delete pack;
+}
+
+static const GLwinPackEntry* glwin_internal_PackLookup(GLWIN_pack* pack, const char* name, int* outIndex)
+{
+    if (!pack || !name) return nullptr;
+    size_t len = strlen(name);
+    uint64_t hash = GLwinHash64(name, len);
+    const GLwinPackEntry* begin = pack->entries;
+    const GLwinPackEntry* end = pack->entries + pack->count;
+    const GLwinPackEntry* it = std::lower_bound(begin, end, hash,
+        [](const GLwinPackEntry& e, uint64_t h) { return e.nameHash < h; });
+    for (; it != end && it->nameHash == hash; ++it) {
+        int index = (int)(it - begin);
+        if (pack->names[index].size() == len && memcmp(pack->names[index].data(), name, len) == 0) {
+            if (outIndex) *outIndex = index;
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+int GLwinPackFind(GLWIN_pack* pack, const char* name, GLwinFileView* out)
+{
+    const GLwinPackEntry* e = glwin_internal_PackLookup(pack, name, nullptr);
+    if (!e || !out) return 0;
+    out->data = e->size ? pack->file.data + e->offset : nullptr;
+    out->size = (size_t)e->size;
+    out->handle = nullptr; // owned by the pack
+    return 1;
+}
+
+int GLwinPackVerify(GLWIN_pack* pack, const char* name)
+{
+    const GLwinPackEntry* e = glwin_internal_PackLookup(pack, name, nullptr);
+    if (!e) return 0;
+    return GLwinHash64(pack->file.data + e->offset, (size_t)e->size) == e->contentHash ? 1 : 0;
+}
+
+int GLwinPackGetCount(GLWIN_pack* pack)
+{
+    return pack ? (int)pack->count : 0;
+}
+
+const char* GLwinPackGetName(GLWIN_pack* pack, int index)
+{
+    if (!pack || index < 0 || index >= (int)pack->count) return nullptr;
+    return pack->names[index].c_str();
+}
+
+// Paths in this API are UTF-8; std::filesystem would read a plain char string as ANSI on Windows
+static std::filesystem::path glwin_internal_Utf8Path(const char* path)
+{
+    return std::filesystem::path(reinterpret_cast<const char8_t*>(path));
+}
+
+static bool glwin_internal_WritePackTo(std::ofstream& out, const char* const* names, const char* const* files, int count)
+{
+    GLwinPackHeader header = {};
+    memcpy(header.magic, GLWIN_PACK_MAGIC, 4);
+    header.version = GLWIN_PACK_VERSION;
+    header.count = (uint32_t)count;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Contents, each copied straight from its mapping
+    std::vector<GLwinPackEntry> entries((size_t)count);
+    std::string nameBlob;
+    uint64_t offset = sizeof(header);
+    static const char zeros[GLWIN_PACK_ALIGN] = {};
+    for (int i = 0; i < count; ++i) {
+        GLwinFileView view;
+        if (!GLwinMapFile(files[i], &view)) {
+            GLWIN_LOG_ERROR("GLwinWritePack: cannot read " << files[i]);
+            return false;
+        }
+        uint64_t pad = (GLWIN_PACK_ALIGN - offset % GLWIN_PACK_ALIGN) % GLWIN_PACK_ALIGN;
+        out.write(zeros, (std::streamsize)pad);
+        offset += pad;
+
+        GLwinPackEntry& e = entries[i];
+        size_t nameLen = strlen(names[i]);
+        e.nameHash = GLwinHash64(names[i], nameLen);
+        e.offset = offset;
+        e.size = view.size;
+        e.contentHash = GLwinHash64(view.data, view.size);
+        e.nameOffset = (uint32_t)nameBlob.size();
+        e.nameLength = (uint32_t)nameLen;
+        nameBlob.append(names[i], nameLen);
+
+        if (view.size) out.write(reinterpret_cast<const char*>(view.data), (std::streamsize)view.size);
+        offset += view.size;
+        GLwinUnmapFile(&view);
+    }
+
+    uint64_t pad = (GLWIN_PACK_ALIGN - offset % GLWIN_PACK_ALIGN) % GLWIN_PACK_ALIGN;
+    out.write(zeros, (std::streamsize)pad);
+    offset += pad;
+
+    // Index sorted by name hash for binary search; names stay in insertion order
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const GLwinPackEntry& a, const GLwinPackEntry& b) { return a.nameHash < b.nameHash; });
+    header.indexOffset = offset;
+    if (!entries.empty())
+        out.write(reinterpret_cast<const char*>(entries.data()), (std::streamsize)(entries.size() * sizeof(GLwinPackEntry)));
+    offset += entries.size() * sizeof(GLwinPackEntry);
+    header.namesOffset = offset;
+    out.write(nameBlob.data(), (std::streamsize)nameBlob.size());
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    return out.good();
+}
+
+int GLwinWritePack(const char* packPath, const char* const* names, const char* const* files, int count)
+{
+    if (!packPath || count < 0 || (count > 0 && (!names || !files))) return 0;
+
+    // Only one entry can answer to a name
+    std::vector<std::string> sorted(names, names + count);
+    std::sort(sorted.begin(), sorted.end());
+    auto dup = std::adjacent_find(sorted.begin(), sorted.end());
+    if (dup != sorted.end()) {
+        GLWIN_LOG_ERROR("GLwinWritePack: duplicate entry name " << *dup);
+        return 0;
+    }
+
+    // Write next to the target and rename over it, so a failure never leaves a truncated pack
+    std::filesystem::path path = glwin_internal_Utf8Path(packPath);
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    bool ok;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        ok = out && glwin_internal_WritePackTo(out, names, files, count);
+    }
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(temp, path, ec);
+        if (ec) GLWIN_LOG_ERROR("GLwinWritePack: cannot replace " << packPath << " (" << ec.message() << ")");
+        ok = !ec;
+    }
+    if (!ok) std::filesystem::remove(temp, ec);
+    return ok ? 1 : 0;
+}
+
+// ----------------------------------------------------------------------------
+// Resource lookup
+// ----------------------------------------------------------------------------
+
+int GLwinMountPack(const char* path)
+{
+    if (g_GLwinMountedPack) GLwinClosePack(g_GLwinMountedPack);
+    if (!path) return 1;
+    g_GLwinMountedPack = GLwinOpenPack(path);
+    if (g_GLwinMountedPack) {
+        GLWIN_LOG_INFO("Mounted pack " << path << " (" << g_GLwinMountedPack->count << " entries)");
+    }
+    return g_GLwinMountedPack ? 1 : 0;
+}
+
+int GLwinLoadResource(const char* name, GLwinFileView* out)
+{
+    if (!name || !out) return 0;
+    if (g_GLwinMountedPack) {
+        // pack names are relative to the working directory, with forward slashes and no leading "./"
+        std::filesystem::path p = glwin_internal_Utf8Path(name);
+        if (p.is_absolute()) {
+            std::error_code ec;
+            std::filesystem::path rel = p.lexically_relative(std::filesystem::current_path(ec));
+            if (!ec && !rel.empty()) p = rel;
+        }
+        std::u8string key8 = p.lexically_normal().generic_u8string();
+        std::string key(reinterpret_cast<const char*>(key8.data()), key8.size());
+        if (GLwinPackFind(g_GLwinMountedPack, key.c_str(), out)) return 1;
+    }
+    return GLwinMapFile(name, out);
+}
+
+void GLwinReleaseResource(GLwinFileView* view)
+{
+    // pack views have no handle and need no cleanup
+    GLwinUnmapFile(view);
+}
@@ -1,4 +1,5 @@
 #include "../GLwinTime.h"
+#ifdef _WIN32
 #include <windows.h>
 
 double GLwinGetTime(void) {
@@ -11,4 +12,37 @@ double GLwinGetTime(void) {
     LARGE_INTEGER now;
     QueryPerformanceCounter(&now);
     return (double)(now.QuadPart - start.QuadPart) / (double)freq.QuadPart;
-}
\ No newline at end of file
+}
+
+uint64_t GLwinGetTicks(void) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (uint64_t)now.QuadPart;
+}
+
+uint64_t GLwinGetTickFrequency(void) {
+    static LARGE_INTEGER freq = {};
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    return (uint64_t)freq.QuadPart;
+}
+
+#else
+#include <time.h>
+
+// Monotonic nanoseconds, so the tools and the log code can be built off Windows
+uint64_t GLwinGetTicks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t GLwinGetTickFrequency(void) {
+    return 1000000000ull;
+}
+
+double GLwinGetTime(void) {
+    static uint64_t start = GLwinGetTicks();
+    return (double)(GLwinGetTicks() - start) / 1e9;
+}
+
+#endif
\ No newline at end of file
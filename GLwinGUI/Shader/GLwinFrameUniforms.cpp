@@ -0,0 +1,78 @@
+#include "GLwinFrameUniforms.h"
+#include "../include/GLwinGLState.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include <cstring>
+
+GLwinFrameUniforms::GLwinFrameUniforms(int slices)
+    : start(std::chrono::steady_clock::now())
+{
+    const int maxSlices = (int)(sizeof(fences) / sizeof(fences[0]));
+    sliceCount = slices < 1 ? 1 : (slices > maxSlices ? maxSlices : slices);
+
+    // each slice must start on the driver's uniform buffer offset alignment
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    if (align <= 0) align = 256;
+    sliceStride = ((GLsizeiptr)sizeof(GLwinFrameBlock) + align - 1) / align * align;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    GLwinGLState::Get().BindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferStorage(GL_UNIFORM_BUFFER, sliceStride * sliceCount, nullptr, flags);
+    mapped = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, sliceStride * sliceCount, flags);
+    if (!mapped) {
+        GLWIN_LOG_ERROR("Failed to map the per-frame uniform buffer");
+    }
+}
+
+GLwinFrameUniforms::~GLwinFrameUniforms()
+{
+    for (int i = 0; i < sliceCount; ++i) {
+        if (fences[i]) glDeleteSync(fences[i]);
+    }
+    if (buffer) {
+        GLwinGLState& gl = GLwinGLState::Get();
+        gl.BindBuffer(GL_UNIFORM_BUFFER, buffer);
+        if (mapped) glUnmapBuffer(GL_UNIFORM_BUFFER);
+        gl.ForgetBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+void GLwinFrameUniforms::WaitForSlice(int s)
+{
+    if (!fences[s]) return;
+    // normally already signalled: the slice was last used sliceCount frames ago
+    GLenum r = glClientWaitSync(fences[s], 0, 0);
+    while (r == GL_TIMEOUT_EXPIRED) {
+        r = glClientWaitSync(fences[s], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    glDeleteSync(fences[s]);
+    fences[s] = nullptr;
+}
+
+void GLwinFrameUniforms::Update(const glm::mat4& view, const glm::mat4& projection, int viewportWidth, int viewportHeight)
+{
+    if (!mapped) return;
+
+    double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    current.view = view;
+    current.projection = projection;
+    current.viewport = glm::vec4(0.0f, 0.0f, (float)viewportWidth, (float)viewportHeight);
+    current.time = glm::vec4((float)now, (float)(now - lastTime), (float)frame, 0.0f);
+    lastTime = now;
+
+    slot = (int)(frame % (uint64_t)sliceCount);
+    WaitForSlice(slot);
+    memcpy(mapped + sliceStride * slot, &current, sizeof(current));
+    GLwinGLState::Get().BindBufferRange(GL_UNIFORM_BUFFER, GLWIN_FRAME_BLOCK_BINDING, buffer,
+        sliceStride * slot, sizeof(GLwinFrameBlock));
+}
+
+void GLwinFrameUniforms::EndFrame()
+{
+    if (!mapped) return;
+    if (fences[slot]) glDeleteSync(fences[slot]);
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++frame;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <glad/glad.h>
+#include "../vendors/glm/glm.hpp"
+#include <chrono>
+
+// Uniform block binding point reserved for the per-frame data.
+// GLSL side (see Shaders/test.vert):
+//   layout(std140, binding = 0) uniform GLwinFrame {
+//       mat4 view; mat4 projection; vec4 viewport; vec4 time;
+//   };
+#define GLWIN_FRAME_BLOCK_BINDING 0
+#define GLWIN_FRAME_BLOCK_NAME "GLwinFrame"
+
+// CPU mirror of the GLwinFrame block, laid out for std140 (every member is 16 byte aligned)
+struct GLwinFrameBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 viewport; // x, y, width, height in pixels
+    glm::vec4 time;     // seconds since start, delta seconds, frame number, unused
+};
+static_assert(sizeof(GLwinFrameBlock) == 160, "GLwinFrameBlock must match the std140 layout");
+
+// Per-frame uniform buffer shared by every program.
+// One persistently mapped buffer is split into a ring of slices; each frame writes the next slice
+// and binds it with glBindBufferRange, so the cost per frame is one memcpy and one bind no matter
+// how many shaders read the block. A fence per slice keeps the CPU from overwriting data the GPU
+// hasn't consumed yet.
+class GLwinFrameUniforms {
+public:
+    static const int DefaultSlices = 3;
+
+    explicit GLwinFrameUniforms(int slices = DefaultSlices);
+    ~GLwinFrameUniforms();
+
+    GLwinFrameUniforms(const GLwinFrameUniforms&) = delete;
+    GLwinFrameUniforms& operator=(const GLwinFrameUniforms&) = delete;
+
+    // Write this frame's slice and bind it to GLWIN_FRAME_BLOCK_BINDING
+    void Update(const glm::mat4& view, const glm::mat4& projection, int viewportWidth, int viewportHeight);
+    // Fence the slice written by Update; call once the frame's draws have been submitted
+    void EndFrame();
+
+    const GLwinFrameBlock& GetCurrent() const { return current; }
+    bool IsValid() const { return mapped != nullptr; }
+
+private:
+    void WaitForSlice(int slot);
+
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr;
+    GLsizeiptr sliceStride = 0;
+    int sliceCount = 0;
+    int slot = 0;
+    GLsync fences[8] = {};
+    uint64_t frame = 0;
+    GLwinFrameBlock current{};
+    std::chrono::steady_clock::time_point start;
+    double lastTime = 0.0;
+};
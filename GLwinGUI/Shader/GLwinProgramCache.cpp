@@ -0,0 +1,167 @@
+#include "GLwinProgramCache.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+static const char GLWIN_PROGRAM_CACHE_MAGIC[4] = { 'G', 'L', 'P', 'B' };
+static const uint32_t GLWIN_PROGRAM_CACHE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct GLwinProgramCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t length;
+    uint64_t payloadHash;
+};
+#pragma pack(pop)
+
+uint64_t GLwinProgramCache::Hash(const void* data, size_t size, uint64_t seed)
+{
+    // FNV-1a
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint64_t glwin_internal_HashString(const char* s, uint64_t seed)
+{
+    if (!s) s = "";
+    // include the length so ("ab","c") and ("a","bc") differ
+    uint64_t len = strlen(s);
+    seed = GLwinProgramCache::Hash(&len, sizeof(len), seed);
+    return GLwinProgramCache::Hash(s, (size_t)len, seed);
+}
+
+GLwinProgramCache::GLwinProgramCache(const std::string& directory)
+    : directory(directory)
+{
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    available = formats > 0;
+
+    uint64_t h = 1469598103934665603ull;
+    h = glwin_internal_HashString((const char*)glGetString(GL_VENDOR), h);
+    h = glwin_internal_HashString((const char*)glGetString(GL_RENDERER), h);
+    h = glwin_internal_HashString((const char*)glGetString(GL_VERSION), h);
+    driverHash = h;
+
+    if (available) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            GLWIN_LOG_WARNING("Program cache directory " << directory << " unavailable: " << ec.message());
+            available = false;
+        }
+    }
+}
+
+uint64_t GLwinProgramCache::MakeKey(const std::string& vertexCode, const std::string& fragmentCode,
+    const std::string& geometryCode, const std::string& defines) const
+{
+    uint64_t h = driverHash;
+    h = glwin_internal_HashString(vertexCode.c_str(), h);
+    h = glwin_internal_HashString(fragmentCode.c_str(), h);
+    h = glwin_internal_HashString(geometryCode.c_str(), h);
+    h = glwin_internal_HashString(defines.c_str(), h);
+    return h;
+}
+
+std::string GLwinProgramCache::PathFor(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.glbin", (unsigned long long)key);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+GLuint GLwinProgramCache::Load(uint64_t key) const
+{
+    if (!available) return 0;
+    std::string path = PathFor(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return 0;
+
+    auto reject = [&](const char* why) -> GLuint {
+        GLWIN_LOG_WARNING("Discarding program cache entry " << path << ": " << why);
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return 0;
+    };
+
+    GLwinProgramCacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return reject("truncated header");
+    if (memcmp(header.magic, GLWIN_PROGRAM_CACHE_MAGIC, 4) != 0 || header.version != GLWIN_PROGRAM_CACHE_VERSION)
+        return reject("bad magic or version");
+    if (header.key != key) return reject("key mismatch");
+
+    // a corrupt length must not turn into a huge allocation before the read finds out
+    std::error_code sizeEc;
+    uintmax_t fileSize = std::filesystem::file_size(path, sizeEc);
+    if (sizeEc || fileSize < sizeof(header) || header.length > fileSize - sizeof(header))
+        return reject("truncated payload");
+
+    std::vector<char> payload(header.length);
+    if (!file.read(payload.data(), (std::streamsize)payload.size())) return reject("truncated payload");
+    if (Hash(payload.data(), payload.size()) != header.payloadHash) return reject("checksum mismatch");
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, payload.data(), (GLsizei)payload.size());
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        // driver rejected it (e.g. updated in a way the version string didn't show)
+        glDeleteProgram(program);
+        return reject("driver rejected binary");
+    }
+    return program;
+}
+
+bool GLwinProgramCache::Store(uint64_t key, GLuint program) const
+{
+    if (!available || !program) return false;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    std::vector<char> payload((size_t)length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, payload.data());
+    if (written <= 0) return false;
+    payload.resize((size_t)written);
+
+    GLwinProgramCacheHeader header;
+    memcpy(header.magic, GLWIN_PROGRAM_CACHE_MAGIC, 4);
+    header.version = GLWIN_PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binaryFormat = format;
+    header.length = (uint32_t)payload.size();
+    header.payloadHash = Hash(payload.data(), payload.size());
+
+    // write to a temp file and rename, so a crash never leaves a half written entry behind
+    std::string path = PathFor(key);
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(payload.data(), (std::streamsize)payload.size());
+        if (!file) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <cstdint>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+// Entries are keyed by a hash of the shader sources, the injected defines and the driver's
+// vendor/renderer/version strings, so a driver update or an edited file simply misses.
+// A missing, stale or corrupt entry makes Load return 0 and the caller compiles from source.
+//
+// File layout (<directory>/<key as 16 hex digits>.glbin):
+//   "GLPB" u32 version, u64 key, u32 binaryFormat, u32 length, u64 payloadHash, payload[length]
+class GLwinProgramCache {
+public:
+    explicit GLwinProgramCache(const std::string& directory);
+
+    // false if the driver exposes no binary formats (every Load then misses)
+    bool IsAvailable() const { return available; }
+    const std::string& GetDirectory() const { return directory; }
+
+    // Hash sources + defines + driver identity. Unused stages may be passed as empty strings.
+    uint64_t MakeKey(const std::string& vertexCode, const std::string& fragmentCode,
+        const std::string& geometryCode, const std::string& defines) const;
+
+    // Create a program from the cached binary. Returns 0 on a miss; bad entries are deleted.
+    GLuint Load(uint64_t key) const;
+    // Write the binary of a linked program (needs GL_PROGRAM_BINARY_RETRIEVABLE_HINT before link)
+    bool Store(uint64_t key, GLuint program) const;
+
+    static uint64_t Hash(const void* data, size_t size, uint64_t seed = 1469598103934665603ull);
+
+private:
+    std::string PathFor(uint64_t key) const;
+
+    std::string directory;
+    uint64_t driverHash = 0;
+    bool available = false;
+};
@@ -5,12 +5,37 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "GLwinShaderReflection.h"
+#include "../include/GLwinGLState.h"
+#include "../../GLwin/include/GLwinProfile.h"
 
+// GL type each typed uniform handle expects (used to catch mismatches at resolve time)
+template <typename T> struct GLwinUniformType;
+template <> struct GLwinUniformType<bool> { static constexpr GLenum value = GL_BOOL; };
+template <> struct GLwinUniformType<int> { static constexpr GLenum value = GL_INT; };
+template <> struct GLwinUniformType<float> { static constexpr GLenum value = GL_FLOAT; };
+template <> struct GLwinUniformType<glm::vec2> { static constexpr GLenum value = GL_FLOAT_VEC2; };
+template <> struct GLwinUniformType<glm::vec3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+template <> struct GLwinUniformType<glm::vec4> { static constexpr GLenum value = GL_FLOAT_VEC4; };
+template <> struct GLwinUniformType<glm::mat2> { static constexpr GLenum value = GL_FLOAT_MAT2; };
+template <> struct GLwinUniformType<glm::mat3> { static constexpr GLenum value = GL_FLOAT_MAT3; };
+template <> struct GLwinUniformType<glm::mat4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
 
 class Shader
 {
 public:
 
+    // Typed uniform handle, resolve once with GetUniform<T>() and keep it
+    template <typename T>
+    struct Uniform {
+        GLint location = -1;
+        bool IsValid() const { return location >= 0; }
+    };
+
+    using UniformInfo = GLwinUniformInfo;
 
     unsigned int ID;
     // constructor generates the shader on the fly
@@ -58,132 +83,217 @@ public:
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
             //LogInternals::Instance()->Critical("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ:" );
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // if geometry shader is given, compile geometry shader
-        unsigned int geometry;
-        if (geometryPath != nullptr)
-        {
-            const char* gShaderCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gShaderCode, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
+        Build(vertexCode, fragmentCode, geometryCode);
+    }
+    // adopt an already linked program (binary cache, async compile)
+    // ------------------------------------------------------------------------
+    explicit Shader(GLuint program) : ID(program), linked(program != 0)
+    {
+        reflection.Reflect(ID);
+    }
+    // compile and link from in-memory sources (empty geometryCode = no geometry stage)
+    // ------------------------------------------------------------------------
+    static Shader FromSource(const std::string& vertexCode, const std::string& fragmentCode,
+        const std::string& geometryCode = std::string())
+    {
+        Shader shader;
+        shader.Build(vertexCode, fragmentCode, geometryCode);
+        return shader;
+    }
+    // false if the last compile/link failed (the error has already been printed)
+    bool IsLinked() const { return linked; }
+    // read a whole shader file into out; false if it can't be opened
+    static bool ReadSource(const char* path, std::string& out)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return false;
         }
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if (geometryPath != nullptr)
-            glAttachShader(ID, geometry);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (geometryPath != nullptr)
-            glDeleteShader(geometry);
-
+        std::stringstream stream;
+        stream << file.rdbuf();
+        out = stream.str();
+        return true;
     }
+
     // activate the shader
+    // Cached bind through GLwinGLState: glUseProgram is skipped when this program is already current.
     // ------------------------------------------------------------------------
     void Use()
     {
-        glUseProgram(ID);
-         GLint count;
-        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
-        for (int i = 0; i < count; ++i) {
-            char name[256];
-            GLsizei length;
-            GLint size;
-            GLenum type;
-            glGetActiveUniform(ID, i, sizeof(name), &length, &size, &type, name);
-            std::cout << "Active Uniform: " << name << std::endl;
+        GLwinGLState::Get().UseProgram(ID);
+    }
+    // Call if something outside Shader changed the bound program (raw glUseProgram etc.)
+    static void InvalidateBinding() { GLwinGLState::Get().ForgetProgram(GLwinGLState::Get().GetProgram()); }
+
+    // uniform reflection
+    // ------------------------------------------------------------------------
+    const ShaderReflection& GetReflection() const { return reflection; }
+    // Location from the table built at link time (no driver call). -1 if the uniform isn't active.
+    GLint GetUniformLocation(const std::string& name) const { return reflection.GetUniformLocation(name); }
+    const UniformInfo* GetUniformInfo(const std::string& name) const { return reflection.FindUniform(name); }
+    const std::vector<UniformInfo>& GetUniforms() const { return reflection.GetUniforms(); }
 
+    // Resolve a typed handle once (at load time), then pass it to the setters below
+    template <typename T>
+    Uniform<T> GetUniform(const std::string& name) const
+    {
+        Uniform<T> u;
+        const UniformInfo* info = GetUniformInfo(name);
+        if (!info) return u;
+        // samplers are set through int handles
+        bool samplerAsInt = std::is_same<T, int>::value && IsSamplerType(info->type);
+        if (info->type != GLwinUniformType<T>::value && !samplerAsInt) {
+            std::cout << "WARNING::SHADER::UNIFORM_TYPE_MISMATCH: " << name << std::endl;
+            return u;
         }
-       
+        u.location = info->location;
+        return u;
     }
-    // utility uniform functions
+
+    // utility uniform functions (handle versions, no lookups)
+    // ------------------------------------------------------------------------
+    void setBool(Uniform<bool> u, bool value) const { glUniform1i(u.location, (int)value); }
+    void setInt(Uniform<int> u, int value) const { glUniform1i(u.location, value); }
+    void setFloat(Uniform<float> u, float value) const { glUniform1f(u.location, value); }
+    void setVec2(Uniform<glm::vec2> u, const glm::vec2& value) const { glUniform2fv(u.location, 1, &value[0]); }
+    void setVec3(Uniform<glm::vec3> u, const glm::vec3& value) const { glUniform3fv(u.location, 1, &value[0]); }
+    void setVec4(Uniform<glm::vec4> u, const glm::vec4& value) const { glUniform4fv(u.location, 1, &value[0]); }
+    void setMat2(Uniform<glm::mat2> u, const glm::mat2& mat) const { glUniformMatrix2fv(u.location, 1, GL_FALSE, &mat[0][0]); }
+    void setMat3(Uniform<glm::mat3> u, const glm::mat3& mat) const { glUniformMatrix3fv(u.location, 1, GL_FALSE, &mat[0][0]); }
+    void setMat4(Uniform<glm::mat4> u, const glm::mat4& mat) const { glUniformMatrix4fv(u.location, 1, GL_FALSE, &mat[0][0]); }
+
+    // utility uniform functions (by name, looked up in the reflected table)
     // ------------------------------------------------------------------------
     void setBool(const std::string& name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(GetUniformLocation(name), (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string& name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(GetUniformLocation(name), (int)value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string& name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(GetUniformLocation(name), value);
     }
     // ------------------------------------------------------------------------
 
     void setVec2(const std::string& name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, reinterpret_cast<const float*>(&value));
+        glUniform2fv(GetUniformLocation(name), 1, reinterpret_cast<const float*>(&value));
     }
 
     void setVec2(const std::string& name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(GetUniformLocation(name), x, y);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string& name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, reinterpret_cast<const float*>(&value));
+        glUniform3fv(GetUniformLocation(name), 1, reinterpret_cast<const float*>(&value));
     }
     void setVec3(const std::string& name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(GetUniformLocation(name), x, y, z);
     }
     // ######################### My Vec4 ###########################################
     void setRGBAVec4(const std::string& name, float r, float g, float b, float a) {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), r, g, b, a);
+        glUniform4f(GetUniformLocation(name), r, g, b, a);
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string& name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, reinterpret_cast<const float*>(&value));
+        glUniform4fv(GetUniformLocation(name), 1, reinterpret_cast<const float*>(&value));
     }
     void setVec4(const std::string& name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(GetUniformLocation(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string& name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string& name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string& name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    ShaderReflection reflection;
+    bool linked = false;
+
+    Shader() : ID(0) {}
+
+    void Build(const std::string& vertexCode, const std::string& fragmentCode, const std::string& geometryCode)
+    {
+        GLWIN_PROFILE_SCOPE("ShaderCompile");
+        const char* vShaderCode = vertexCode.c_str();
+        const char* fShaderCode = fragmentCode.c_str();
+        // 2. compile shaders
+        unsigned int vertex, fragment;
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        checkCompileErrors(fragment, "FRAGMENT");
+        // if geometry shader is given, compile geometry shader
+        unsigned int geometry;
+        if (!geometryCode.empty())
+        {
+            const char* gShaderCode = geometryCode.c_str();
+            geometry = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(geometry, 1, &gShaderCode, NULL);
+            glCompileShader(geometry);
+            checkCompileErrors(geometry, "GEOMETRY");
+        }
+        // shader Program
+        ID = glCreateProgram();
+        // lets GLwinProgramCache fetch the binary afterwards
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        if (!geometryCode.empty())
+            glAttachShader(ID, geometry);
+        glLinkProgram(ID);
+        linked = checkCompileErrors(ID, "PROGRAM");
+        reflection.Reflect(ID);
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        if (!geometryCode.empty())
+            glDeleteShader(geometry);
+    }
+
+    static bool IsSamplerType(GLenum type)
+    {
+        switch (type) {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_SHADOW:
+        case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_SAMPLER_2D_MULTISAMPLE:
+            return true;
+        default:
+            return false;
+        }
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(GLuint shader, std::string type)
+    bool checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
         GLchar infoLog[1024];
@@ -205,5 +315,6 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
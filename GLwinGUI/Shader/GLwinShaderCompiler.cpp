@@ -0,0 +1,214 @@
+#include "GLwinShaderCompiler.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include "../../GLwin/include/GLwinProfile.h"
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+typedef void (APIENTRYP GLWIN_PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+// Flat magenta, reads the same GLwinFrame block as the real GUI shaders
+static const char* GLWIN_PLACEHOLDER_VS =
+    "#version 460\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (std140, binding = 0) uniform GLwinFrame { mat4 view; mat4 projection; vec4 viewport; vec4 time; };\n"
+    "uniform mat4 model;\n"
+    "void main() { gl_Position = projection * view * model * vec4(aPos, 1.0); }\n";
+static const char* GLWIN_PLACEHOLDER_FS =
+    "#version 460\n"
+    "out vec4 FragColor;\n"
+    "void main() { FragColor = vec4(1.0, 0.0, 1.0, 1.0); }\n";
+
+static bool glwin_internal_HasExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (ext && strcmp(ext, name) == 0) return true;
+    }
+    return false;
+}
+
+static void* glwin_internal_GetProcAddress(const char* name)
+{
+#ifdef _WIN32
+    void* p = (void*)wglGetProcAddress(name);
+    // wglGetProcAddress signals failure with a few small values as well as NULL
+    if (p == (void*)0x1 || p == (void*)0x2 || p == (void*)0x3 || p == (void*)-1) p = nullptr;
+    return p;
+#else
+    (void)name;
+    return nullptr;
+#endif
+}
+
+GLwinShaderCompiler::GLwinShaderCompiler()
+{
+    if (glwin_internal_HasExtension("GL_KHR_parallel_shader_compile") ||
+        glwin_internal_HasExtension("GL_ARB_parallel_shader_compile")) {
+        parallel = true;
+        auto maxThreads = (GLWIN_PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glwin_internal_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+        if (!maxThreads) maxThreads = (GLWIN_PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glwin_internal_GetProcAddress("glMaxShaderCompilerThreadsARB");
+        // 0xFFFFFFFF = let the driver pick
+        if (maxThreads) maxThreads(0xFFFFFFFFu);
+        GLWIN_LOG_INFO("Parallel shader compile available");
+    }
+    placeholder = std::make_unique<Shader>(Shader::FromSource(GLWIN_PLACEHOLDER_VS, GLWIN_PLACEHOLDER_FS));
+}
+
+GLwinShaderCompiler::~GLwinShaderCompiler()
+{
+    for (Job& job : jobs) {
+        for (int i = 0; i < job.stageCount; ++i) glDeleteShader(job.stages[i]);
+        if (job.program) glDeleteProgram(job.program);
+    }
+}
+
+void GLwinShaderCompiler::Submit(Shader* target, const std::string& vertexCode, const std::string& fragmentCode,
+    const std::string& geometryCode, GLwinProgramCache* cache, uint64_t cacheKey)
+{
+    GLWIN_PROFILE_SCOPE("ShaderCompileSubmit");
+    Job job;
+    job.target = target;
+    job.cache = cache;
+    job.cacheKey = cacheKey;
+    job.submitted = std::chrono::steady_clock::now();
+
+    const GLenum types[3] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+    const std::string* sources[3] = { &vertexCode, &fragmentCode, &geometryCode };
+    for (int i = 0; i < 3; ++i) {
+        if (i == 2 && geometryCode.empty()) break;
+        const char* src = sources[i]->c_str();
+        GLuint s = glCreateShader(types[i]);
+        glShaderSource(s, 1, &src, NULL);
+        glCompileShader(s); // no status query here: that is what would block
+        job.stages[job.stageCount++] = s;
+    }
+    jobs.push_back(job);
+}
+
+void GLwinShaderCompiler::Cancel(const Shader* target)
+{
+    for (size_t i = 0; i < jobs.size();) {
+        if (jobs[i].target != target) {
+            ++i;
+            continue;
+        }
+        for (int s = 0; s < jobs[i].stageCount; ++s) glDeleteShader(jobs[i].stages[s]);
+        if (jobs[i].program) glDeleteProgram(jobs[i].program);
+        jobs[i] = jobs.back();
+        jobs.pop_back();
+    }
+}
+
+bool GLwinShaderCompiler::IsPending(const Shader* target) const
+{
+    for (const Job& job : jobs) {
+        if (job.target == target) return true;
+    }
+    return false;
+}
+
+bool GLwinShaderCompiler::IsComplete(GLuint object, bool isProgram) const
+{
+    if (!parallel) return true;
+    GLint done = GL_FALSE;
+    if (isProgram) glGetProgramiv(object, GL_COMPLETION_STATUS_KHR, &done);
+    else glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+bool GLwinShaderCompiler::Advance(Job& job)
+{
+    if (job.state == JobState::Compiling) {
+        for (int i = 0; i < job.stageCount; ++i) {
+            if (!IsComplete(job.stages[i], false)) return false;
+        }
+        bool ok = true;
+        for (int i = 0; i < job.stageCount; ++i) {
+            GLint success = GL_FALSE;
+            glGetShaderiv(job.stages[i], GL_COMPILE_STATUS, &success);
+            if (!success) {
+                GLchar infoLog[1024];
+                glGetShaderInfoLog(job.stages[i], sizeof(infoLog), NULL, infoLog);
+                GLWIN_LOG_ERROR("Shader compilation failed:\n" << infoLog);
+                ok = false;
+            }
+        }
+        if (!ok) {
+            Complete(job, false);
+            return true;
+        }
+        job.program = glCreateProgram();
+        glProgramParameteri(job.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        for (int i = 0; i < job.stageCount; ++i) glAttachShader(job.program, job.stages[i]);
+        glLinkProgram(job.program);
+        job.state = JobState::Linking;
+        // fall through: the link may already be done (always true without the extension)
+    }
+
+    if (!IsComplete(job.program, true)) return false;
+    GLint success = GL_FALSE;
+    glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+    if (!success) {
+        GLchar infoLog[1024];
+        glGetProgramInfoLog(job.program, sizeof(infoLog), NULL, infoLog);
+        GLWIN_LOG_ERROR("Program linking failed:\n" << infoLog);
+    }
+    Complete(job, success != 0);
+    return true;
+}
+
+void GLwinShaderCompiler::Complete(Job& job, bool ok)
+{
+    for (int i = 0; i < job.stageCount; ++i) glDeleteShader(job.stages[i]);
+    job.stageCount = 0;
+
+    if (ok) {
+        if (job.cache) job.cache->Store(job.cacheKey, job.program);
+        GLuint old = job.target->ID;
+        *job.target = Shader(job.program);
+        if (old && old != placeholder->ID) {
+            GLwinGLState::Get().ForgetProgram(old);
+            glDeleteProgram(old);
+        }
+        job.program = 0;
+    }
+    else if (job.program) {
+        glDeleteProgram(job.program);
+        job.program = 0;
+    }
+
+    if (onComplete) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.submitted).count();
+        onComplete(job.target, ok, ms);
+    }
+}
+
+int GLwinShaderCompiler::Poll()
+{
+    GLWIN_PROFILE_SCOPE("ShaderCompilePoll");
+    int finished = 0;
+    for (size_t i = 0; i < jobs.size();) {
+        if (Advance(jobs[i])) {
+            jobs[i] = jobs.back();
+            jobs.pop_back();
+            ++finished;
+        }
+        else {
+            ++i;
+        }
+    }
+    return finished;
+}
+
+void GLwinShaderCompiler::Finish()
+{
+    // skipping the completion check makes the status queries wait inside the driver
+    bool wasParallel = parallel;
+    parallel = false;
+    Poll();
+    parallel = wasParallel;
+}
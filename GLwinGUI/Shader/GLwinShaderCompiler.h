@@ -0,0 +1,76 @@
+#pragma once
+#include "GLwinShader.h"
+#include "GLwinProgramCache.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+
+// GL_KHR_parallel_shader_compile (not part of the glad core profile we generate)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+
+// Non-blocking program builds.
+// Submit issues glCompileShader for every stage and returns straight away; Poll (once per frame)
+// checks GL_COMPLETION_STATUS_KHR and moves each job on to link, then into its Shader, without
+// ever waiting on the driver. Until then the Shader holds a flat placeholder program so it can be
+// drawn with from the start. Without the extension the status query is skipped, so Poll still
+// works but the driver may block inside it.
+class GLwinShaderCompiler {
+public:
+    // Called after a job finished and its target was updated (ok == false: target left as it was)
+    using CompletionCallback = std::function<void(Shader* target, bool ok, double milliseconds)>;
+
+    GLwinShaderCompiler();
+    ~GLwinShaderCompiler();
+
+    bool HasParallelCompile() const { return parallel; }
+    void SetCompletionCallback(CompletionCallback cb) { onComplete = std::move(cb); }
+
+    // Start building target from the given sources. On success the linked program replaces
+    // target's current one (which is deleted unless it is the placeholder) and, if a cache is
+    // given, its binary is stored under cacheKey.
+    void Submit(Shader* target, const std::string& vertexCode, const std::string& fragmentCode,
+        const std::string& geometryCode, GLwinProgramCache* cache = nullptr, uint64_t cacheKey = 0);
+
+    // Advance all jobs without blocking. Returns how many finished (either way) during this call.
+    int Poll();
+    // Block until every submitted job has finished
+    void Finish();
+
+    // Drop any unfinished job for target (a newer Submit supersedes it)
+    void Cancel(const Shader* target);
+
+    size_t GetPendingCount() const { return jobs.size(); }
+    bool IsPending(const Shader* target) const;
+    // Drawn by Shaders whose real program isn't ready yet
+    const Shader& GetPlaceholder() const { return *placeholder; }
+
+private:
+    enum class JobState { Compiling, Linking };
+    struct Job {
+        Shader* target = nullptr;
+        GLuint stages[3] = { 0, 0, 0 };
+        int stageCount = 0;
+        GLuint program = 0;
+        JobState state = JobState::Compiling;
+        GLwinProgramCache* cache = nullptr;
+        uint64_t cacheKey = 0;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    bool IsComplete(GLuint object, bool isProgram) const;
+    // true when the job is finished (successfully or not) and can be dropped
+    bool Advance(Job& job);
+    void Complete(Job& job, bool ok);
+
+    std::vector<Job> jobs;
+    std::unique_ptr<Shader> placeholder;
+    CompletionCallback onComplete;
+    bool parallel = false;
+};
@@ -1,11 +1,367 @@
 #include "GLwinShaderManager.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include <chrono>
+#include <algorithm>
 
 Shader* GLwinShaderManager::defaultShader = nullptr;
+GLwinShaderHandle GLwinShaderManager::defaultShaderHandle;
+Shader* GLwinShaderManager::imageShader = nullptr;
+GLwinShaderHandle GLwinShaderManager::imageShaderHandle;
+std::string GLwinShaderManager::cacheDirectory = "ShaderCache";
+std::unique_ptr<GLwinProgramCache> GLwinShaderManager::programCache;
+std::unique_ptr<GLwinShaderCompiler> GLwinShaderManager::compiler;
+int GLwinShaderManager::cacheHits = 0;
+int GLwinShaderManager::cacheMisses = 0;
+std::vector<GLwinShaderManager::Entry> GLwinShaderManager::entries;
+std::mutex GLwinShaderManager::registryMutex;
+std::vector<GLwinShaderManager::ReloadRequest> GLwinShaderManager::reloadQueue;
+GLwinFileWatcher GLwinShaderManager::watcher;
+GLwinShaderPreprocessor GLwinShaderManager::preprocessor;
+
+static double glwin_internal_MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
 void GLwinShaderManager::SetUpShaders()
 {
-	defaultShader = new Shader("Shader/Shaders/test.vert", "Shader/Shaders/test.frag");
+	auto start = std::chrono::steady_clock::now();
+	cacheHits = cacheMisses = 0;
+
+	// Everything is submitted up front; compiles overlap with the rest of startup
+	defaultShaderHandle = Register("Shader/Shaders/test.vert", "Shader/Shaders/test.frag");
+	defaultShader = Get(defaultShaderHandle);
+	imageShaderHandle = Register("Shader/Shaders/image.vert", "Shader/Shaders/image.frag");
+	imageShader = Get(imageShaderHandle);
 
 	/*defaultShader = new Shader("C:\Users\marty\Desktop\GLwinGUI\GLwinTest\GLwinGUI\Shader\Shaders\test.vert",
 		"C:\Users\marty\Desktop\GLwinGUI\GLwinTest\GLwinGUI\Shader\Shaders\test.frag");*/
+
+	GLWIN_LOG_INFO("Shader setup submitted in " << glwin_internal_MillisecondsSince(start) << " ms ("
+		<< cacheHits << " from program cache, " << cacheMisses << " compiling)");
+
+#ifdef _DEBUG
+	EnableHotReload("Shader/Shaders");
+#endif
+}
+
+void GLwinShaderManager::ReadSources(const char* vertexPath, const char* fragmentPath, const char* geometryPath,
+	const std::vector<std::string>& defines, Sources& out)
+{
+	// Includes are parsed once and shared; an unchanged permutation is a memo lookup
+	const char* paths[3] = { vertexPath, fragmentPath, geometryPath };
+	std::string* code[3] = { &out.vertex, &out.fragment, &out.geometry };
+	out.ok = true;
+	out.files.clear();
+	for (int i = 0; i < 3; ++i) {
+		if (!paths[i]) continue;
+		GLwinShaderPreprocessor::Result r = preprocessor.Process(paths[i], defines);
+		if (!r.ok) {
+			GLWIN_LOG_ERROR("Shader preprocessing failed: " << r.error);
+			out.ok = false;
+		}
+		*code[i] = std::move(r.source);
+		for (std::string& f : r.files) {
+			if (std::find(out.files.begin(), out.files.end(), f) == out.files.end()) out.files.push_back(std::move(f));
+		}
+	}
+
+	std::string defineKey;
+	for (const std::string& d : defines) defineKey += d + ";";
+	out.key = GetProgramCache()->MakeKey(out.vertex, out.fragment, out.geometry, defineKey);
+}
+
+Shader* GLwinShaderManager::Load(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+{
+	Shader* shader = Submit(vertexPath, fragmentPath, geometryPath);
+	if (!IsReady(shader)) {
+		auto start = std::chrono::steady_clock::now();
+		GetCompiler()->Finish();
+		GLWIN_LOG_INFO("Waited " << glwin_internal_MillisecondsSince(start) << " ms for " << vertexPath);
+	}
+	return shader;
+}
+
+Shader* GLwinShaderManager::Submit(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+{
+	Sources src;
+	ReadSources(vertexPath, fragmentPath, geometryPath, std::vector<std::string>(), src);
+	return Build(src, vertexPath, nullptr);
+}
+
+Shader* GLwinShaderManager::Build(const Sources& src, const char* name, Shader* target, bool* fromCache)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	GLuint program = src.ok ? GetProgramCache()->Load(src.key) : 0;
+	if (fromCache) *fromCache = program != 0;
+	if (program) {
+		++cacheHits;
+		if (!target) {
+			target = new Shader(program);
+		}
+		else {
+			if (compiler) compiler->Cancel(target);
+			GLuint old = target->ID;
+			*target = Shader(program);
+			if (old && (!compiler || old != compiler->GetPlaceholder().ID)) {
+				GLwinGLState::Get().ForgetProgram(old);
+				glDeleteProgram(old);
+			}
+		}
+		BindFrameBlock(target);
+		GLWIN_LOG_INFO("Shader " << name << " loaded from program cache in "
+			<< glwin_internal_MillisecondsSince(start) << " ms");
+		return target;
+	}
+
+	GLwinShaderCompiler* c = GetCompiler();
+	if (!target) target = new Shader(c->GetPlaceholder());
+	if (!src.ok) return target; // keeps whatever it had; the error is already logged
+
+	// cold: compile from source in the background and keep the binary for next launch
+	++cacheMisses;
+	c->Cancel(target); // a newer request supersedes a build still in flight
+	c->Submit(target, src.vertex, src.fragment, src.geometry, GetProgramCache(), src.key);
+	return target;
+}
+
+void GLwinShaderManager::Poll()
+{
+	// Rebuilds prepared by the watcher thread since last frame
+	std::vector<ReloadRequest> requests;
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		requests.swap(reloadQueue);
+	}
+	for (ReloadRequest& r : requests) {
+		Entry* e = FindEntry({ r.index, r.generation });
+		if (!e) continue;
+		{
+			// includes may have been added or removed
+			std::lock_guard<std::mutex> lock(registryMutex);
+			if (!r.sources.files.empty()) e->files = r.sources.files;
+		}
+		if (e->lazy) continue; // never used yet, Get builds it from the fresh files
+		bool fromCache = false;
+		Build(r.sources, e->paths[0].c_str(), e->shader, &fromCache);
+		if (fromCache) OnBuildComplete(e->shader, true, 0.0);
+	}
+
+	if (compiler) compiler->Poll();
+}
+
+void GLwinShaderManager::Finish()
+{
+	if (compiler) compiler->Finish();
+}
+
+bool GLwinShaderManager::IsReady(const Shader* shader)
+{
+	return shader && (!compiler || !compiler->IsPending(shader));
+}
+
+// ----------------------------------------------------------------------------
+// Registry / hot reload
+// ----------------------------------------------------------------------------
+
+GLwinShaderHandle GLwinShaderManager::Register(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+{
+	Sources src;
+	ReadSources(vertexPath, fragmentPath, geometryPath, std::vector<std::string>(), src);
+	Shader* shader = Build(src, vertexPath, nullptr);
+	return AddEntry(vertexPath, fragmentPath, geometryPath, std::vector<std::string>(), src.files, shader, false);
+}
+
+GLwinShaderHandle GLwinShaderManager::RegisterVariant(const char* vertexPath, const char* fragmentPath,
+	const std::vector<std::string>& defines, const char* geometryPath)
+{
+	std::vector<std::string> sorted = defines;
+	std::sort(sorted.begin(), sorted.end());
+	for (uint32_t i = 0; i < entries.size(); ++i) {
+		const Entry& e = entries[i];
+		if (e.alive && e.defines == sorted && e.paths[0] == vertexPath && e.paths[1] == fragmentPath &&
+			e.paths[2] == (geometryPath ? geometryPath : "")) {
+			return { i, e.generation };
+		}
+	}
+
+	// Files are resolved now (so hot reload sees them); compiling waits for the first Get
+	std::vector<std::string> files;
+	for (const char* p : { vertexPath, fragmentPath, geometryPath }) {
+		if (p) files.push_back(GLwinShaderPreprocessor::NormalisePath(p));
+	}
+	Shader* shader = new Shader(GetCompiler()->GetPlaceholder());
+	return AddEntry(vertexPath, fragmentPath, geometryPath, sorted, files, shader, true);
+}
+
+GLwinShaderHandle GLwinShaderManager::AddEntry(const char* vertexPath, const char* fragmentPath, const char* geometryPath,
+	const std::vector<std::string>& defines, const std::vector<std::string>& files, Shader* shader, bool lazy)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	uint32_t index = 0;
+	while (index < entries.size() && entries[index].alive) ++index;
+	if (index == entries.size()) entries.emplace_back();
+
+	Entry& e = entries[index];
+	e.paths[0] = vertexPath;
+	e.paths[1] = fragmentPath;
+	e.paths[2] = geometryPath ? geometryPath : "";
+	e.defines = defines;
+	e.files = files;
+	e.shader = shader;
+	e.lazy = lazy;
+	e.version = (!lazy && IsReady(shader)) ? 1 : 0;
+	e.alive = true;
+	return { index, e.generation };
+}
+
+void GLwinShaderManager::Unregister(GLwinShaderHandle handle)
+{
+	Entry* e = FindEntry(handle);
+	if (!e) return;
+	if (compiler) compiler->Cancel(e->shader);
+	if (e->shader->ID && (!compiler || e->shader->ID != compiler->GetPlaceholder().ID)) {
+		GLwinGLState::Get().ForgetProgram(e->shader->ID);
+		glDeleteProgram(e->shader->ID);
+	}
+	delete e->shader;
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	e->shader = nullptr;
+	e->alive = false;
+	e->lazy = false;
+	e->files.clear();
+	e->defines.clear();
+	++e->generation;
+}
+
+GLwinShaderManager::Entry* GLwinShaderManager::FindEntry(GLwinShaderHandle handle)
+{
+	if (handle.index >= entries.size()) return nullptr;
+	Entry& e = entries[handle.index];
+	return (e.alive && e.generation == handle.generation) ? &e : nullptr;
+}
+
+Shader* GLwinShaderManager::Get(GLwinShaderHandle handle)
+{
+	Entry* e = FindEntry(handle);
+	if (!e) return nullptr;
+	if (e->lazy) {
+		// first use of a variant: expand and start compiling, placeholder until it's ready
+		e->lazy = false;
+		Sources src;
+		ReadSources(e->paths[0].c_str(), e->paths[1].c_str(), e->paths[2].empty() ? nullptr : e->paths[2].c_str(),
+			e->defines, src);
+		bool fromCache = false;
+		Build(src, e->paths[0].c_str(), e->shader, &fromCache);
+		if (fromCache) ++e->version;
+		std::lock_guard<std::mutex> lock(registryMutex);
+		e->files = src.files;
+	}
+	return e->shader;
+}
+
+uint32_t GLwinShaderManager::GetVersion(GLwinShaderHandle handle)
+{
+	Entry* e = FindEntry(handle);
+	return e ? e->version : 0;
+}
+
+bool GLwinShaderManager::EnableHotReload(const std::string& directory)
+{
+	GetProgramCache(); // created here, on the GL thread, before the watcher can use MakeKey
+	bool ok = watcher.Start(directory, &GLwinShaderManager::OnFilesChanged);
+	if (ok) GLWIN_LOG_INFO("Shader hot reload watching " << watcher.GetDirectory());
+	return ok;
+}
+
+void GLwinShaderManager::DisableHotReload()
+{
+	watcher.Stop();
+}
+
+void GLwinShaderManager::OnFilesChanged(const std::vector<std::string>& paths)
+{
+	// Parsed copies of the changed files (and permutations using them) are stale now
+	for (const std::string& p : paths) preprocessor.Invalidate(p);
+
+	// Find affected programs under the lock, read their files without it
+	std::vector<ReloadRequest> requests;
+	std::vector<Entry> affected;
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		for (uint32_t i = 0; i < entries.size(); ++i) {
+			const Entry& e = entries[i];
+			if (!e.alive) continue;
+			bool hit = std::any_of(e.files.begin(), e.files.end(), [&](const std::string& f) {
+				return std::binary_search(paths.begin(), paths.end(), f);
+			});
+			if (!hit) continue;
+			requests.push_back({ i, e.generation, Sources() });
+			affected.push_back(e);
+		}
+	}
+	if (requests.empty()) return;
+
+	for (size_t i = 0; i < requests.size(); ++i) {
+		const Entry& e = affected[i];
+		GLWIN_LOG_INFO("Reloading shader " << e.paths[0]);
+		ReadSources(e.paths[0].c_str(), e.paths[1].c_str(), e.paths[2].empty() ? nullptr : e.paths[2].c_str(),
+			e.defines, requests[i].sources);
+	}
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (ReloadRequest& r : requests) reloadQueue.push_back(std::move(r));
+}
+
+void GLwinShaderManager::OnBuildComplete(Shader* shader, bool ok, double ms)
+{
+	if (!ok) {
+		GLWIN_LOG_ERROR("Shader build failed after " << ms << " ms, keeping the previous program");
+		return;
+	}
+	BindFrameBlock(shader);
+	for (Entry& e : entries) {
+		if (e.alive && e.shader == shader) ++e.version;
+	}
+	GLWIN_LOG_INFO("Shader program " << shader->ID << " ready in " << ms << " ms");
+}
+
+void GLwinShaderManager::BindFrameBlock(Shader* shader)
+{
+	if (!shader || !shader->ID) return;
+	// Shaders declaring binding = 0 already match; this covers ones that don't
+	const GLwinUniformBlockInfo* block = shader->GetReflection().FindBlock(GLWIN_FRAME_BLOCK_NAME);
+	if (!block || block->binding == GLWIN_FRAME_BLOCK_BINDING) return;
+	glUniformBlockBinding(shader->ID, block->index, GLWIN_FRAME_BLOCK_BINDING);
+}
+
+bool GLwinShaderManager::SetProgramCacheDirectory(const std::string& directory)
+{
+	// ReadSources on the watcher thread calls MakeKey on the current cache
+	if (watcher.IsRunning()) {
+		GLWIN_LOG_WARNING("Program cache directory can't change while shader hot reload is enabled");
+		return false;
+	}
+	// builds in flight store into the cache they were submitted with
+	if (compiler) compiler->Finish();
+	cacheDirectory = directory;
+	programCache.reset();
+	return true;
+}
+
+GLwinProgramCache* GLwinShaderManager::GetProgramCache()
+{
+	if (!programCache) programCache = std::make_unique<GLwinProgramCache>(cacheDirectory);
+	return programCache.get();
+}
+
+GLwinShaderCompiler* GLwinShaderManager::GetCompiler()
+{
+	if (!compiler) {
+		compiler = std::make_unique<GLwinShaderCompiler>();
+		compiler->SetCompletionCallback(&GLwinShaderManager::OnBuildComplete);
+	}
+	return compiler.get();
 }
@@ -1,11 +1,118 @@
 #pragma once
 #include "GLwinShader.h"
+#include "GLwinFrameUniforms.h"
+#include "GLwinProgramCache.h"
+#include "GLwinShaderCompiler.h"
+#include "GLwinShaderPreprocessor.h"
+#include "../include/GLwinFileWatcher.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
 
+// Stable reference to a registered program. The generation catches use after Unregister.
+struct GLwinShaderHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+	bool IsValid() const { return index != UINT32_MAX; }
+};
 
 class GLwinShaderManager
 {
 public:
 	static void SetUpShaders();
 
+	// Build a program and attach its GLwinFrame block (if any) to the shared per-frame buffer.
+	// The linked binary is taken from / written to the program cache. Blocks until linked.
+	static Shader* Load(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+	// Same, without blocking: a cache hit is ready at once, otherwise the returned Shader draws
+	// with the placeholder program until Poll swaps the real one in.
+	static Shader* Submit(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+	// Frame boundary: queue changed shaders for rebuild and swap in finished ones.
+	// Call once per frame (GLwinGUI::RenderGUI does).
+	static void Poll();
+	// Wait for every submitted build
+	static void Finish();
+	static bool IsReady(const Shader* shader);
+
+	// Registry: Submit + remember the source files so the program can be hot reloaded.
+	// The Shader* behind a handle never moves; reloads replace its program in place.
+	static GLwinShaderHandle Register(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+	static void Unregister(GLwinShaderHandle handle);
+	// Permutation of a shader with a define set ("NAME" or "NAME=VALUE"). Nothing is compiled
+	// until the first Get; registering the same files and defines again returns the same handle.
+	static GLwinShaderHandle RegisterVariant(const char* vertexPath, const char* fragmentPath,
+		const std::vector<std::string>& defines, const char* geometryPath = nullptr);
+	static Shader* Get(GLwinShaderHandle handle);
+	// Bumped every time a new program is swapped in; re-resolve Uniform<T> handles when it changes
+	static uint32_t GetVersion(GLwinShaderHandle handle);
+
+	// Watch a directory and rebuild registered programs whose files change.
+	// Files are re-read on the watcher thread; a failed rebuild keeps the running program.
+	static bool EnableHotReload(const std::string& directory);
+	static void DisableHotReload();
+
+	// Point the program's GLwinFrame block at GLWIN_FRAME_BLOCK_BINDING (no-op if it doesn't use it)
+	static void BindFrameBlock(Shader* shader);
+
+	// Where program binaries are kept (default "ShaderCache"). Call before SetUpShaders.
+	// Refused (returns false) while hot reload runs: the watcher thread uses the cache.
+	static bool SetProgramCacheDirectory(const std::string& directory);
+	// Created on first use, needs a current GL context
+	static GLwinProgramCache* GetProgramCache();
+	static GLwinShaderCompiler* GetCompiler();
+	// Expands #include / defines for every program the manager builds
+	static GLwinShaderPreprocessor& GetPreprocessor() { return preprocessor; }
+
 	static Shader* defaultShader;
-};
\ No newline at end of file
+	static GLwinShaderHandle defaultShaderHandle;
+	// Instanced GUI quads sampling the image atlas (GLwinImageBatch)
+	static Shader* imageShader;
+	static GLwinShaderHandle imageShaderHandle;
+
+private:
+	struct Sources {
+		std::string vertex, fragment, geometry;
+		std::vector<std::string> files;      // every file read, includes too
+		uint64_t key = 0;
+		bool ok = false;
+	};
+	struct Entry {
+		std::string paths[3];                // vertex, fragment, geometry (may be empty)
+		std::vector<std::string> defines;
+		std::vector<std::string> files;      // normalised absolute paths this program depends on
+		Shader* shader = nullptr;
+		uint32_t generation = 0;
+		uint32_t version = 0;
+		bool alive = false;
+		bool lazy = false;                   // variant not built yet
+	};
+	struct ReloadRequest {
+		uint32_t index;
+		uint32_t generation;
+		Sources sources;
+	};
+
+	static void ReadSources(const char* vertexPath, const char* fragmentPath, const char* geometryPath,
+		const std::vector<std::string>& defines, Sources& out);
+	// Cache hit: swap in now. Miss: queue on the compiler. target == nullptr allocates a new Shader.
+	static Shader* Build(const Sources& src, const char* name, Shader* target, bool* fromCache = nullptr);
+	static GLwinShaderHandle AddEntry(const char* vertexPath, const char* fragmentPath, const char* geometryPath,
+		const std::vector<std::string>& defines, const std::vector<std::string>& files, Shader* shader, bool lazy);
+	static Entry* FindEntry(GLwinShaderHandle handle);
+	static void OnFilesChanged(const std::vector<std::string>& paths); // watcher thread
+	static void OnBuildComplete(Shader* shader, bool ok, double ms);
+
+	static std::string cacheDirectory;
+	static std::unique_ptr<GLwinProgramCache> programCache;
+	static std::unique_ptr<GLwinShaderCompiler> compiler;
+	static int cacheHits;
+	static int cacheMisses;
+
+	static std::vector<Entry> entries;
+	static std::mutex registryMutex;            // guards entries' paths/files and reloadQueue
+	static std::vector<ReloadRequest> reloadQueue;
+	static GLwinFileWatcher watcher;
+	static GLwinShaderPreprocessor preprocessor;
+};
@@ -0,0 +1,264 @@
+#include "GLwinShaderPreprocessor.h"
+#include "../../GLwin/include/GLwinResource.h"
+#include <filesystem>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+static const int GLWIN_PREPROCESSOR_MAX_DEPTH = 32;
+
+GLwinShaderPreprocessor::GLwinShaderPreprocessor(FileLoader fileLoader)
+    : loader(std::move(fileLoader))
+{
+}
+
+std::string GLwinShaderPreprocessor::NormalisePath(const std::string& path)
+{
+    std::error_code ec;
+    return fs::absolute(path, ec).lexically_normal().string();
+}
+
+uint64_t GLwinShaderPreprocessor::PermutationKey(const std::string& normalisedPath, std::vector<std::string> defines)
+{
+    std::sort(defines.begin(), defines.end());
+    // FNV-1a, with a separator byte so ("AB","C") and ("A","BC") differ
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const std::string& s) {
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        h ^= 0xFF;
+        h *= 1099511628211ull;
+    };
+    mix(normalisedPath);
+    for (const std::string& d : defines) mix(d);
+    return h;
+}
+
+std::string GLwinShaderPreprocessor::StripComments(std::string_view text)
+{
+    std::string out;
+    out.reserve(text.size());
+    size_t i = 0, n = text.size();
+    bool inString = false; // only appears in #include "..."
+    while (i < n) {
+        char c = text[i];
+        if (inString) {
+            out += c;
+            if (c == '"' || c == '\n') inString = false;
+            ++i;
+        }
+        else if (c == '"') {
+            inString = true;
+            out += c;
+            ++i;
+        }
+        else if (c == '/' && i + 1 < n && text[i + 1] == '/') {
+            while (i < n && text[i] != '\n') ++i;
+        }
+        else if (c == '/' && i + 1 < n && text[i + 1] == '*') {
+            i += 2;
+            // a block comment acts as whitespace; keep its newlines for line numbering
+            out += ' ';
+            while (i < n && !(text[i] == '*' && i + 1 < n && text[i + 1] == '/')) {
+                if (text[i] == '\n') out += '\n';
+                ++i;
+            }
+            i = (i < n) ? i + 2 : n;
+        }
+        else {
+            out += c;
+            ++i;
+        }
+    }
+    return out;
+}
+
+const std::string* GLwinShaderPreprocessor::GetParsed(const std::string& path)
+{
+    auto it = parsedFiles.find(path);
+    if (it != parsedFiles.end()) return &it->second;
+    if (loader) {
+        std::string raw;
+        if (!loader(path, raw)) return nullptr;
+        return &parsedFiles.emplace(path, StripComments(raw)).first->second;
+    }
+    // Default: strip straight out of the mapping (or the mounted pack), no intermediate copy
+    GLwinFileView view;
+    if (!GLwinLoadResource(path.c_str(), &view)) return nullptr;
+    const std::string* parsed = &parsedFiles.emplace(path, StripComments(GLwinViewAsString(view))).first->second;
+    GLwinReleaseResource(&view);
+    return parsed;
+}
+
+int GLwinShaderPreprocessor::FileIndex(Result& result, const std::string& path)
+{
+    auto it = std::find(result.files.begin(), result.files.end(), path);
+    if (it != result.files.end()) return (int)(it - result.files.begin());
+    result.files.push_back(path);
+    return (int)result.files.size() - 1;
+}
+
+void GLwinShaderPreprocessor::AppendDefines(const std::vector<std::string>& defines, std::string& out)
+{
+    for (const std::string& d : defines) {
+        size_t eq = d.find('=');
+        out += "#define ";
+        if (eq == std::string::npos) {
+            out += d;
+        }
+        else {
+            out.append(d, 0, eq);
+            out += ' ';
+            out.append(d, eq + 1, std::string::npos);
+        }
+        out += '\n';
+    }
+}
+
+bool GLwinShaderPreprocessor::ExpandFile(const std::string& path, ExpandState& state)
+{
+    Result& result = *state.result;
+    if (state.stack.size() >= (size_t)GLWIN_PREPROCESSOR_MAX_DEPTH) {
+        result.error = "include depth limit reached at " + path;
+        return false;
+    }
+    if (std::find(state.stack.begin(), state.stack.end(), path) != state.stack.end()) {
+        result.error = "include cycle through " + path;
+        return false;
+    }
+    if (state.onceFiles.count(path)) return true;
+
+    const std::string* text = GetParsed(path);
+    if (!text) {
+        result.error = "cannot read " + path;
+        return false;
+    }
+
+    int fileIndex = FileIndex(result, path);
+    bool isRoot = state.stack.empty();
+    state.stack.push_back(path);
+    std::string& out = result.source;
+    const std::string dir = fs::path(path).parent_path().string();
+
+    if (!isRoot) {
+        out += "#line 1 " + std::to_string(fileIndex) + "\n";
+    }
+    // Without a #version line the defines go first
+    else if (text->find("#version") == std::string::npos) {
+        AppendDefines(*state.defines, out);
+        out += "#line 1 " + std::to_string(fileIndex) + "\n";
+        state.versionSeen = true;
+    }
+
+    int lineNumber = 0;
+    size_t pos = 0;
+    while (pos < text->size()) {
+        size_t end = text->find('\n', pos);
+        if (end == std::string::npos) end = text->size();
+        std::string line = text->substr(pos, end - pos);
+        pos = end + 1;
+        ++lineNumber;
+
+        size_t p = line.find_first_not_of(" \t\r");
+        if (p == std::string::npos || line[p] != '#') {
+            out += line;
+            out += '\n';
+            continue;
+        }
+        size_t d = line.find_first_not_of(" \t", p + 1);
+        std::string directive = d == std::string::npos ? std::string() : line.substr(d);
+
+        if (directive.compare(0, 7, "version") == 0) {
+            out += line;
+            out += '\n';
+            if (isRoot && !state.versionSeen) {
+                state.versionSeen = true;
+                AppendDefines(*state.defines, out);
+                out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+            }
+        }
+        else if (directive.compare(0, 7, "include") == 0) {
+            size_t open = directive.find_first_of("\"<");
+            size_t close = open == std::string::npos ? std::string::npos
+                : directive.find(directive[open] == '"' ? '"' : '>', open + 1);
+            if (close == std::string::npos) {
+                result.error = path + ":" + std::to_string(lineNumber) + ": malformed #include";
+                state.stack.pop_back();
+                return false;
+            }
+            std::string name = directive.substr(open + 1, close - open - 1);
+            std::string child = (fs::path(dir) / name).lexically_normal().string();
+            if (!ExpandFile(child, state)) {
+                state.stack.pop_back();
+                return false;
+            }
+            out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+        }
+        else if (directive.compare(0, 6, "pragma") == 0 && directive.find("once") != std::string::npos) {
+            state.onceFiles.insert(path);
+            out += '\n';
+        }
+        else {
+            out += line;
+            out += '\n';
+        }
+    }
+
+    state.stack.pop_back();
+    return true;
+}
+
+GLwinShaderPreprocessor::Result GLwinShaderPreprocessor::Process(const std::string& path, const std::vector<std::string>& defines)
+{
+    std::string root = NormalisePath(path);
+    uint64_t key = PermutationKey(root, defines);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = permutations.find(key);
+    if (it != permutations.end()) return it->second;
+
+    Result result;
+    result.key = key;
+    ExpandState state;
+    state.result = &result;
+    state.defines = &defines;
+    result.ok = ExpandFile(root, state);
+    if (!result.ok) {
+        result.source.clear();
+        return result; // not memoised: the file may be fixed on the next save
+    }
+    return permutations.emplace(key, std::move(result)).first->second;
+}
+
+void GLwinShaderPreprocessor::Invalidate(const std::string& path)
+{
+    std::string file = NormalisePath(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    parsedFiles.erase(file);
+    for (auto it = permutations.begin(); it != permutations.end();) {
+        const std::vector<std::string>& files = it->second.files;
+        if (std::find(files.begin(), files.end(), file) != files.end()) it = permutations.erase(it);
+        else ++it;
+    }
+}
+
+void GLwinShaderPreprocessor::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    parsedFiles.clear();
+    permutations.clear();
+}
+
+size_t GLwinShaderPreprocessor::GetParsedFileCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return parsedFiles.size();
+}
+
+size_t GLwinShaderPreprocessor::GetPermutationCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return permutations.size();
+}
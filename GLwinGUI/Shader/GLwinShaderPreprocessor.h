@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+
+// GLSL preprocessor for GLwinShaderManager (CPU only, no GL calls).
+//  - resolves #include "file" relative to the including file (#pragma once honoured, cycles rejected)
+//  - injects a define set right after #version
+//  - strips comments, keeping line breaks so compiler line numbers still match
+//  - emits #line <n> <file index> around includes; the index refers to Result::files
+// Parsed files are cached once and shared by every permutation; fully expanded sources are
+// memoised by permutation key (root path + sorted defines). Safe to call from several threads.
+class GLwinShaderPreprocessor {
+public:
+    // Reads a whole file. When empty, files are mapped through GLwinLoadResource (mounted pack
+    // first, then the disk); tests can serve sources from memory.
+    using FileLoader = std::function<bool(const std::string& path, std::string& out)>;
+
+    struct Result {
+        bool ok = false;
+        std::string source;              // fully expanded
+        std::vector<std::string> files;  // root first, then includes in order of first use
+        std::string error;
+        uint64_t key = 0;                // permutation key
+    };
+
+    explicit GLwinShaderPreprocessor(FileLoader loader = FileLoader());
+
+    // defines are "NAME" or "NAME=VALUE"; order doesn't matter
+    Result Process(const std::string& path, const std::vector<std::string>& defines = {});
+
+    // Drop a changed file and every permutation that included it (hot reload)
+    void Invalidate(const std::string& path);
+    void Clear();
+
+    // Absolute, lexically normalised form used for every path this class reports
+    static std::string NormalisePath(const std::string& path);
+    static uint64_t PermutationKey(const std::string& normalisedPath, std::vector<std::string> defines);
+    // Remove // and /* */ comments, keeping newlines
+    static std::string StripComments(std::string_view text);
+
+    size_t GetParsedFileCount() const;
+    size_t GetPermutationCount() const;
+
+private:
+    struct ExpandState {
+        Result* result;
+        const std::vector<std::string>* defines;
+        std::vector<std::string> stack;
+        std::unordered_set<std::string> onceFiles;
+        bool versionSeen = false;
+    };
+
+    const std::string* GetParsed(const std::string& path);
+    bool ExpandFile(const std::string& path, ExpandState& state);
+    static void AppendDefines(const std::vector<std::string>& defines, std::string& out);
+    static int FileIndex(Result& result, const std::string& path);
+
+    FileLoader loader;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::string> parsedFiles;  // path -> comment-stripped text
+    std::unordered_map<uint64_t, Result> permutations;
+};
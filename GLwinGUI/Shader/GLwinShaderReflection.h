@@ -0,0 +1,215 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <ostream>
+
+// One active uniform in the default block
+struct GLwinUniformInfo {
+    std::string name;
+    GLint location = -1;
+    GLenum type = 0;
+    GLint size = 0;
+};
+
+// One active vertex attribute
+struct GLwinAttributeInfo {
+    std::string name;
+    GLint location = -1;
+    GLenum type = 0;
+    GLint size = 0;
+};
+
+// One active uniform block and the members that live in it
+struct GLwinUniformBlockInfo {
+    std::string name;
+    GLuint index = GL_INVALID_INDEX;
+    GLint dataSize = 0;
+    GLint binding = 0;
+    struct Member {
+        std::string name;
+        GLenum type = 0;
+        GLint offset = 0;
+        GLint arrayStride = 0;
+        GLint matrixStride = 0;
+    };
+    std::vector<Member> members;
+};
+
+// Everything a linked program exposes, queried once after link.
+// Lookups are binary searches over name-sorted tables, never driver calls.
+class ShaderReflection {
+public:
+    void Reflect(GLuint program)
+    {
+        uniforms.clear();
+        attributes.clear();
+        blocks.clear();
+        if (!program) return;
+        ReflectUniforms(program);
+        ReflectAttributes(program);
+        ReflectBlocks(program);
+    }
+
+    const GLwinUniformInfo* FindUniform(const std::string& name) const { return Find(uniforms, name); }
+    const GLwinAttributeInfo* FindAttribute(const std::string& name) const { return Find(attributes, name); }
+    const GLwinUniformBlockInfo* FindBlock(const std::string& name) const { return Find(blocks, name); }
+
+    GLint GetUniformLocation(const std::string& name) const
+    {
+        const GLwinUniformInfo* u = FindUniform(name);
+        return u ? u->location : -1;
+    }
+
+    const std::vector<GLwinUniformInfo>& GetUniforms() const { return uniforms; }
+    const std::vector<GLwinAttributeInfo>& GetAttributes() const { return attributes; }
+    const std::vector<GLwinUniformBlockInfo>& GetUniformBlocks() const { return blocks; }
+
+    // Human readable listing for tools and debug output
+    void Dump(std::ostream& out) const
+    {
+        for (const auto& a : attributes)
+            out << "attribute " << a.name << " location=" << a.location << " type=0x" << std::hex << a.type << std::dec << "\n";
+        for (const auto& u : uniforms)
+            out << "uniform " << u.name << " location=" << u.location << " type=0x" << std::hex << u.type << std::dec
+                << " size=" << u.size << "\n";
+        for (const auto& b : blocks) {
+            out << "block " << b.name << " index=" << b.index << " binding=" << b.binding << " size=" << b.dataSize << "\n";
+            for (const auto& m : b.members)
+                out << "    " << m.name << " offset=" << m.offset << " type=0x" << std::hex << m.type << std::dec << "\n";
+        }
+    }
+
+private:
+    template <typename T>
+    static const T* Find(const std::vector<T>& table, const std::string& name)
+    {
+        auto it = std::lower_bound(table.begin(), table.end(), name,
+            [](const T& e, const std::string& n) { return e.name < n; });
+        return (it != table.end() && it->name == name) ? &*it : nullptr;
+    }
+
+    template <typename T>
+    static void SortByName(std::vector<T>& table)
+    {
+        std::sort(table.begin(), table.end(), [](const T& a, const T& b) { return a.name < b.name; });
+    }
+
+    static std::string StripArraySuffix(const std::string& name)
+    {
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            return name.substr(0, name.size() - 3);
+        return name;
+    }
+
+    void ReflectUniforms(GLuint program)
+    {
+        GLint count = 0, maxLen = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+        std::vector<char> name(maxLen > 0 ? maxLen : 1);
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+            GLwinUniformInfo info;
+            info.name.assign(name.data(), length);
+            info.location = glGetUniformLocation(program, info.name.c_str());
+            info.type = type;
+            info.size = size;
+            if (info.location < 0) continue; // block members are reported with their block
+            // arrays are reported as "name[0]", make plain "name" and every "name[i]" resolve as well
+            std::string base = StripArraySuffix(info.name);
+            if (base != info.name) {
+                GLwinUniformInfo alias = info;
+                alias.name = base;
+                uniforms.push_back(std::move(alias));
+                for (GLint e = 1; e < size; ++e) {
+                    GLwinUniformInfo element = info;
+                    element.name = base + "[" + std::to_string(e) + "]";
+                    element.location = glGetUniformLocation(program, element.name.c_str());
+                    element.size = size - e; // what is left of the array from here
+                    if (element.location >= 0) uniforms.push_back(std::move(element));
+                }
+            }
+            uniforms.push_back(std::move(info));
+        }
+        SortByName(uniforms);
+    }
+
+    void ReflectAttributes(GLuint program)
+    {
+        GLint count = 0, maxLen = 0;
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLen);
+        std::vector<char> name(maxLen > 0 ? maxLen : 1);
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveAttrib(program, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+            GLwinAttributeInfo info;
+            info.name.assign(name.data(), length);
+            info.location = glGetAttribLocation(program, info.name.c_str());
+            info.type = type;
+            info.size = size;
+            attributes.push_back(std::move(info));
+        }
+        SortByName(attributes);
+    }
+
+    void ReflectBlocks(GLuint program)
+    {
+        GLint count = 0, maxLen = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLen);
+        GLint maxUniformLen = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxUniformLen);
+        std::vector<char> name(maxLen > 0 ? maxLen : 1);
+        std::vector<char> memberName(maxUniformLen > 0 ? maxUniformLen : 1);
+
+        for (GLint i = 0; i < count; ++i) {
+            GLwinUniformBlockInfo block;
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(program, (GLuint)i, (GLsizei)name.size(), &length, name.data());
+            block.name.assign(name.data(), length);
+            block.index = (GLuint)i;
+            glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+            glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+
+            GLint memberCount = 0;
+            glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &memberCount);
+            if (memberCount > 0) {
+                std::vector<GLint> indices(memberCount);
+                glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+                std::vector<GLuint> uindices(indices.begin(), indices.end());
+                std::vector<GLint> types(memberCount), offsets(memberCount), arrayStrides(memberCount), matrixStrides(memberCount);
+                glGetActiveUniformsiv(program, memberCount, uindices.data(), GL_UNIFORM_TYPE, types.data());
+                glGetActiveUniformsiv(program, memberCount, uindices.data(), GL_UNIFORM_OFFSET, offsets.data());
+                glGetActiveUniformsiv(program, memberCount, uindices.data(), GL_UNIFORM_ARRAY_STRIDE, arrayStrides.data());
+                glGetActiveUniformsiv(program, memberCount, uindices.data(), GL_UNIFORM_MATRIX_STRIDE, matrixStrides.data());
+                for (GLint m = 0; m < memberCount; ++m) {
+                    GLwinUniformBlockInfo::Member member;
+                    GLsizei mlen = 0;
+                    glGetActiveUniformName(program, uindices[m], (GLsizei)memberName.size(), &mlen, memberName.data());
+                    member.name.assign(memberName.data(), mlen);
+                    member.type = (GLenum)types[m];
+                    member.offset = offsets[m];
+                    member.arrayStride = arrayStrides[m];
+                    member.matrixStride = matrixStrides[m];
+                    block.members.push_back(std::move(member));
+                }
+                std::sort(block.members.begin(), block.members.end(),
+                    [](const GLwinUniformBlockInfo::Member& a, const GLwinUniformBlockInfo::Member& b) { return a.offset < b.offset; });
+            }
+            blocks.push_back(std::move(block));
+        }
+        SortByName(blocks);
+    }
+
+    std::vector<GLwinUniformInfo> uniforms;
+    std::vector<GLwinAttributeInfo> attributes;
+    std::vector<GLwinUniformBlockInfo> blocks;
+};
@@ -0,0 +1,22 @@
+#version 460
+
+layout (binding = 1) uniform sampler2DArray uImages;
+
+in vec2 vUV;
+flat in vec4 vUVRect;
+flat in int vLayer;
+in vec4 vColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    if (vLayer < 0) {
+        FragColor = vColor;
+        return;
+    }
+    // keep bilinear taps inside the image so neighbours in the atlas never bleed in
+    vec2 halfTexel = 0.5 / vec2(textureSize(uImages, 0).xy);
+    vec2 uv = clamp(vUV, vUVRect.xy + halfTexel, vUVRect.zw - halfTexel);
+    FragColor = texture(uImages, vec3(uv, float(vLayer))) * vColor;
+}
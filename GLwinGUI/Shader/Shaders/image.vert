@@ -0,0 +1,36 @@
+#version 460
+// Instanced GUI quads (GLwinImageBatch). No vertex buffer: corners come from gl_VertexID.
+layout (location = 0) in vec4 aRect;   // x, y, w, h in pixels
+layout (location = 1) in uint aImage;  // row of the image table, 0 = no image
+layout (location = 2) in vec4 aColor;
+
+layout (std140, binding = 0) uniform GLwinFrame {
+    mat4 view;
+    mat4 projection;
+    vec4 viewport;
+    vec4 time;
+};
+
+struct GLwinImageEntry {
+    vec4 uv;     // u0, v0, u1, v1
+    ivec4 info;  // x = layer, -1 while not uploaded
+};
+layout (std430, binding = 1) readonly buffer GLwinImageTable {
+    GLwinImageEntry images[];
+};
+
+out vec2 vUV;
+flat out vec4 vUVRect;
+flat out int vLayer;
+out vec4 vColor;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    GLwinImageEntry img = images[aImage];
+    vUV = mix(img.uv.xy, img.uv.zw, corner);
+    vUVRect = img.uv;
+    vLayer = img.info.x;
+    vColor = aColor;
+    gl_Position = projection * view * vec4(aRect.xy + corner * aRect.zw, 0.0, 1.0);
+}
@@ -1,9 +1,15 @@
 #version 460
 layout (location = 0) in vec3 aPos;
 
+// Per-frame data shared by every GUI shader (GLwinFrameUniforms)
+layout (std140, binding = 0) uniform GLwinFrame {
+    mat4 view;
+    mat4 projection;
+    vec4 viewport;
+    vec4 time;
+};
+
 uniform mat4 model;
-uniform mat4 view;  
-uniform mat4 projection;
 
 void main()
 {
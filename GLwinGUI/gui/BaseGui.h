@@ -14,6 +14,7 @@ public:
     int posX = 0;                  // window position X
     int posY = 0;                  // window position Y
     bool isWinSelected = false;    // selection state
+    bool isHovered = false;        // cursor is over this window (set by the hit grid)
 
     glm::mat4 modelMatrix = glm::mat4(1.0f);
 
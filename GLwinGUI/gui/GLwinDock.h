@@ -0,0 +1,114 @@
+#pragma once
+#include <../vendors/glad/glad.h>
+#include "../vendors/glm/glm.hpp"
+#include "BaseGui.h"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+// Where a dragged panel would land relative to the region under the cursor
+enum class GLwinDockZone { None, Left, Right, Top, Bottom, Center };
+
+// A node in the dock split tree. A region is either a split (two children and a ratio)
+// or a leaf holding a set of tabbed panels.
+struct GLwinDockRegion {
+    bool isSplit = false;
+    bool splitVertical = false;       // true: first on top, second below. false: side by side
+    float ratio = 0.5f;               // share of the first child
+    std::unique_ptr<GLwinDockRegion> first;
+    std::unique_ptr<GLwinDockRegion> second;
+
+    std::vector<BaseGui*> tabs;       // leaf only
+    int activeTab = 0;
+
+    GLwinDockRegion* parent = nullptr;
+    float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f;
+
+    BaseGui* ActivePanel() const {
+        if (tabs.empty()) return nullptr;
+        return tabs[activeTab < (int)tabs.size() ? activeTab : 0];
+    }
+};
+
+// State of an in-progress drag, also what the preview overlay draws
+struct GLwinDockDrag {
+    bool active = false;
+    BaseGui* panel = nullptr;
+    double grabOffsetX = 0.0, grabOffsetY = 0.0; // cursor offset inside the panel when picked up
+    double cursorX = 0.0, cursorY = 0.0;
+    GLwinDockRegion* target = nullptr;
+    GLwinDockZone zone = GLwinDockZone::None;
+    float overlayX = 0.0f, overlayY = 0.0f, overlayW = 0.0f, overlayH = 0.0f;
+
+    // Snapshot of the panel, copied out of the first frame drawn after the drag started
+    bool capturePending = false;
+    GLuint previewTexture = 0;
+    GLuint previewFBO = 0;
+    int previewW = 0, previewH = 0;
+};
+
+// Dockable, tabbable, splittable panel manager.
+// While a panel is dragged it is drawn from a texture copied once out of the framebuffer,
+// so its contents don't have to be re-rendered every frame of the drag.
+class GLwinDockManager {
+public:
+    static const int TabBarHeight = 22;     // at content scale 1
+
+    // DPI scale of the window (GLwinGetContentScale); takes effect at the next Layout
+    void SetContentScale(float scale) { contentScale = scale > 0.0f ? scale : 1.0f; }
+    float GetTabBarHeight() const { return (float)TabBarHeight * contentScale; }
+
+    GLwinDockManager();
+    ~GLwinDockManager();
+
+    // Area the dock tree fills (usually the framebuffer). fbHeight is needed to flip to GL coords.
+    void SetRootRect(float x, float y, float w, float h, int fbHeight);
+
+    // Dock a panel against a region. target == null docks against the root.
+    GLwinDockRegion* DockPanel(BaseGui* panel, GLwinDockRegion* target, GLwinDockZone zone, float ratio = 0.5f);
+    // Take a panel out of the tree, collapsing any split left with one child
+    void UndockPanel(BaseGui* panel);
+    void SetSplitRatio(GLwinDockRegion* split, float ratio);
+    void SetActiveTab(GLwinDockRegion* leaf, int tab);
+
+    GLwinDockRegion* FindPanel(BaseGui* panel) const;
+    GLwinDockRegion* RegionAt(double x, double y) const;
+    GLwinDockRegion* GetRoot() const { return root.get(); }
+
+    // Recompute region rects. `apply` is called for each visible panel with its content rect.
+    void Layout(const std::function<void(BaseGui*, int, int, int, int)>& apply);
+
+    // Drag to dock
+    void BeginDrag(BaseGui* panel, double cursorX, double cursorY);
+    void UpdateDrag(double cursorX, double cursorY);
+    bool EndDrag();      // docks at the previewed zone, returns false if dropped nowhere
+    void CancelDrag();
+    const GLwinDockDrag& GetDrag() const { return drag; }
+    // Take the snapshot BeginDrag asked for, from the framebuffer the panels were just drawn into.
+    // Must run before the swap: the back buffer's contents are undefined after it. RenderGUI
+    // calls this and DrawDragPreview once the windows are drawn.
+    void CapturePendingPreview();
+    // Blit the cached panel snapshot at the cursor and outline the drop zone
+    void DrawDragPreview() const;
+
+    // Compact binary layout blob. Panels are stored by winindex.
+    std::vector<uint8_t> SaveLayout() const;
+    bool LoadLayout(const uint8_t* data, size_t size, const std::function<BaseGui*(int)>& resolvePanel);
+
+private:
+    void LayoutRegion(GLwinDockRegion* r, float x, float y, float w, float h,
+        const std::function<void(BaseGui*, int, int, int, int)>& apply);
+    GLwinDockRegion* FindPanelIn(GLwinDockRegion* r, BaseGui* panel) const;
+    GLwinDockRegion* RegionAtIn(GLwinDockRegion* r, double x, double y) const;
+    void CollapseRegion(GLwinDockRegion* leaf);
+    static GLwinDockZone ZoneFor(const GLwinDockRegion* r, double x, double y);
+    void CapturePreview(BaseGui* panel);
+    void ReleasePreview();
+
+    std::unique_ptr<GLwinDockRegion> root;
+    float rootX = 0.0f, rootY = 0.0f, rootW = 0.0f, rootH = 0.0f;
+    int framebufferHeight = 0;
+    float contentScale = 1.0f;
+    GLwinDockDrag drag;
+};
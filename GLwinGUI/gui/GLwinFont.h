@@ -0,0 +1,135 @@
+#pragma once
+#include <../vendors/glad/glad.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Skyline rectangle packer used to place glyphs in an atlas page
+class GLwinSkylinePacker {
+public:
+    void Reset(int width, int height);
+    // Find room for a w*h rect, returns false if the page is full
+    bool Pack(int w, int h, int* outX, int* outY);
+
+private:
+    struct Segment { int x, y, w; };
+    int FitAt(size_t index, int w, int h) const; // y the rect would sit at, or -1
+    std::vector<Segment> skyline;
+    int width = 0, height = 0;
+};
+
+// Rasterised glyph: where it lives in the atlas and how to place it
+struct GLwinGlyph {
+    uint16_t page = 0;
+    uint16_t x = 0, y = 0, w = 0, h = 0;  // atlas pixels
+    int16_t bearingX = 0, bearingY = 0;   // offset from pen position to top-left of the bitmap
+    float advance = 0.0f;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+};
+
+// Flat open-addressing hash from (font, size, codepoint) to glyph
+class GLwinGlyphTable {
+public:
+    static uint64_t MakeKey(uint16_t font, uint16_t pixelSize, uint32_t codepoint) {
+        return ((uint64_t)font << 48) | ((uint64_t)pixelSize << 32) | codepoint;
+    }
+
+    GLwinGlyph* Find(uint64_t key);
+    GLwinGlyph* Insert(uint64_t key, const GLwinGlyph& glyph);
+    // Drop every glyph stored on a page (used when the page is evicted)
+    void RemovePage(uint16_t page);
+    void Clear();
+    size_t Size() const { return count; }
+
+private:
+    static const uint64_t EmptyKey = ~0ull;
+    static const uint64_t DeletedKey = ~0ull - 1;
+    struct Slot { uint64_t key = EmptyKey; GLwinGlyph glyph; };
+
+    static size_t Hash(uint64_t key) {
+        key ^= key >> 33; key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33; key *= 0xc4ceb9fe1a85ec53ull;
+        key ^= key >> 33;
+        return (size_t)key;
+    }
+    void Grow();
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+    size_t used = 0; // live + deleted, drives rehash
+};
+
+// Glyph atlas cache. Glyphs are rasterised on first use into R8 pages packed with a skyline
+// packer. When every page is full the least recently used page is cleared and reused.
+// Pixels always live on the CPU so the DIB backbuffer path can blend straight from them;
+// GL textures are optional and only receive the dirty region of each page.
+class GLwinFontCache {
+public:
+    explicit GLwinFontCache(int pageSize = 1024, int maxPages = 4, bool useGL = true);
+    ~GLwinFontCache();
+
+    // Load a .ttf/.otf for this process only; faceName is the family name inside the file.
+    // Returns a font id, or -1 on failure.
+    int LoadFont(const wchar_t* path, const wchar_t* faceName);
+    // Same from bytes already in memory (e.g. a GLwinLoadResource view); GDI copies them,
+    // so the buffer can be released as soon as this returns.
+    int LoadFontFromMemory(const void* data, size_t size, const wchar_t* faceName);
+    // Font file through GLwinLoadResource: mounted pack first, then the disk (UTF-8 name)
+    int LoadFontResource(const char* name, const wchar_t* faceName);
+    // Use an installed system font by family name
+    int AddSystemFont(const wchar_t* faceName);
+
+    // Call once per frame so page usage can be tracked for eviction
+    void BeginFrame() { ++frame; }
+
+    // Look up a glyph, rasterising it on a miss. Returns false if the font can't produce it.
+    // (Returned by value: rasterising another glyph may rehash the table or evict a page.)
+    bool GetGlyph(int font, int pixelSize, uint32_t codepoint, GLwinGlyph* out);
+    // Kerning adjustment in pixels between two codepoints (0 if the font has no pair)
+    float GetKerning(int font, int pixelSize, uint32_t left, uint32_t right);
+    // Ascent/descent/line gap for a font size in pixels
+    void GetLineMetrics(int font, int pixelSize, float* ascent, float* descent, float* lineGap);
+
+    // Push dirty page regions to their GL textures (no-op without GL)
+    void UploadDirtyPages();
+    GLuint GetPageTexture(int page) const;
+    const uint8_t* GetPagePixels(int page) const;
+    int GetPageSize() const { return pageSize; }
+
+    // CPU path: blend a glyph into a 32bpp BGRA buffer (as returned by GLwinCreateBackbuffer)
+    void BlitGlyphBGRA(void* pixels, int bufWidth, int bufHeight, int penX, int penY,
+        const GLwinGlyph& glyph, uint32_t colorBGRA) const;
+
+private:
+    struct Page {
+        std::vector<uint8_t> pixels;
+        GLwinSkylinePacker packer;
+        uint64_t lastUsedFrame = 0;
+        GLuint texture = 0;
+        int dirtyX0 = 0, dirtyY0 = 0, dirtyX1 = 0, dirtyY1 = 0; // empty when x0 >= x1
+    };
+    struct FontFace {
+        std::wstring faceName;
+        std::wstring path;                                   // empty for system and memory fonts
+        void* memoryHandle = nullptr;                        // AddFontMemResourceEx handle
+        std::vector<std::pair<uint16_t, void*>> sizes;       // pixel size -> HFONT
+        std::vector<std::pair<uint64_t, float>> kerning;     // per size, sorted (size<<42|left<<21|right)
+        std::vector<uint16_t> kerningLoaded;                 // sizes whose kerning table was read
+    };
+
+    void* FontHandle(int font, int pixelSize);
+    bool Rasterize(int font, int pixelSize, uint32_t codepoint, GLwinGlyph& out);
+    bool Allocate(int w, int h, uint16_t* page, int* x, int* y);
+    int EvictPage();
+    void MarkDirty(Page& p, int x, int y, int w, int h);
+
+    int pageSize;
+    int maxPages;
+    bool useGL;
+    uint64_t frame = 1;
+    std::vector<Page> pages;
+    std::vector<FontFace> fonts;
+    GLwinGlyphTable table;
+    void* memDC = nullptr;
+    std::vector<uint8_t> scratch;
+};
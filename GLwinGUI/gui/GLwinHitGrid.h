@@ -0,0 +1,201 @@
+#pragma once
+#include "../vendors/glm/glm.hpp"
+#include "BaseGui.h"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+// Result of a hover update: which gui the cursor entered and which one it left (either may be null)
+struct GLwinHoverEvent {
+    BaseGui* entered = nullptr;
+    BaseGui* left = nullptr;
+};
+
+// Uniform grid used for mouse picking of GUI windows.
+// Every window is bucketed into the cells its rect overlaps, so a cursor query only looks at the
+// handful of windows sharing one cell instead of scanning every BaseGui. Cells are kept sorted
+// by z (topmost first) so the first rect that contains the point is the hit.
+class GLwinHitGrid {
+public:
+    explicit GLwinHitGrid(int cellSize = 128) : cellSize(cellSize > 0 ? cellSize : 128) {}
+
+    // Add a gui to the grid with the given z order (higher is on top)
+    void Insert(BaseGui* gui, int z) {
+        if (!gui || items.count(gui)) return;
+        Item item;
+        item.gui = gui;
+        item.z = z;
+        ReadRect(gui, item);
+        items[gui] = item;
+        AddToCells(item);
+    }
+
+    void Remove(BaseGui* gui) {
+        auto it = items.find(gui);
+        if (it == items.end()) return;
+        RemoveFromCells(it->second);
+        items.erase(it);
+        if (hovered == gui) hovered = nullptr;
+    }
+
+    // Call after posX/posY/width/height change. Only re-buckets when the rect actually moved.
+    // Returns true if the grid was touched.
+    bool Update(BaseGui* gui) {
+        auto it = items.find(gui);
+        if (it == items.end()) return false;
+        Item& item = it->second;
+        if (item.x == gui->posX && item.y == gui->posY && item.w == gui->width && item.h == gui->height)
+            return false;
+
+        int oldX0 = item.cx0, oldY0 = item.cy0, oldX1 = item.cx1, oldY1 = item.cy1;
+        Item old = item;
+        ReadRect(gui, item);
+        if (oldX0 == item.cx0 && oldY0 == item.cy0 && oldX1 == item.cx1 && oldY1 == item.cy1) {
+            // Same cells, just refresh the cached rect in place
+            ForEachCell(item, [&](std::vector<Cell>& cell) {
+                for (Cell& c : cell) {
+                    if (c.gui == gui) { c.x = item.x; c.y = item.y; c.w = item.w; c.h = item.h; break; }
+                }
+            });
+            return true;
+        }
+        RemoveFromCells(old);
+        AddToCells(item);
+        return true;
+    }
+
+    // Change the stacking order of a gui (e.g. when it's clicked and brought to front)
+    void SetZOrder(BaseGui* gui, int z) {
+        auto it = items.find(gui);
+        if (it == items.end() || it->second.z == z) return;
+        it->second.z = z;
+        ForEachCell(it->second, [&](std::vector<Cell>& cell) {
+            for (Cell& c : cell) {
+                if (c.gui == gui) { c.z = z; break; }
+            }
+            SortCell(cell);
+        });
+    }
+
+    // z given at Insert/SetZOrder, 0 for a gui that isn't in the grid
+    int GetZOrder(BaseGui* gui) const {
+        auto it = items.find(gui);
+        return it == items.end() ? 0 : it->second.z;
+    }
+
+    // Topmost gui under the point, or null
+    BaseGui* Pick(double x, double y) const {
+        int px = (int)std::floor(x);
+        int py = (int)std::floor(y);
+        auto it = cells.find(CellKey(CellCoord(px), CellCoord(py)));
+        if (it == cells.end()) return nullptr;
+        for (const Cell& c : it->second) {
+            if (px >= c.x && px < c.x + c.w && py >= c.y && py < c.y + c.h)
+                return c.gui;
+        }
+        return nullptr;
+    }
+
+    // Pick and track hover transitions in one go. Cheap enough to call on every mouse move.
+    GLwinHoverEvent UpdateHover(double x, double y) {
+        GLwinHoverEvent ev;
+        BaseGui* hit = Pick(x, y);
+        if (hit == hovered) return ev;
+        ev.left = hovered;
+        ev.entered = hit;
+        hovered = hit;
+        return ev;
+    }
+
+    BaseGui* GetHovered() const { return hovered; }
+
+    void Clear() {
+        items.clear();
+        cells.clear();
+        hovered = nullptr;
+    }
+
+private:
+    struct Item {
+        BaseGui* gui = nullptr;
+        int x = 0, y = 0, w = 0, h = 0;
+        int z = 0;
+        int cx0 = 0, cy0 = 0, cx1 = -1, cy1 = -1; // covered cell range (inclusive)
+    };
+    // Copy of the rect stored per cell so picking never chases the BaseGui pointer
+    struct Cell {
+        BaseGui* gui;
+        int x, y, w, h;
+        int z;
+    };
+
+    int CellCoord(int v) const {
+        return v >= 0 ? v / cellSize : -((-v + cellSize - 1) / cellSize);
+    }
+
+    static uint64_t CellKey(int cx, int cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+
+    void ReadRect(BaseGui* gui, Item& item) const {
+        item.x = gui->posX;
+        item.y = gui->posY;
+        item.w = gui->width;
+        item.h = gui->height;
+        if (item.w <= 0 || item.h <= 0) {
+            // Empty rects can never be hit, keep them out of the cells
+            item.cx0 = 0; item.cy0 = 0; item.cx1 = -1; item.cy1 = -1;
+            return;
+        }
+        item.cx0 = CellCoord(item.x);
+        item.cy0 = CellCoord(item.y);
+        item.cx1 = CellCoord(item.x + item.w - 1);
+        item.cy1 = CellCoord(item.y + item.h - 1);
+    }
+
+    template <typename Fn>
+    void ForEachCell(const Item& item, Fn&& fn) {
+        for (int cy = item.cy0; cy <= item.cy1; ++cy) {
+            for (int cx = item.cx0; cx <= item.cx1; ++cx) {
+                auto it = cells.find(CellKey(cx, cy));
+                if (it != cells.end()) fn(it->second);
+            }
+        }
+    }
+
+    static void SortCell(std::vector<Cell>& cell) {
+        std::stable_sort(cell.begin(), cell.end(), [](const Cell& a, const Cell& b) { return a.z > b.z; });
+    }
+
+    void AddToCells(const Item& item) {
+        Cell c{ item.gui, item.x, item.y, item.w, item.h, item.z };
+        for (int cy = item.cy0; cy <= item.cy1; ++cy) {
+            for (int cx = item.cx0; cx <= item.cx1; ++cx) {
+                std::vector<Cell>& cell = cells[CellKey(cx, cy)];
+                // insert keeping topmost first
+                auto pos = std::find_if(cell.begin(), cell.end(), [&](const Cell& o) { return o.z < c.z; });
+                cell.insert(pos, c);
+            }
+        }
+    }
+
+    void RemoveFromCells(const Item& item) {
+        for (int cy = item.cy0; cy <= item.cy1; ++cy) {
+            for (int cx = item.cx0; cx <= item.cx1; ++cx) {
+                auto it = cells.find(CellKey(cx, cy));
+                if (it == cells.end()) continue;
+                std::vector<Cell>& cell = it->second;
+                cell.erase(std::remove_if(cell.begin(), cell.end(),
+                    [&](const Cell& c) { return c.gui == item.gui; }), cell.end());
+                if (cell.empty()) cells.erase(it);
+            }
+        }
+    }
+
+    int cellSize;
+    std::unordered_map<BaseGui*, Item> items;
+    std::unordered_map<uint64_t, std::vector<Cell>> cells;
+    BaseGui* hovered = nullptr;
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include <../vendors/glad/glad.h>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+
+class Shader;
+
+// Binding points used by the image shaders (see Shader/Shaders/image.vert/.frag)
+#define GLWIN_IMAGE_TABLE_BINDING 1   // std430 buffer GLwinImageTable
+#define GLWIN_IMAGE_TEXTURE_UNIT 1    // sampler2DArray with every atlas layer
+
+// Image 0 is reserved: it has no texture, so an instance using it draws a flat colour quad
+#define GLWIN_IMAGE_NONE 0u
+
+// One row of the image table, std430 layout: uv rect in the array texture and its layer.
+// layer is -1 until the pixels have been uploaded, which also draws as a flat colour.
+struct GLwinImageEntry {
+    float u0, v0, u1, v1;
+    int32_t layer;
+    int32_t pad[3];
+};
+static_assert(sizeof(GLwinImageEntry) == 32, "GLwinImageEntry must match the std430 layout");
+
+// Small images (icons, thumbnails) packed into an RGBA8 GL_TEXTURE_2D_ARRAY.
+// Each layer keeps a free list of rectangles: allocation takes the best fit and splits it,
+// removal puts the rect back and merges it with free neighbours, so icons can come and go
+// without fragmenting the atlas. Layers are added on demand (the texture is regrown by copying
+// when it runs out) up to maxLayers.
+// Pixels are queued on AddImage and streamed through a ring of persistently mapped PBO slices,
+// at most uploadBudget bytes per frame, so a burst of new thumbnails never causes a hitch.
+class GLwinImageAtlas {
+public:
+    explicit GLwinImageAtlas(int layerSize = 1024, int maxLayers = 16, size_t uploadBudget = 1 << 20, int uploadSlices = 3);
+    ~GLwinImageAtlas();
+
+    GLwinImageAtlas(const GLwinImageAtlas&) = delete;
+    GLwinImageAtlas& operator=(const GLwinImageAtlas&) = delete;
+
+    // Reserve room and queue tightly packed RGBA8 pixels (copied). Returns the image index to put in
+    // GLwinImageInstance::image, or GLWIN_IMAGE_NONE if it doesn't fit. Indices are reused after
+    // RemoveImage, so drop every reference before removing.
+    uint32_t AddImage(const void* rgba, int width, int height);
+    void RemoveImage(uint32_t image);
+    // True once the pixels are on the GPU
+    bool IsReady(uint32_t image) const;
+    bool GetImageSize(uint32_t image, int* width, int* height) const;
+
+    // Once per frame, before drawing: stream queued pixels (up to the budget) and push table changes
+    void Upload();
+    // Bind the array texture and the image table for the image shaders
+    void Bind();
+
+    GLuint GetTexture() const { return texture; }
+    int GetLayerSize() const { return layerSize; }
+    int GetLayerCount() const { return (int)layers.size(); }
+    size_t GetPendingBytes() const { return pendingBytes; }
+
+private:
+    struct Rect { int x, y, w, h; };
+    struct Layer {
+        std::vector<Rect> freeRects;
+        int usedArea = 0;
+    };
+    struct Image {
+        int layer = -1;
+        Rect rect{ 0, 0, 0, 0 };
+        uint32_t serial = 0;   // tells a pending upload apart from a later image in the same slot
+        bool alive = false;
+        bool ready = false;
+    };
+    struct PendingUpload {
+        uint32_t image;
+        uint32_t serial;
+        std::vector<uint8_t> pixels;
+        int rowsDone = 0;
+    };
+
+    bool Allocate(int w, int h, int* layer, Rect* out);
+    void Release(int layer, const Rect& r);
+    bool AddLayer();
+    bool EnsureTextureLayers(int count);
+    void WriteEntry(uint32_t image);
+    void WaitForSlice(int slice);
+
+    int layerSize;
+    int maxLayers;
+    size_t uploadBudget;
+    int sliceCount;
+
+    GLuint texture = 0;
+    int textureLayers = 0;        // allocated layers in the GL texture (>= layers.size())
+    std::vector<Layer> layers;
+
+    std::vector<Image> images;
+    std::vector<uint32_t> freeImages;
+    uint32_t nextSerial = 1;
+
+    std::vector<GLwinImageEntry> table;
+    GLuint tableBuffer = 0;
+    size_t tableCapacity = 0;     // entries
+    size_t dirtyBegin = 0, dirtyEnd = 0;
+
+    std::deque<PendingUpload> pending;
+    size_t pendingBytes = 0;
+    GLuint pbo = 0;
+    unsigned char* pboMapped = nullptr;
+    GLsync fences[8] = {};
+    int slice = 0;
+};
+
+// Per-instance data of a GUI quad: pixel rect, image index and tint (0xAABBGGRR)
+struct GLwinImageInstance {
+    float x, y, w, h;
+    uint32_t image;
+    uint32_t color;
+};
+static_assert(sizeof(GLwinImageInstance) == 24, "GLwinImageInstance is uploaded as is");
+
+// Collects textured and flat quads for a frame and draws them with one instanced call per
+// buffer-full. Every image shares the same array texture and the UVs are looked up by index in
+// the shader, so differently textured widgets don't break the batch.
+// A quad can be tied to an owner (the GUI window it belongs to): FlushOwner draws just that
+// window's quads, so they can go out right after the window and stay under the ones in front.
+class GLwinImageBatch {
+public:
+    explicit GLwinImageBatch(size_t maxInstances = 4096);
+    ~GLwinImageBatch();
+
+    GLwinImageBatch(const GLwinImageBatch&) = delete;
+    GLwinImageBatch& operator=(const GLwinImageBatch&) = delete;
+
+    void Add(const GLwinImageInstance& instance, const void* owner = nullptr) {
+        instances.push_back(instance);
+        owners.push_back(owner);
+    }
+    void Add(float x, float y, float w, float h, uint32_t image, uint32_t color = 0xFFFFFFFFu, const void* owner = nullptr) {
+        Add({ x, y, w, h, image, color }, owner);
+    }
+    size_t GetCount() const { return instances.size(); }
+    void Clear() { instances.clear(); owners.clear(); }
+
+    // Draw and clear the quads added with this owner, keeping the rest in order
+    void FlushOwner(GLwinImageAtlas& atlas, Shader* shader, const void* owner);
+    // Draw and clear everything still queued. shader is the image program
+    // (GLwinShaderManager::imageShader); nothing is drawn without one.
+    // GetLastDrawCalls counts the FlushOwner calls since the previous Flush as well.
+    void Flush(GLwinImageAtlas& atlas, Shader* shader);
+    int GetLastDrawCalls() const { return lastDrawCalls; }
+
+private:
+    int Draw(GLwinImageAtlas& atlas, Shader* shader, const GLwinImageInstance* data, size_t total);
+
+    std::vector<GLwinImageInstance> instances;
+    std::vector<const void*> owners;            // parallel to instances
+    std::vector<GLwinImageInstance> ownerScratch;
+    size_t capacity;
+    GLuint vao = 0;
+    GLuint instanceBuffer = 0;
+    int ownerDrawCalls = 0;
+    int lastDrawCalls = 0;
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include "../vendors/glm/glm.hpp"
+#include "BaseGui.h"
+#include <vector>
+#include <memory>
+
+// How a node places its children
+enum class GLwinLayoutType {
+    Row,     // children side by side along X
+    Column,  // children stacked along Y
+    Stack,   // children on top of each other, each gets the full rect
+    Dock     // children docked to an edge in order, GLwinDock::Fill takes what is left
+};
+
+enum class GLwinDock { Left, Top, Right, Bottom, Fill };
+
+// Size spec for one axis
+struct GLwinLayoutSize {
+    enum Unit { Auto, Pixels, Percent, Flex };
+    Unit unit = Auto;
+    float value = 0.0f;   // pixels, percent of parent (0..100) or flex weight
+
+    static GLwinLayoutSize Px(float v) { return { Pixels, v }; }
+    static GLwinLayoutSize Pct(float v) { return { Percent, v }; }
+    static GLwinLayoutSize Grow(float weight = 1.0f) { return { Flex, weight }; }
+};
+
+enum GLwinLayoutAxis { GLWIN_AXIS_X = 0, GLWIN_AXIS_Y = 1 };
+
+// A node in the layout tree. Leaves usually carry a BaseGui that receives the arranged rect.
+// Measured sizes are cached per axis and only thrown away when a setter changes content or
+// constraints on this node or one of its children; arranging skips any subtree whose rect
+// didn't change, so a resize only walks the nodes that actually move.
+class GLwinLayoutNode {
+public:
+    explicit GLwinLayoutNode(GLwinLayoutType type = GLwinLayoutType::Column, BaseGui* gui = nullptr)
+        : type(type), gui(gui) {}
+
+    GLwinLayoutNode* AddChild(std::unique_ptr<GLwinLayoutNode> child);
+    GLwinLayoutNode* AddChild(GLwinLayoutType childType, BaseGui* childGui = nullptr);
+    void RemoveChild(GLwinLayoutNode* child);
+
+    // Setters invalidate only what they affect
+    void SetType(GLwinLayoutType t);
+    void SetSize(int axis, GLwinLayoutSize s);
+    void SetMinSize(int axis, float v);
+    void SetMaxSize(int axis, float v);
+    void SetContentSize(float w, float h); // intrinsic size of a leaf (text, image, ...)
+    void SetPadding(float p);
+    void SetGap(float g);
+    void SetDock(GLwinDock d);
+    // The gui gets this node's rect at the next Arrange, even if the rect itself doesn't change
+    void SetGui(BaseGui* g);
+
+    // Intrinsic size along an axis (cached)
+    float Measure(int axis);
+
+    // Lay out this subtree into the given rect. Nodes whose rect changed are appended to `changed`.
+    void Arrange(float x, float y, float w, float h, std::vector<GLwinLayoutNode*>* changed = nullptr);
+
+    GLwinLayoutType GetType() const { return type; }
+    BaseGui* GetGui() const { return gui; }
+    GLwinLayoutNode* GetParent() const { return parent; }
+    const std::vector<std::unique_ptr<GLwinLayoutNode>>& GetChildren() const { return children; }
+
+    // Arranged rect in pixels
+    float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f;
+
+private:
+    void MarkDirty(int axis);
+    void MarkDirtyBothAxes() { MarkDirty(GLWIN_AXIS_X); MarkDirty(GLWIN_AXIS_Y); }
+    float ComputeMeasure(int axis);
+    float Clamp(int axis, float v) const;
+    float Resolve(int axis, float parentSize, float stretch);
+    void ArrangeLinear(int mainAxis, float ix, float iy, float iw, float ih, std::vector<GLwinLayoutNode*>* changed);
+    void ArrangeDock(float ix, float iy, float iw, float ih, std::vector<GLwinLayoutNode*>* changed);
+
+    GLwinLayoutType type;
+    BaseGui* gui;
+    GLwinLayoutNode* parent = nullptr;
+    std::vector<std::unique_ptr<GLwinLayoutNode>> children;
+
+    GLwinLayoutSize size[2];
+    float minSize[2] = { 0.0f, 0.0f };
+    float maxSize[2] = { 1.0e9f, 1.0e9f };
+    float contentSize[2] = { 0.0f, 0.0f };
+    float padding = 0.0f;
+    float gap = 0.0f;
+    GLwinDock dock = GLwinDock::Fill;
+
+    // caches
+    float measured[2] = { 0.0f, 0.0f };
+    bool measureValid[2] = { false, false };
+    bool arrangeValid = false;
+    bool rectPending = false;   // gui attached since the last Arrange: report the node as changed
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include "GLwinFont.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <list>
+#include <cstdint>
+
+// Decode one UTF-8 sequence starting at text[i]; advances i. Invalid bytes decode to U+FFFD.
+uint32_t GLwinDecodeUtf8(const char* text, size_t length, size_t& i);
+
+// A positioned glyph inside a shaped line (x relative to its row). Only the layout is kept: the
+// atlas page and UVs change whenever the font cache evicts a page, so fetch those with
+// GLwinTextShaper::GetGlyph when drawing.
+struct GLwinShapedGlyph {
+    uint32_t codepoint;   // what was placed ('?' when the font lacks the original)
+    float x;
+    float advance;
+};
+
+// One visual row produced by line breaking
+struct GLwinShapedRow {
+    uint32_t firstGlyph = 0;
+    uint32_t glyphCount = 0;
+    float width = 0.0f;
+};
+
+// A logical line shaped into glyph runs and wrapped into rows
+struct GLwinShapedLine {
+    std::vector<GLwinShapedGlyph> glyphs;
+    std::vector<GLwinShapedRow> rows;
+};
+
+// Shapes UTF-8 lines (kerning + greedy word wrap) and caches the result by content, so a line
+// that's scrolled back into view, or repeated, is not shaped again.
+class GLwinTextShaper {
+public:
+    GLwinTextShaper(GLwinFontCache* fonts, int font, int pixelSize, size_t cacheCapacity = 4096);
+
+    // wrapWidth <= 0 disables wrapping
+    const GLwinShapedLine& Shape(const char* text, size_t length, float wrapWidth);
+    // Rows the line wraps into; shapes into scratch space on a miss instead of filling the cache
+    uint32_t CountRows(const char* text, size_t length, float wrapWidth);
+    // Atlas glyph to draw a shaped glyph with (rasterised again if its page was evicted)
+    bool GetGlyph(const GLwinShapedGlyph& g, GLwinGlyph* out) const {
+        return fonts && fonts->GetGlyph(font, pixelSize, g.codepoint, out);
+    }
+
+    float GetLineHeight() const { return lineHeight; }
+    float GetAscent() const { return ascent; }
+    void Clear();
+
+private:
+    struct Entry {
+        std::string text;           // the hash only narrows the search down
+        float wrapWidth = 0.0f;
+        GLwinShapedLine line;
+        std::list<uint64_t>::iterator lru;
+
+        bool Matches(const char* t, size_t length, float wrap) const {
+            return wrapWidth == wrap && std::string_view(text) == std::string_view(t, length);
+        }
+    };
+    static uint64_t HashLine(const char* text, size_t length, float wrapWidth);
+    void ShapeInto(const char* text, size_t length, float wrapWidth, GLwinShapedLine& out);
+
+    GLwinFontCache* fonts;
+    int font;
+    int pixelSize;
+    float lineHeight = 0.0f;
+    float ascent = 0.0f;
+    size_t capacity;
+    std::unordered_map<uint64_t, Entry> cache;
+    std::list<uint64_t> lru; // front = most recently used
+    GLwinShapedLine scratch; // CountRows misses
+};
+
+// Virtualised view over a large text buffer (log viewer style).
+// Lines are stored as offsets into one contiguous buffer; only the rows inside the viewport are
+// shaped each frame. Without wrapping every line is one row, so finding the first visible line
+// is a division. With wrapping, each line's row count is measured once, on first need, into a
+// prefix sum that scrolling binary searches; the counts are only thrown away when the wrap width
+// changes or the view is cleared.
+class GLwinTextView {
+public:
+    GLwinTextView(GLwinFontCache* fonts, int font, int pixelSize);
+
+    void AppendLine(const char* text, size_t length);
+    void AppendText(const char* text, size_t length); // splits on '\n'
+    void Clear();
+    size_t GetLineCount() const { return lineStart.size(); }
+
+    void SetWrapWidth(float width);      // <= 0 turns wrapping off
+    void SetScroll(float pixelsFromTop) { scrollY = pixelsFromTop < 0.0f ? 0.0f : pixelsFromTop; }
+    float GetScroll() const { return scrollY; }
+    float GetContentHeight();
+
+    // Visit the rows visible in a viewport of the given height.
+    // fn(const GLwinShapedLine&, const GLwinShapedRow&, float rowTopY) with y relative to the viewport.
+    template <typename Fn>
+    void ForEachVisibleRow(float viewportHeight, Fn&& fn);
+
+    GLwinTextShaper& GetShaper() { return shaper; }
+
+private:
+    size_t LineForRow(size_t row);  // wrapped mode
+    size_t RowsBefore(size_t line); // wrapped mode
+    void EnsureRowCounts(size_t upToLine);
+
+    GLwinTextShaper shaper;
+    std::string buffer;
+    std::vector<uint32_t> lineStart;
+    std::vector<uint32_t> lineLength;
+    float wrapWidth = 0.0f;
+    float scrollY = 0.0f;
+
+    // wrapped mode bookkeeping
+    std::vector<uint32_t> rowPrefix; // rowPrefix[i] = rows in lines [0, i)
+    size_t rowCountsValid = 0;       // lines whose row count has been measured
+};
+
+template <typename Fn>
+void GLwinTextView::ForEachVisibleRow(float viewportHeight, Fn&& fn)
+{
+    float lh = shaper.GetLineHeight();
+    if (lh <= 0.0f || lineStart.empty()) return;
+
+    size_t firstRow = (size_t)(scrollY / lh);
+    float y = (float)firstRow * lh - scrollY;
+    size_t line, rowInLine;
+    if (wrapWidth <= 0.0f) {
+        line = firstRow;
+        rowInLine = 0;
+    }
+    else {
+        line = LineForRow(firstRow);
+        if (line >= lineStart.size()) return;
+        rowInLine = firstRow - RowsBefore(line);
+    }
+
+    while (line < lineStart.size() && y < viewportHeight) {
+        const GLwinShapedLine& shaped = shaper.Shape(buffer.data() + lineStart[line], lineLength[line], wrapWidth);
+        for (size_t r = rowInLine; r < shaped.rows.size() && y < viewportHeight; ++r) {
+            fn(shaped, shaped.rows[r], y);
+            y += lh;
+        }
+        rowInLine = 0;
+        ++line;
+    }
+}
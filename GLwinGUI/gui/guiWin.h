@@ -1,6 +1,7 @@
 #pragma once
 #include <../vendors/glad/glad.h>
 #include "BaseGui.h"
+#include "../include/GLwinGLState.h"
 
 
 
@@ -26,15 +27,16 @@ public:
             1, 2, 3
         };
 
+        GLwinGLState& gl = GLwinGLState::Get();
         glGenVertexArrays(1, &VAO);
-        glBindVertexArray(VAO);
+        gl.BindVertexArray(VAO);
 
         glGenBuffers(1, &VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        gl.BindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
         glGenBuffers(1, &EBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
         // Vertex positions
@@ -43,16 +45,20 @@ public:
     }
 
         ~BasewinGUI() {
+            GLwinGLState& gl = GLwinGLState::Get();
+            gl.ForgetVertexArray(VAO);
+            gl.ForgetBuffer(VBO);
+            gl.ForgetBuffer(EBO);
             glDeleteVertexArrays(1, &VAO);
             glDeleteBuffers(1, &VBO);
+            glDeleteBuffers(1, &EBO);
         }
 
         void DrawGuiWindow() { // Draw all GUI windows
 			// Use a simple shader program for rendering (you need to create and compile this shader)
-            glBindVertexArray(VAO);
+            // no unbind afterwards: the state cache skips the rebind when the next window shares state
+            GLwinGLState::Get().BindVertexArray(VAO);
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); // using indices
-            glBindVertexArray(0);
-            //glUseProgram(0);
 
         }
 
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+// Watches a directory tree on a background thread and reports files that were written,
+// created or renamed into place. Bursts of events (editors often save via temp file + rename,
+// or write in several chunks) are coalesced, so each changed path is reported once per burst.
+// If the OS drops events (its change buffer overflowed), every file in the tree is reported.
+// Win32 uses ReadDirectoryChangesW, other platforms inotify.
+class GLwinFileWatcher {
+public:
+    // Runs on the watcher thread. Paths are absolute and lexically normalised.
+    using Callback = std::function<void(const std::vector<std::string>& changedPaths)>;
+
+    GLwinFileWatcher() = default;
+    ~GLwinFileWatcher();
+
+    GLwinFileWatcher(const GLwinFileWatcher&) = delete;
+    GLwinFileWatcher& operator=(const GLwinFileWatcher&) = delete;
+
+    bool Start(const std::string& directory, Callback callback);
+    void Stop();
+    bool IsRunning() const { return running; }
+    const std::string& GetDirectory() const { return directory; }
+
+    // How long to keep collecting after the first event of a burst
+    static const int CoalesceMilliseconds = 50;
+
+private:
+    void Run();
+
+    std::string directory;
+    Callback callback;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    void* dirHandle = nullptr;   // Win32 directory handle
+    void* stopEvent = nullptr;   // Win32 event
+    int notifyFd = -1;           // inotify descriptor
+    int stopPipe[2] = { -1, -1 };
+};
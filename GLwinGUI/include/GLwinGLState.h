@@ -0,0 +1,107 @@
+#pragma once
+#include <../vendors/glad/glad.h>
+#include <cstdint>
+
+// GL entry points the state cache forwards to. Defaults to the glad pointers; tests or tools can
+// install their own table (e.g. a mock that records calls) with GLwinGLState::SetFunctions.
+struct GLwinGLFunctions {
+    PFNGLUSEPROGRAMPROC         UseProgram = nullptr;
+    PFNGLBINDVERTEXARRAYPROC    BindVertexArray = nullptr;
+    PFNGLBINDBUFFERPROC         BindBuffer = nullptr;
+    PFNGLBINDBUFFERRANGEPROC    BindBufferRange = nullptr;
+    PFNGLACTIVETEXTUREPROC      ActiveTexture = nullptr;
+    PFNGLBINDTEXTUREPROC        BindTexture = nullptr;
+    PFNGLENABLEPROC             Enable = nullptr;
+    PFNGLDISABLEPROC            Disable = nullptr;
+    PFNGLBLENDFUNCSEPARATEPROC  BlendFuncSeparate = nullptr;
+    PFNGLSCISSORPROC            Scissor = nullptr;
+    PFNGLVIEWPORTPROC           Viewport = nullptr;
+    // Identifies the context current on the calling thread; the cache starts over whenever it
+    // changes. Null: never checked (the owner calls Reset itself).
+    void* (*GetCurrentContext)() = nullptr;
+};
+
+// Fill a table from the loaded glad pointers (call after gladLoadGL), with
+// GLwinGetCurrentNativeContext to detect context switches
+GLwinGLFunctions GLwinGLFunctionsFromGlad();
+
+// Shadow copy of the GL binding state GLwinGUI touches. Calls that would not change anything
+// are dropped before they reach the driver. One instance per thread, tracking the context current
+// on it: making another context current (GLwinMakeContextCurrent, an offscreen context, or any
+// other API) resets the cache at the next Get, so binds are never skipped on the wrong context.
+// Raw GL calls outside the cache aren't seen: GLwinGUI::RenderGUI resets at the start of each
+// frame and unbinds its VAO at the end, so app code only has to keep raw binds out of the GUI's
+// own frame.
+class GLwinGLState {
+public:
+    struct Stats {
+        uint32_t issued = 0;  // calls forwarded to GL
+        uint32_t elided = 0;  // calls dropped as redundant
+    };
+
+    static GLwinGLState& Get();
+
+    void SetFunctions(const GLwinGLFunctions& fns);
+    // Forget everything (after a context switch or third-party GL code). Next calls always go through.
+    void Reset();
+
+    // Per-frame counters
+    void BeginFrame() { frameStats = Stats(); }
+    const Stats& GetFrameStats() const { return frameStats; }
+
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vao);
+    void BindBuffer(GLenum target, GLuint buffer);
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void BindTexture(GLuint unit, GLenum target, GLuint texture);
+    void SetBlend(bool enabled);
+    void BlendFunc(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+    void SetScissorTest(bool enabled);
+    void Scissor(GLint x, GLint y, GLsizei w, GLsizei h);
+    void Viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+
+    // Call before deleting an object so a recycled name isn't mistaken for the cached one
+    void ForgetProgram(GLuint program);
+    void ForgetVertexArray(GLuint vao);
+    void ForgetBuffer(GLuint buffer);
+    void ForgetTexture(GLuint texture);
+
+    GLuint GetProgram() const { return program; }
+    GLuint GetVertexArray() const { return vertexArray; }
+
+private:
+    GLwinGLState();
+
+    static const GLuint Unknown = 0xFFFFFFFFu;
+    static const int MaxTextureUnits = 32;
+    static const int MaxIndexedBindings = 16;
+    enum { BufArray, BufElement, BufUniform, BufPixelUnpack, BufPixelPack, BufCopyRead, BufCopyWrite,
+        BufShaderStorage, BufDrawIndirect, BufCount };
+    enum { TexTarget2D, TexTarget2DArray, TexTargetBuffer, TexTargetCube, TexTarget3D, TexTargetCount };
+    enum TriState : int8_t { StateUnknown = -1, StateOff = 0, StateOn = 1 };
+
+    static int BufferSlot(GLenum target);
+    static int TextureSlot(GLenum target);
+    void SetCap(GLenum cap, bool enabled, TriState& cached);
+    bool Elide() { ++frameStats.elided; return true; }
+    void Issue() { ++frameStats.issued; }
+
+    void CheckContext();
+
+    GLwinGLFunctions gl;
+    Stats frameStats;
+    void* context = nullptr;   // what GetCurrentContext returned when the cache was last valid
+
+    GLuint program = Unknown;
+    GLuint vertexArray = Unknown;
+    GLuint buffers[BufCount];
+    struct IndexedBinding { GLuint buffer; GLintptr offset; GLsizeiptr size; };
+    IndexedBinding uniformBindings[MaxIndexedBindings];
+    GLuint activeUnit = Unknown;
+    GLuint textures[MaxTextureUnits][TexTargetCount];
+    TriState blend = StateUnknown;
+    TriState scissorTest = StateUnknown;
+    GLenum blendFunc[4];
+    GLint scissor[4];
+    GLint viewport[4];
+};
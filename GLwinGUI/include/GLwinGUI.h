@@ -2,8 +2,16 @@
 #include <../vendors/glad/glad.h>
 #include "../vendors/glm/glm.hpp"
 #include "../gui/BaseGui.h"
+#include "../gui/GLwinHitGrid.h"
+#include "../gui/GLwinLayout.h"
+#include "../gui/GLwinDock.h"
+#include "../gui/GLwinFont.h"
+#include "../gui/GLwinImageAtlas.h"
+#include "GLwinGLState.h"
+#include "GLwinGpuTimer.h"
 #include "../Shader/GLwinShader.h"
 #include "../Shader/GLwinShaderManager.h"
+#include "../Shader/GLwinFrameUniforms.h"
 #include <vector>
 #include <memory>
 #include <string>
@@ -30,9 +38,79 @@ public:
     // Set this to true to trigger window creation
     void RequestAddNewWindow() { ShouldAddNewWindow = true; }
 
+    // Mouse picking: topmost GUI window under the cursor (client coords from GLwinGetCursorPos), or null
+    BaseGui* PickGuiWindow(double x, double y) const { return hitGrid.Pick(x, y); }
+    // Feed every mouse move here; updates isHovered and returns the enter/leave transition
+    GLwinHoverEvent UpdateGuiHover(double x, double y);
+    // Move/resize a GUI window, keeps the model matrix and the hit grid in sync. Rects written
+    // straight to posX/posY/width/height are picked up at the next RenderGUI.
+    void SetGuiWindowRect(BaseGui* win, int x, int y, int w, int h);
+    // Put a window on top of the others, for drawing and picking
+    void BringGuiWindowToFront(BaseGui* win);
+    // Take a window out of the hit grid, the layout tree and the dock, then destroy it
+    void RemoveGuiWindow(std::vector<std::unique_ptr<BaseGui>>& guiwWindowsdata, BaseGui* win);
+
+    // Layout tree for docked/arranged windows. Windows not attached to it keep their own rect.
+    GLwinLayoutNode* GetLayoutRoot() { return &layoutRoot; }
+    // Re-run layout for the given framebuffer size; only windows whose rect changed are touched.
+    // Layout sizes are in 96 DPI units and multiplied by the content scale on the way out.
+    void LayoutGuiWindows(int fbWidth, int fbHeight);
+
+    // Docked/tabbed panels
+    GLwinDockManager* GetDockManager() { return &dockManager; }
+    void LayoutDockedWindows(int fbWidth, int fbHeight);
+
+    // Glyph atlas shared by all GUI text (created in Initialize)
+    GLwinFontCache* GetFontCache() { return fontCache.get(); }
+
+    // Icons/thumbnails packed into one array texture, and the batch that draws them.
+    // Pass the owning window to GLwinImageBatch::Add: its quads are drawn right after that window,
+    // in the same z order. Quads added without an owner are drawn after every window, so they sit
+    // on top of all of them and are not clipped to any window.
+    GLwinImageAtlas* GetImageAtlas() { return imageAtlas.get(); }
+    GLwinImageBatch* GetImageBatch() { return imageBatch.get(); }
+
+    // DPI scale of the window (GLwinGetContentScale, and again from its content scale callback).
+    // The next Layout* call re-applies every rect at the new scale.
+    void SetContentScale(float scale);
+    float GetContentScale() const { return contentScale; }
+
+    // Framebuffer size written to the per-frame block (also updated by the Layout* calls)
+    void SetFramebufferSize(int fbWidth, int fbHeight) { framebufferWidth = fbWidth; framebufferHeight = fbHeight; }
+    // Shared view/projection/viewport/time block, bound at GLWIN_FRAME_BLOCK_BINDING (created in Initialize)
+    GLwinFrameUniforms* GetFrameUniforms() { return frameUniforms.get(); }
+
+    // GL calls issued vs dropped by the state cache during the last RenderGUI
+    const GLwinGLState::Stats& GetGLFrameStats() const { return glFrameStats; }
+    // GPU time of the GUI passes while profiling is enabled; read the results through
+    // GLwinProfileGetFrameStats (entries with gpu set) or the "GPU" track of a trace
+    GLwinGpuTimer* GetGpuTimer() { return gpuTimer.get(); }
+
 private:
   
     bool ShouldAddNewWindow = false;
+    GLwinHitGrid hitGrid;
+    int topZOrder = 0;
+    std::vector<BaseGui*> drawOrder;    // rebuilt every frame, bottom to top
+    GLwinLayoutNode layoutRoot{ GLwinLayoutType::Dock };
+    std::vector<GLwinLayoutNode*> layoutChanged;
+    GLwinDockManager dockManager;
+    std::unique_ptr<GLwinFontCache> fontCache;
+    std::unique_ptr<GLwinImageAtlas> imageAtlas;
+    std::unique_ptr<GLwinImageBatch> imageBatch;
+    GLwinGLState::Stats glFrameStats;
+    std::unique_ptr<GLwinFrameUniforms> frameUniforms;
+    std::unique_ptr<GLwinGpuTimer> gpuTimer;
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+    float contentScale = 1.0f;
+    bool contentScaleChanged = false;   // every layout rect needs re-applying
+
+    // Hand a layout node's rect, scaled to pixels, to its GUI window (and its children's, if recursive)
+    void ApplyLayoutRect(GLwinLayoutNode* node, bool recursive);
+
+    static void UpdateModelMatrix(BaseGui* win);
+    static void DetachFromLayout(GLwinLayoutNode* node, BaseGui* win);
 	
 };
 
@@ -0,0 +1,80 @@
+#pragma once
+#include <../vendors/glad/glad.h>
+#include <cstdint>
+
+// Frames a result may take to come back before the frame is skipped instead of waited for
+#define GLWIN_GPU_TIMER_FRAMES 4
+// Zones timed per frame; later ones in the same frame are ignored
+#define GLWIN_GPU_TIMER_MAX_ZONES 32
+
+// GPU time of GUI passes, measured with GL_TIME_ELAPSED queries.
+// Queries live in a ring of GLWIN_GPU_TIMER_FRAMES frames. A frame's results are only read once
+// the driver reports them available, normally one or two frames later, so timing never stalls the
+// pipeline; if the GPU falls a whole ring behind, frames go untimed rather than blocking.
+// Results go to the profiler (GLwinProfileRecordGpu), so they show up in
+// GLwinProfileGetFrameStats next to the CPU zones and on a "GPU" track in the trace. A GL_TIMESTAMP
+// taken with each zone places it on the timeline; without timestamps the zone is drawn where the
+// CPU issued it.
+// Nothing is issued while profiling is disabled. Without timer queries (GL < 3.3, or a driver
+// reporting 0 counter bits) every call is a no-op.
+//
+// Elapsed queries can't nest: a zone begun inside another is folded into the outer one.
+class GLwinGpuTimer {
+public:
+    GLwinGpuTimer();    // needs the GL context current
+    ~GLwinGpuTimer();
+
+    GLwinGpuTimer(const GLwinGpuTimer&) = delete;
+    GLwinGpuTimer& operator=(const GLwinGpuTimer&) = delete;
+
+    bool IsSupported() const { return supported; }
+
+    // Once per frame before the first zone: hands finished frames to the profiler, starts a new one
+    void BeginFrame();
+    // name must outlive the readback (a string literal)
+    void Begin(const char* name);
+    void End();
+
+    // Frames left untimed because their ring slot was still in flight
+    uint32_t GetSkippedFrames() const { return skippedFrames; }
+
+private:
+    struct Zone {
+        const char* name;
+        uint64_t cpuTicks;      // GLwinGetTicks at Begin, used when there are no timestamps
+    };
+    struct Frame {
+        GLuint elapsed[GLWIN_GPU_TIMER_MAX_ZONES];
+        GLuint timestamp[GLWIN_GPU_TIMER_MAX_ZONES];
+        Zone zones[GLWIN_GPU_TIMER_MAX_ZONES];
+        int count = 0;
+        bool pending = false;   // issued, results not read yet
+        int64_t gpuBase = 0;    // GL_TIMESTAMP and GLwinGetTicks read together at BeginFrame
+        uint64_t cpuBase = 0;
+    };
+
+    bool Collect(Frame& frame);
+
+    Frame frames[GLWIN_GPU_TIMER_FRAMES];
+    int current = -1;           // frame being recorded, -1 when this frame isn't timed
+    int next = 0;
+    int depth = 0;              // Begin calls without their End
+    bool open = false;          // an elapsed query is running
+    bool supported = false;
+    bool timestamps = false;
+    bool firstResult = true;    // nothing read back yet since the queries were created
+    uint32_t skippedFrames = 0;
+};
+
+// Times the enclosing scope on the GPU; a null timer does nothing
+class GLwinGpuScope {
+public:
+    GLwinGpuScope(GLwinGpuTimer* timer, const char* name) : timer(timer) { if (timer) timer->Begin(name); }
+    ~GLwinGpuScope() { if (timer) timer->End(); }
+
+    GLwinGpuScope(const GLwinGpuScope&) = delete;
+    GLwinGpuScope& operator=(const GLwinGpuScope&) = delete;
+
+private:
+    GLwinGpuTimer* timer;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <../vendors/glad/glad.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+typedef struct GLWIN_context GLWIN_context;
+
+// A thread with its own GL context for texture/buffer uploads and program builds.
+// Jobs run in submission order on the worker, with its context current. After each job the worker
+// places a fence and flushes; Poll, called on the render thread, hands a job over once its fence
+// has signalled and runs its ready callback there. Poll never waits on the GPU, so the render
+// thread only sees finished objects and doesn't stall on them.
+//
+//   GLwinUploadWorker uploads(GLwinCreateSharedContext(window), "Uploader");
+//   uploads.Submit([=] { glTextureSubImage2D(tex, ...); }, [=] { ready = true; });
+//   ...each frame: uploads.Poll();
+//
+// Jobs may only create shared objects (textures, buffers, programs, samplers); VAOs and FBOs made
+// on the worker are unusable elsewhere. Re-bind an object on the render thread after its ready
+// callback before using it.
+class GLwinUploadWorker {
+public:
+    using Job = std::function<void()>;
+
+    // Takes ownership of context (from GLwinCreateSharedContext/GLwinCreateOffscreenContext, not
+    // current anywhere). The render thread's GL context must be current for Poll and the destructor.
+    explicit GLwinUploadWorker(GLWIN_context* context, const char* name = "Upload");
+    // Runs the jobs already queued, then drops the hand-offs still waiting without calling their
+    // ready callbacks; Finish first to get those.
+    ~GLwinUploadWorker();
+
+    GLwinUploadWorker(const GLwinUploadWorker&) = delete;
+    GLwinUploadWorker& operator=(const GLwinUploadWorker&) = delete;
+
+    // false when the worker context could not be made current; Submit then drops every job
+    bool IsRunning() const { return running; }
+
+    // job runs on the worker, ready (optional) on the thread calling Poll once job's GL work is done
+    void Submit(Job job, Job ready = {});
+
+    // Hand over every job whose fence has signalled, in submission order. Returns how many.
+    int Poll();
+    // Block until every job submitted so far has been handed over
+    void Finish();
+
+    // Jobs submitted and not handed over yet
+    size_t GetPendingCount() const;
+
+private:
+    struct Queued {
+        Job job;
+        Job ready;
+    };
+    struct Done {
+        GLsync fence;
+        Job ready;
+    };
+
+    void Run();
+
+    GLWIN_context* context;
+    std::string name;
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable wake;        // worker: jobs queued or stopping
+    std::condition_variable finished;    // worker started, or a job ran on it
+    std::deque<Queued> jobs;
+    std::deque<Done> done;               // ran on the worker, fence not seen signalled yet
+    size_t pending = 0;
+    bool started = false;
+    bool stopping = false;
+    bool running = false;
+};
@@ -0,0 +1,466 @@
+#include "../gui/GLwinDock.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include "../include/GLwinGLState.h"
+#include <algorithm>
+#include <cstring>
+
+// Layout blob: "GLDK" + u16 version, then the tree in pre-order.
+// split: u8 1, u8 vertical, f32 ratio, first, second
+// leaf : u8 0, u8 activeTab, u16 tabCount, i32 winindex * tabCount
+static const uint8_t GLWIN_DOCK_MAGIC[4] = { 'G', 'L', 'D', 'K' };
+static const uint16_t GLWIN_DOCK_VERSION = 1;
+
+GLwinDockManager::GLwinDockManager()
+    : root(std::make_unique<GLwinDockRegion>())
+{
+}
+
+GLwinDockManager::~GLwinDockManager()
+{
+    ReleasePreview();
+}
+
+void GLwinDockManager::SetRootRect(float x, float y, float w, float h, int fbHeight)
+{
+    rootX = x; rootY = y; rootW = w; rootH = h;
+    framebufferHeight = fbHeight;
+}
+
+// Unique_ptr that owns a region (root or a slot in its parent split)
+static std::unique_ptr<GLwinDockRegion>& OwnerOf(std::unique_ptr<GLwinDockRegion>& root, GLwinDockRegion* r)
+{
+    if (!r->parent) return root;
+    return r->parent->first.get() == r ? r->parent->first : r->parent->second;
+}
+
+GLwinDockRegion* GLwinDockManager::DockPanel(BaseGui* panel, GLwinDockRegion* target, GLwinDockZone zone, float ratio)
+{
+    if (!panel || zone == GLwinDockZone::None) return nullptr;
+    GLwinDockRegion* current = FindPanel(panel);
+    if (current && current == target && current->tabs.size() == 1) return current; // dropped on itself
+    // Undocking the panel's last tab collapses its parent split; the sibling takes its place
+    if (current && current->tabs.size() == 1 && current->parent && target == current->parent) {
+        GLwinDockRegion* split = current->parent;
+        target = split->first.get() == current ? split->second.get() : split->first.get();
+    }
+    UndockPanel(panel);
+    if (!target) target = root.get();
+
+    // An empty tree just takes the panel
+    if (!root->isSplit && root->tabs.empty()) {
+        root->tabs.push_back(panel);
+        root->activeTab = 0;
+        return root.get();
+    }
+
+    if (zone == GLwinDockZone::Center) {
+        while (target->isSplit) target = target->first.get();
+        target->tabs.push_back(panel);
+        target->activeTab = (int)target->tabs.size() - 1;
+        return target;
+    }
+
+    // Replace target with a split holding the old target and a new leaf
+    std::unique_ptr<GLwinDockRegion>& owner = OwnerOf(root, target);
+    GLwinDockRegion* parent = target->parent;
+
+    auto split = std::make_unique<GLwinDockRegion>();
+    split->isSplit = true;
+    split->parent = parent;
+    split->splitVertical = (zone == GLwinDockZone::Top || zone == GLwinDockZone::Bottom);
+
+    auto leaf = std::make_unique<GLwinDockRegion>();
+    leaf->tabs.push_back(panel);
+    leaf->parent = split.get();
+    GLwinDockRegion* leafPtr = leaf.get();
+
+    std::unique_ptr<GLwinDockRegion> old = std::move(owner);
+    old->parent = split.get();
+
+    float share = std::max(0.05f, std::min(0.95f, ratio));
+    if (zone == GLwinDockZone::Left || zone == GLwinDockZone::Top) {
+        split->first = std::move(leaf);
+        split->second = std::move(old);
+        split->ratio = share;
+    }
+    else {
+        split->first = std::move(old);
+        split->second = std::move(leaf);
+        split->ratio = 1.0f - share;
+    }
+    owner = std::move(split);
+    return leafPtr;
+}
+
+void GLwinDockManager::UndockPanel(BaseGui* panel)
+{
+    GLwinDockRegion* leaf = FindPanel(panel);
+    if (!leaf) return;
+    leaf->tabs.erase(std::remove(leaf->tabs.begin(), leaf->tabs.end(), panel), leaf->tabs.end());
+    if (leaf->activeTab >= (int)leaf->tabs.size())
+        leaf->activeTab = leaf->tabs.empty() ? 0 : (int)leaf->tabs.size() - 1;
+    if (leaf->tabs.empty()) CollapseRegion(leaf);
+}
+
+// Remove an empty leaf: its sibling takes the parent split's place
+void GLwinDockManager::CollapseRegion(GLwinDockRegion* leaf)
+{
+    GLwinDockRegion* split = leaf->parent;
+    if (!split) return; // empty root stays as an empty leaf
+
+    std::unique_ptr<GLwinDockRegion> sibling =
+        std::move(split->first.get() == leaf ? split->second : split->first);
+    std::unique_ptr<GLwinDockRegion>& owner = OwnerOf(root, split);
+    sibling->parent = split->parent;
+    owner = std::move(sibling); // destroys the split and the empty leaf
+}
+
+void GLwinDockManager::SetSplitRatio(GLwinDockRegion* split, float ratio)
+{
+    if (!split || !split->isSplit) return;
+    split->ratio = std::max(0.05f, std::min(0.95f, ratio));
+}
+
+void GLwinDockManager::SetActiveTab(GLwinDockRegion* leaf, int tab)
+{
+    if (!leaf || leaf->isSplit || tab < 0 || tab >= (int)leaf->tabs.size()) return;
+    leaf->activeTab = tab;
+}
+
+GLwinDockRegion* GLwinDockManager::FindPanel(BaseGui* panel) const
+{
+    return panel ? FindPanelIn(root.get(), panel) : nullptr;
+}
+
+GLwinDockRegion* GLwinDockManager::FindPanelIn(GLwinDockRegion* r, BaseGui* panel) const
+{
+    if (r->isSplit) {
+        if (GLwinDockRegion* f = FindPanelIn(r->first.get(), panel)) return f;
+        return FindPanelIn(r->second.get(), panel);
+    }
+    return std::find(r->tabs.begin(), r->tabs.end(), panel) != r->tabs.end() ? r : nullptr;
+}
+
+GLwinDockRegion* GLwinDockManager::RegionAt(double x, double y) const
+{
+    return RegionAtIn(root.get(), x, y);
+}
+
+GLwinDockRegion* GLwinDockManager::RegionAtIn(GLwinDockRegion* r, double x, double y) const
+{
+    if (x < r->x || y < r->y || x >= r->x + r->w || y >= r->y + r->h) return nullptr;
+    if (!r->isSplit) return r;
+    if (GLwinDockRegion* f = RegionAtIn(r->first.get(), x, y)) return f;
+    return RegionAtIn(r->second.get(), x, y);
+}
+
+void GLwinDockManager::Layout(const std::function<void(BaseGui*, int, int, int, int)>& apply)
+{
+    LayoutRegion(root.get(), rootX, rootY, rootW, rootH, apply);
+}
+
+void GLwinDockManager::LayoutRegion(GLwinDockRegion* r, float x, float y, float w, float h,
+    const std::function<void(BaseGui*, int, int, int, int)>& apply)
+{
+    r->x = x; r->y = y; r->w = w; r->h = h;
+    if (r->isSplit) {
+        if (r->splitVertical) {
+            float h0 = h * r->ratio;
+            LayoutRegion(r->first.get(), x, y, w, h0, apply);
+            LayoutRegion(r->second.get(), x, y + h0, w, h - h0, apply);
+        }
+        else {
+            float w0 = w * r->ratio;
+            LayoutRegion(r->first.get(), x, y, w0, h, apply);
+            LayoutRegion(r->second.get(), x + w0, y, w - w0, h, apply);
+        }
+        return;
+    }
+
+    // Only the active tab gets a rect; the tab bar sits on top of it
+    BaseGui* active = r->ActivePanel();
+    if (active && apply) {
+        float tabBar = GetTabBarHeight();
+        float contentH = std::max(0.0f, h - tabBar);
+        apply(active, (int)(x + 0.5f), (int)(y + tabBar + 0.5f), (int)(w + 0.5f), (int)(contentH + 0.5f));
+    }
+}
+
+// Edge bands are a quarter of the region, the middle docks as a tab
+GLwinDockZone GLwinDockManager::ZoneFor(const GLwinDockRegion* r, double x, double y)
+{
+    if (!r || r->w <= 0.0f || r->h <= 0.0f) return GLwinDockZone::None;
+    double u = (x - r->x) / r->w;
+    double v = (y - r->y) / r->h;
+    if (u < 0.25) return GLwinDockZone::Left;
+    if (u > 0.75) return GLwinDockZone::Right;
+    if (v < 0.25) return GLwinDockZone::Top;
+    if (v > 0.75) return GLwinDockZone::Bottom;
+    return GLwinDockZone::Center;
+}
+
+void GLwinDockManager::BeginDrag(BaseGui* panel, double cursorX, double cursorY)
+{
+    if (!panel) return;
+    CancelDrag();
+    drag.active = true;
+    drag.panel = panel;
+    drag.grabOffsetX = cursorX - panel->posX;
+    drag.grabOffsetY = cursorY - panel->posY;
+    drag.cursorX = cursorX;
+    drag.cursorY = cursorY;
+    // input is usually handled after the swap, when there is nothing defined to copy from yet
+    drag.capturePending = true;
+}
+
+void GLwinDockManager::UpdateDrag(double cursorX, double cursorY)
+{
+    if (!drag.active) return;
+    drag.cursorX = cursorX;
+    drag.cursorY = cursorY;
+
+    GLwinDockRegion* r = RegionAt(cursorX, cursorY);
+    // Dropping a panel on its own single-tab leaf does nothing
+    if (r && !r->isSplit && r->tabs.size() == 1 && r->tabs[0] == drag.panel) r = nullptr;
+    drag.target = r;
+    drag.zone = ZoneFor(r, cursorX, cursorY);
+
+    if (!r) {
+        drag.overlayW = drag.overlayH = 0.0f;
+        return;
+    }
+    drag.overlayX = r->x; drag.overlayY = r->y;
+    drag.overlayW = r->w; drag.overlayH = r->h;
+    switch (drag.zone) {
+    case GLwinDockZone::Left:   drag.overlayW = r->w * 0.5f; break;
+    case GLwinDockZone::Right:  drag.overlayX += r->w * 0.5f; drag.overlayW = r->w * 0.5f; break;
+    case GLwinDockZone::Top:    drag.overlayH = r->h * 0.5f; break;
+    case GLwinDockZone::Bottom: drag.overlayY += r->h * 0.5f; drag.overlayH = r->h * 0.5f; break;
+    default: break;
+    }
+}
+
+bool GLwinDockManager::EndDrag()
+{
+    if (!drag.active) return false;
+    bool docked = false;
+    if (drag.zone != GLwinDockZone::None) {
+        docked = DockPanel(drag.panel, drag.target, drag.zone) != nullptr;
+    }
+    CancelDrag();
+    return docked;
+}
+
+void GLwinDockManager::CancelDrag()
+{
+    ReleasePreview();
+    drag = GLwinDockDrag();
+}
+
+void GLwinDockManager::CapturePendingPreview()
+{
+    if (!drag.active || !drag.capturePending) return;
+    drag.capturePending = false;
+    CapturePreview(drag.panel);
+}
+
+// Copy the panel's pixels out of the framebuffer being drawn into a texture (GPU to GPU)
+void GLwinDockManager::CapturePreview(BaseGui* panel)
+{
+    int w = panel->width;
+    int h = panel->height;
+    if (w <= 0 || h <= 0 || framebufferHeight <= 0) return;
+
+    glGenTextures(1, &drag.previewTexture);
+    GLwinGLState::Get().BindTexture(0, GL_TEXTURE_2D, drag.previewTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, w, h);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // read from where the GUI was drawn this frame, not whatever happens to be the read framebuffer
+    GLint drawFramebuffer = 0, readFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)drawFramebuffer);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, panel->posX, framebufferHeight - (panel->posY + h), w, h);
+
+    glGenFramebuffers(1, &drag.previewFBO);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, drag.previewFBO);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, drag.previewTexture, 0);
+    if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        GLWIN_LOG_WARNING("Dock drag preview framebuffer incomplete, preview disabled");
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)readFramebuffer);
+        ReleasePreview();
+        return;
+    }
+    // the app may be reading from its own framebuffer
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)readFramebuffer);
+    drag.previewW = w;
+    drag.previewH = h;
+}
+
+void GLwinDockManager::ReleasePreview()
+{
+    if (drag.previewFBO) glDeleteFramebuffers(1, &drag.previewFBO);
+    if (drag.previewTexture) {
+        GLwinGLState::Get().ForgetTexture(drag.previewTexture);
+        glDeleteTextures(1, &drag.previewTexture);
+    }
+    drag.previewFBO = 0;
+    drag.previewTexture = 0;
+    drag.previewW = drag.previewH = 0;
+}
+
+void GLwinDockManager::DrawDragPreview() const
+{
+    if (!drag.active || framebufferHeight <= 0) return;
+
+    // Drop zone outline: four scissored clears, no shader or geometry needed
+    if (drag.overlayW > 0.0f && drag.overlayH > 0.0f) {
+        const int t = 3;
+        int ox = (int)drag.overlayX, oy = framebufferHeight - (int)(drag.overlayY + drag.overlayH);
+        int ow = (int)drag.overlayW, oh = (int)drag.overlayH;
+        GLwinGLState& gl = GLwinGLState::Get();
+        GLfloat clearColor[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        gl.SetScissorTest(true);
+        glClearColor(0.2f, 0.5f, 1.0f, 1.0f);
+        gl.Scissor(ox, oy, ow, t);          glClear(GL_COLOR_BUFFER_BIT);
+        gl.Scissor(ox, oy + oh - t, ow, t); glClear(GL_COLOR_BUFFER_BIT);
+        gl.Scissor(ox, oy, t, oh);          glClear(GL_COLOR_BUFFER_BIT);
+        gl.Scissor(ox + ow - t, oy, t, oh); glClear(GL_COLOR_BUFFER_BIT);
+        gl.SetScissorTest(false);
+        // the app's next glClear must not come out blue
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    }
+
+    // Panel contents from the snapshot taken at BeginDrag
+    if (drag.previewFBO) {
+        int dx = (int)(drag.cursorX - drag.grabOffsetX);
+        int dy = framebufferHeight - ((int)(drag.cursorY - drag.grabOffsetY) + drag.previewH);
+        GLint readFramebuffer = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, drag.previewFBO);
+        glBlitFramebuffer(0, 0, drag.previewW, drag.previewH,
+            dx, dy, dx + drag.previewW, dy + drag.previewH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)readFramebuffer);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Layout serialisation
+// ----------------------------------------------------------------------------
+
+static void DockWrite(std::vector<uint8_t>& out, const void* p, size_t n)
+{
+    const uint8_t* b = static_cast<const uint8_t*>(p);
+    out.insert(out.end(), b, b + n);
+}
+
+static void DockWriteRegion(std::vector<uint8_t>& out, const GLwinDockRegion* r)
+{
+    uint8_t kind = r->isSplit ? 1 : 0;
+    DockWrite(out, &kind, 1);
+    if (r->isSplit) {
+        uint8_t vertical = r->splitVertical ? 1 : 0;
+        DockWrite(out, &vertical, 1);
+        DockWrite(out, &r->ratio, sizeof(float));
+        DockWriteRegion(out, r->first.get());
+        DockWriteRegion(out, r->second.get());
+        return;
+    }
+    uint8_t active = (uint8_t)std::min(r->activeTab, 255);
+    uint16_t count = (uint16_t)r->tabs.size();
+    DockWrite(out, &active, 1);
+    DockWrite(out, &count, sizeof(count));
+    for (BaseGui* tab : r->tabs) {
+        int32_t id = tab->winindex;
+        DockWrite(out, &id, sizeof(id));
+    }
+}
+
+std::vector<uint8_t> GLwinDockManager::SaveLayout() const
+{
+    std::vector<uint8_t> out;
+    DockWrite(out, GLWIN_DOCK_MAGIC, 4);
+    DockWrite(out, &GLWIN_DOCK_VERSION, sizeof(GLWIN_DOCK_VERSION));
+    DockWriteRegion(out, root.get());
+    return out;
+}
+
+struct GLwinDockReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool Read(void* dst, size_t n) {
+        if ((size_t)(end - p) < n) return false;
+        memcpy(dst, p, n);
+        p += n;
+        return true;
+    }
+};
+
+static std::unique_ptr<GLwinDockRegion> DockReadRegion(GLwinDockReader& in, GLwinDockRegion* parent,
+    const std::function<BaseGui*(int)>& resolvePanel, int depth)
+{
+    uint8_t kind = 0;
+    if (depth > 64 || !in.Read(&kind, 1)) return nullptr;
+
+    auto r = std::make_unique<GLwinDockRegion>();
+    r->parent = parent;
+    if (kind == 1) {
+        uint8_t vertical = 0;
+        if (!in.Read(&vertical, 1) || !in.Read(&r->ratio, sizeof(float))) return nullptr;
+        r->isSplit = true;
+        r->splitVertical = vertical != 0;
+        r->first = DockReadRegion(in, r.get(), resolvePanel, depth + 1);
+        if (!r->first) return nullptr;
+        r->second = DockReadRegion(in, r.get(), resolvePanel, depth + 1);
+        if (!r->second) return nullptr;
+        // a side whose panels all went away collapses into the other one
+        auto isEmptyLeaf = [](const GLwinDockRegion* c) { return !c->isSplit && c->tabs.empty(); };
+        if (isEmptyLeaf(r->first.get()) || isEmptyLeaf(r->second.get())) {
+            std::unique_ptr<GLwinDockRegion> keep =
+                std::move(isEmptyLeaf(r->first.get()) ? r->second : r->first);
+            keep->parent = parent;
+            return keep;
+        }
+        return r;
+    }
+
+    uint8_t active = 0;
+    uint16_t count = 0;
+    if (!in.Read(&active, 1) || !in.Read(&count, sizeof(count))) return nullptr;
+    r->tabs.reserve(count);
+    int activeTab = 0;
+    for (uint16_t i = 0; i < count; ++i) {
+        int32_t id = 0;
+        if (!in.Read(&id, sizeof(id))) return nullptr;
+        // panels that no longer exist are skipped; the active tab follows its panel, or falls back
+        // to the nearest surviving tab before it
+        if (BaseGui* panel = resolvePanel ? resolvePanel(id) : nullptr) {
+            if (i <= active) activeTab = (int)r->tabs.size();
+            r->tabs.push_back(panel);
+        }
+    }
+    r->activeTab = activeTab;
+    return r;
+}
+
+bool GLwinDockManager::LoadLayout(const uint8_t* data, size_t size, const std::function<BaseGui*(int)>& resolvePanel)
+{
+    if (!data || size < 6 || memcmp(data, GLWIN_DOCK_MAGIC, 4) != 0) return false;
+    uint16_t version = 0;
+    memcpy(&version, data + 4, sizeof(version));
+    if (version != GLWIN_DOCK_VERSION) {
+        GLWIN_LOG_WARNING("Dock layout version " << version << " not supported");
+        return false;
+    }
+    GLwinDockReader in{ data + 6, data + size };
+    std::unique_ptr<GLwinDockRegion> loaded = DockReadRegion(in, nullptr, resolvePanel, 0);
+    if (!loaded) {
+        GLWIN_LOG_WARNING("Dock layout blob is truncated or corrupt");
+        return false;
+    }
+    CancelDrag();
+    root = std::move(loaded);
+    return true;
+}
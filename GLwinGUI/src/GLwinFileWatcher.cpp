@@ -0,0 +1,227 @@
+#include "../include/GLwinFileWatcher.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include <filesystem>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <unordered_map>
+#endif
+
+namespace fs = std::filesystem;
+
+static void glwin_internal_Flush(std::vector<std::string>& pending, const GLwinFileWatcher::Callback& callback)
+{
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+    callback(pending);
+    pending.clear();
+}
+
+// The OS dropped events (its queue overflowed): any file may have changed, so report them all
+static void glwin_internal_AddAllFiles(const std::string& root, std::vector<std::string>& pending)
+{
+    GLWIN_LOG_WARNING("File watcher lost events under " << root << ", reporting every file as changed");
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec)) pending.push_back(it->path().lexically_normal().string());
+    }
+}
+
+GLwinFileWatcher::~GLwinFileWatcher()
+{
+    Stop();
+}
+
+#ifdef _WIN32
+
+bool GLwinFileWatcher::Start(const std::string& dir, Callback cb)
+{
+    Stop();
+    std::error_code ec;
+    directory = fs::absolute(dir, ec).lexically_normal().string();
+    callback = std::move(cb);
+
+    HANDLE h = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        GLWIN_LOG_WARNING("File watcher could not open " << directory << " (error " << GetLastError() << ")");
+        return false;
+    }
+    dirHandle = h;
+    stopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    running = true;
+    thread = std::thread(&GLwinFileWatcher::Run, this);
+    return true;
+}
+
+void GLwinFileWatcher::Stop()
+{
+    if (!running && !thread.joinable()) return;
+    running = false;
+    if (stopEvent) SetEvent((HANDLE)stopEvent);
+    if (thread.joinable()) thread.join();
+    if (dirHandle) CloseHandle((HANDLE)dirHandle);
+    if (stopEvent) CloseHandle((HANDLE)stopEvent);
+    dirHandle = nullptr;
+    stopEvent = nullptr;
+}
+
+void GLwinFileWatcher::Run()
+{
+    HANDLE dir = (HANDLE)dirHandle;
+    std::vector<DWORD> buffer(8 * 1024); // FILE_NOTIFY_INFORMATION must be DWORD aligned
+    OVERLAPPED ov = {};
+    ov.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+    std::vector<std::string> pending;
+    bool issued = false;
+
+    while (running) {
+        if (!issued) {
+            ResetEvent(ov.hEvent);
+            if (!ReadDirectoryChangesW(dir, buffer.data(), (DWORD)(buffer.size() * sizeof(DWORD)), TRUE, filter, NULL, &ov, NULL)) {
+                GLWIN_LOG_WARNING("ReadDirectoryChangesW failed (error " << GetLastError() << "), file watching stopped");
+                break;
+            }
+            issued = true;
+        }
+
+        // Block until something happens; once a burst has started, wait only for it to go quiet
+        HANDLE handles[2] = { ov.hEvent, (HANDLE)stopEvent };
+        DWORD r = WaitForMultipleObjects(2, handles, FALSE, pending.empty() ? INFINITE : CoalesceMilliseconds);
+        if (r == WAIT_TIMEOUT) {
+            glwin_internal_Flush(pending, callback);
+            continue;
+        }
+        if (r != WAIT_OBJECT_0) break; // stop requested or wait failed
+
+        issued = false;
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(dir, &ov, &bytes, FALSE)) continue;
+        if (bytes == 0) {
+            // the buffer overflowed and the events were thrown away
+            glwin_internal_AddAllFiles(directory, pending);
+            continue;
+        }
+
+        const char* p = reinterpret_cast<const char*>(buffer.data());
+        for (;;) {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED ||
+                info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+                std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                pending.push_back((fs::path(directory) / name).lexically_normal().string());
+            }
+            if (!info->NextEntryOffset) break;
+            p += info->NextEntryOffset;
+        }
+    }
+
+    if (issued) {
+        DWORD bytes = 0;
+        CancelIoEx(dir, &ov);
+        GetOverlappedResult(dir, &ov, &bytes, TRUE);
+    }
+    CloseHandle(ov.hEvent);
+    running = false;
+}
+
+#else
+
+bool GLwinFileWatcher::Start(const std::string& dir, Callback cb)
+{
+    Stop();
+    std::error_code ec;
+    directory = fs::absolute(dir, ec).lexically_normal().string();
+    callback = std::move(cb);
+
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd < 0) {
+        GLWIN_LOG_WARNING("inotify_init1 failed, file watching disabled");
+        return false;
+    }
+    if (pipe(stopPipe) != 0) {
+        close(notifyFd);
+        notifyFd = -1;
+        return false;
+    }
+    running = true;
+    thread = std::thread(&GLwinFileWatcher::Run, this);
+    return true;
+}
+
+void GLwinFileWatcher::Stop()
+{
+    if (!running && !thread.joinable()) return;
+    running = false;
+    if (stopPipe[1] >= 0) {
+        char c = 0;
+        (void)!write(stopPipe[1], &c, 1);
+    }
+    if (thread.joinable()) thread.join();
+    if (notifyFd >= 0) close(notifyFd);
+    for (int& fd : stopPipe) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    notifyFd = -1;
+}
+
+void GLwinFileWatcher::Run()
+{
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    std::unordered_map<int, std::string> watches;
+    auto addTree = [&](const std::string& root) {
+        int wd = inotify_add_watch(notifyFd, root.c_str(), mask);
+        if (wd >= 0) watches[wd] = root;
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_directory(ec)) continue;
+            std::string sub = it->path().lexically_normal().string();
+            wd = inotify_add_watch(notifyFd, sub.c_str(), mask);
+            if (wd >= 0) watches[wd] = sub;
+        }
+    };
+    addTree(directory);
+
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    std::vector<std::string> pending;
+    while (running) {
+        pollfd fds[2] = { { notifyFd, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+        int r = poll(fds, 2, pending.empty() ? -1 : CoalesceMilliseconds);
+        if (r == 0) {
+            glwin_internal_Flush(pending, callback);
+            continue;
+        }
+        if (r < 0 || (fds[1].revents & POLLIN)) break;
+
+        ssize_t len;
+        while ((len = read(notifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + len;) {
+                const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + ev->len;
+                if (ev->mask & IN_Q_OVERFLOW) {
+                    glwin_internal_AddAllFiles(directory, pending);
+                    continue;
+                }
+                auto it = watches.find(ev->wd);
+                if (it == watches.end() || !ev->len) continue;
+                std::string path = (fs::path(it->second) / ev->name).lexically_normal().string();
+                if (ev->mask & IN_ISDIR) {
+                    if (ev->mask & (IN_CREATE | IN_MOVED_TO)) addTree(path);
+                }
+                else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    pending.push_back(path);
+                }
+            }
+        }
+    }
+    running = false;
+}
+
+#endif
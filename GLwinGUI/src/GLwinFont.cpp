@@ -0,0 +1,506 @@
+#include "../gui/GLwinFont.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include "../../GLwin/include/GLwinResource.h"
+#include "../include/GLwinGLState.h"
+#include <windows.h>
+#include <algorithm>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Skyline packer
+// ----------------------------------------------------------------------------
+
+void GLwinSkylinePacker::Reset(int w, int h)
+{
+    width = w;
+    height = h;
+    skyline.clear();
+    skyline.push_back({ 0, 0, w });
+}
+
+int GLwinSkylinePacker::FitAt(size_t index, int w, int h) const
+{
+    int x = skyline[index].x;
+    if (x + w > width) return -1;
+    int y = skyline[index].y;
+    int remaining = w;
+    for (size_t j = index; remaining > 0; ++j) {
+        if (j >= skyline.size()) return -1;
+        y = std::max(y, skyline[j].y);
+        if (y + h > height) return -1;
+        remaining -= skyline[j].w;
+    }
+    return y;
+}
+
+bool GLwinSkylinePacker::Pack(int w, int h, int* outX, int* outY)
+{
+    int bestIndex = -1, bestY = 0, bestTop = height + 1, bestW = width + 1;
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        int y = FitAt(i, w, h);
+        if (y < 0) continue;
+        // lowest top edge wins, narrowest segment breaks ties
+        if (y + h < bestTop || (y + h == bestTop && skyline[i].w < bestW)) {
+            bestIndex = (int)i;
+            bestY = y;
+            bestTop = y + h;
+            bestW = skyline[i].w;
+        }
+    }
+    if (bestIndex < 0) return false;
+
+    Segment seg{ skyline[bestIndex].x, bestY + h, w };
+    skyline.insert(skyline.begin() + bestIndex, seg);
+
+    // Trim the segments the new one now covers
+    for (size_t j = bestIndex + 1; j < skyline.size();) {
+        const Segment& prev = skyline[j - 1];
+        int prevEnd = prev.x + prev.w;
+        if (skyline[j].x >= prevEnd) break;
+        int shrink = prevEnd - skyline[j].x;
+        skyline[j].x += shrink;
+        skyline[j].w -= shrink;
+        if (skyline[j].w <= 0) skyline.erase(skyline.begin() + j);
+        else break;
+    }
+    // Merge neighbours at the same height
+    for (size_t j = 0; j + 1 < skyline.size();) {
+        if (skyline[j].y == skyline[j + 1].y) {
+            skyline[j].w += skyline[j + 1].w;
+            skyline.erase(skyline.begin() + j + 1);
+        }
+        else {
+            ++j;
+        }
+    }
+
+    *outX = seg.x;
+    *outY = bestY;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Glyph table
+// ----------------------------------------------------------------------------
+
+GLwinGlyph* GLwinGlyphTable::Find(uint64_t key)
+{
+    if (slots.empty()) return nullptr;
+    size_t mask = slots.size() - 1;
+    for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+        Slot& s = slots[i];
+        if (s.key == key) return &s.glyph;
+        if (s.key == EmptyKey) return nullptr;
+    }
+}
+
+GLwinGlyph* GLwinGlyphTable::Insert(uint64_t key, const GLwinGlyph& glyph)
+{
+    if ((used + 1) * 4 >= slots.size() * 3) Grow();
+    size_t mask = slots.size() - 1;
+    size_t firstDeleted = (size_t)-1;
+    for (size_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+        Slot& s = slots[i];
+        if (s.key == key) {
+            s.glyph = glyph;
+            return &s.glyph;
+        }
+        if (s.key == DeletedKey && firstDeleted == (size_t)-1) firstDeleted = i;
+        if (s.key == EmptyKey) {
+            Slot& dst = firstDeleted != (size_t)-1 ? slots[firstDeleted] : s;
+            if (&dst == &s) ++used;
+            dst.key = key;
+            dst.glyph = glyph;
+            ++count;
+            return &dst.glyph;
+        }
+    }
+}
+
+void GLwinGlyphTable::RemovePage(uint16_t page)
+{
+    for (Slot& s : slots) {
+        if (s.key != EmptyKey && s.key != DeletedKey && s.glyph.page == page) {
+            s.key = DeletedKey;
+            --count;
+        }
+    }
+}
+
+void GLwinGlyphTable::Clear()
+{
+    slots.clear();
+    count = 0;
+    used = 0;
+}
+
+void GLwinGlyphTable::Grow()
+{
+    // Rehash into a table sized for the live entries (drops tombstones too)
+    size_t newSize = slots.empty() ? 1024 : slots.size();
+    while (newSize * 3 <= (count + 1) * 4 * 2) newSize *= 2;
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.resize(newSize);
+    count = 0;
+    used = 0;
+    for (const Slot& s : old) {
+        if (s.key != EmptyKey && s.key != DeletedKey) Insert(s.key, s.glyph);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Font cache
+// ----------------------------------------------------------------------------
+
+GLwinFontCache::GLwinFontCache(int pageSize, int maxPages, bool useGL)
+    : pageSize(pageSize), maxPages(maxPages > 0 ? maxPages : 1), useGL(useGL)
+{
+    memDC = CreateCompatibleDC(NULL);
+}
+
+GLwinFontCache::~GLwinFontCache()
+{
+    for (FontFace& f : fonts) {
+        for (auto& s : f.sizes) DeleteObject((HFONT)s.second);
+        if (!f.path.empty()) RemoveFontResourceExW(f.path.c_str(), FR_PRIVATE, 0);
+        if (f.memoryHandle) RemoveFontMemResourceEx((HANDLE)f.memoryHandle);
+    }
+    if (memDC) DeleteDC((HDC)memDC);
+    if (useGL) {
+        for (Page& p : pages) {
+            if (!p.texture) continue;
+            GLwinGLState::Get().ForgetTexture(p.texture);
+            glDeleteTextures(1, &p.texture);
+        }
+    }
+}
+
+int GLwinFontCache::LoadFont(const wchar_t* path, const wchar_t* faceName)
+{
+    if (!path || !faceName) return -1;
+    if (AddFontResourceExW(path, FR_PRIVATE, 0) == 0) {
+        GLWIN_LOG_ERROR("Failed to load font file");
+        return -1;
+    }
+    FontFace face;
+    face.faceName = faceName;
+    face.path = path;
+    fonts.push_back(std::move(face));
+    return (int)fonts.size() - 1;
+}
+
+int GLwinFontCache::LoadFontFromMemory(const void* data, size_t size, const wchar_t* faceName)
+{
+    if (!data || size == 0 || size > 0xFFFFFFFFu || !faceName) return -1;
+    DWORD installed = 0;
+    HANDLE handle = AddFontMemResourceEx(const_cast<void*>(data), (DWORD)size, NULL, &installed);
+    if (!handle || installed == 0) {
+        GLWIN_LOG_ERROR("Failed to load font from memory");
+        return -1;
+    }
+    FontFace face;
+    face.faceName = faceName;
+    face.memoryHandle = handle;
+    fonts.push_back(std::move(face));
+    return (int)fonts.size() - 1;
+}
+
+int GLwinFontCache::LoadFontResource(const char* name, const wchar_t* faceName)
+{
+    GLwinFileView view;
+    if (!name || !GLwinLoadResource(name, &view)) {
+        GLWIN_LOG_ERROR("Font resource not found: " << (name ? name : "(null)"));
+        return -1;
+    }
+    int id = LoadFontFromMemory(view.data, view.size, faceName);
+    GLwinReleaseResource(&view);
+    return id;
+}
+
+int GLwinFontCache::AddSystemFont(const wchar_t* faceName)
+{
+    if (!faceName) return -1;
+    FontFace face;
+    face.faceName = faceName;
+    fonts.push_back(std::move(face));
+    return (int)fonts.size() - 1;
+}
+
+// HFONT per (font, size), created on first use
+void* GLwinFontCache::FontHandle(int font, int pixelSize)
+{
+    if (font < 0 || font >= (int)fonts.size() || pixelSize <= 0 || pixelSize > 0xFFFF) return nullptr;
+    FontFace& f = fonts[font];
+    for (auto& s : f.sizes) {
+        if (s.first == pixelSize) return s.second;
+    }
+    HFONT h = CreateFontW(-pixelSize, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+        OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH, f.faceName.c_str());
+    if (!h) return nullptr;
+    f.sizes.push_back({ (uint16_t)pixelSize, (void*)h });
+    return h;
+}
+
+bool GLwinFontCache::GetGlyph(int font, int pixelSize, uint32_t codepoint, GLwinGlyph* out)
+{
+    if (font < 0 || font >= (int)fonts.size() || pixelSize <= 0 || pixelSize > 0xFFFF) return false;
+    uint64_t key = GLwinGlyphTable::MakeKey((uint16_t)font, (uint16_t)pixelSize, codepoint);
+    GLwinGlyph* g = table.Find(key);
+    if (!g) {
+        GLwinGlyph fresh;
+        if (!Rasterize(font, pixelSize, codepoint, fresh)) return false;
+        g = table.Insert(key, fresh);
+    }
+    if (g->w > 0) pages[g->page].lastUsedFrame = frame;
+    if (out) *out = *g;
+    return true;
+}
+
+bool GLwinFontCache::Rasterize(int font, int pixelSize, uint32_t codepoint, GLwinGlyph& out)
+{
+    // GDI glyph outlines take a UTF-16 unit, so only the BMP is supported here
+    if (codepoint > 0xFFFF) return false;
+    HFONT hfont = (HFONT)FontHandle(font, pixelSize);
+    if (!hfont || !memDC) return false;
+    HDC dc = (HDC)memDC;
+    SelectObject(dc, hfont);
+
+    GLYPHMETRICS gm;
+    MAT2 identity = { {0, 1}, {0, 0}, {0, 0}, {0, 1} };
+    DWORD bytes = GetGlyphOutlineW(dc, codepoint, GGO_GRAY8_BITMAP, &gm, 0, nullptr, &identity);
+    if (bytes == GDI_ERROR) return false;
+
+    out.advance = (float)gm.gmCellIncX;
+    out.bearingX = (int16_t)gm.gmptGlyphOrigin.x;
+    out.bearingY = (int16_t)gm.gmptGlyphOrigin.y;
+    if (bytes == 0) {
+        // whitespace: metrics only, nothing to pack
+        out.w = out.h = 0;
+        return true;
+    }
+
+    scratch.resize(bytes);
+    if (GetGlyphOutlineW(dc, codepoint, GGO_GRAY8_BITMAP, &gm, bytes, scratch.data(), &identity) == GDI_ERROR)
+        return false;
+
+    int w = (int)gm.gmBlackBoxX;
+    int h = (int)gm.gmBlackBoxY;
+    int pitch = (w + 3) & ~3; // GDI rows are DWORD aligned
+
+    uint16_t page;
+    int ax, ay;
+    if (!Allocate(w, h, &page, &ax, &ay)) return false;
+
+    // GGO_GRAY8 gives 0..64 coverage, expand to 0..255
+    Page& p = pages[page];
+    for (int row = 0; row < h; ++row) {
+        const uint8_t* src = scratch.data() + row * pitch;
+        uint8_t* dst = p.pixels.data() + (ay + row) * pageSize + ax;
+        for (int col = 0; col < w; ++col) {
+            dst[col] = (uint8_t)((src[col] * 255 + 32) / 64);
+        }
+    }
+    MarkDirty(p, ax, ay, w, h);
+
+    float inv = 1.0f / (float)pageSize;
+    out.page = page;
+    out.x = (uint16_t)ax; out.y = (uint16_t)ay;
+    out.w = (uint16_t)w; out.h = (uint16_t)h;
+    out.u0 = ax * inv; out.v0 = ay * inv;
+    out.u1 = (ax + w) * inv; out.v1 = (ay + h) * inv;
+    return true;
+}
+
+bool GLwinFontCache::Allocate(int w, int h, uint16_t* page, int* x, int* y)
+{
+    // 1px gutter so bilinear sampling never bleeds into a neighbour
+    int pw = w + 1, ph = h + 1;
+    if (pw > pageSize || ph > pageSize) return false;
+
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i].packer.Pack(pw, ph, x, y)) {
+            *page = (uint16_t)i;
+            return true;
+        }
+    }
+    if ((int)pages.size() < maxPages) {
+        pages.emplace_back();
+        Page& p = pages.back();
+        p.pixels.assign((size_t)pageSize * pageSize, 0);
+        p.packer.Reset(pageSize, pageSize);
+        if (p.packer.Pack(pw, ph, x, y)) {
+            *page = (uint16_t)(pages.size() - 1);
+            return true;
+        }
+        return false;
+    }
+
+    int victim = EvictPage();
+    if (pages[victim].packer.Pack(pw, ph, x, y)) {
+        *page = (uint16_t)victim;
+        return true;
+    }
+    return false;
+}
+
+// Clear the least recently used page and hand it back
+int GLwinFontCache::EvictPage()
+{
+    int victim = 0;
+    for (int i = 1; i < (int)pages.size(); ++i) {
+        if (pages[i].lastUsedFrame < pages[victim].lastUsedFrame) victim = i;
+    }
+    if (pages[victim].lastUsedFrame == frame) {
+        GLWIN_LOG_WARNING("Glyph atlas thrashing: evicting a page used this frame, raise the page count");
+    }
+    Page& p = pages[victim];
+    table.RemovePage((uint16_t)victim);
+    std::fill(p.pixels.begin(), p.pixels.end(), (uint8_t)0);
+    p.packer.Reset(pageSize, pageSize);
+    p.lastUsedFrame = 0;
+    MarkDirty(p, 0, 0, pageSize, pageSize);
+    return victim;
+}
+
+void GLwinFontCache::MarkDirty(Page& p, int x, int y, int w, int h)
+{
+    if (p.dirtyX0 >= p.dirtyX1) {
+        p.dirtyX0 = x; p.dirtyY0 = y;
+        p.dirtyX1 = x + w; p.dirtyY1 = y + h;
+        return;
+    }
+    p.dirtyX0 = std::min(p.dirtyX0, x);
+    p.dirtyY0 = std::min(p.dirtyY0, y);
+    p.dirtyX1 = std::max(p.dirtyX1, x + w);
+    p.dirtyY1 = std::max(p.dirtyY1, y + h);
+}
+
+void GLwinFontCache::UploadDirtyPages()
+{
+    if (!useGL) return;
+    bool touched = false;
+    for (Page& p : pages) {
+        if (p.dirtyX0 >= p.dirtyX1) continue;
+        if (!touched) {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, pageSize);
+            touched = true;
+        }
+        if (!p.texture) {
+            glGenTextures(1, &p.texture);
+            GLwinGLState::Get().BindTexture(0, GL_TEXTURE_2D, p.texture);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, pageSize, pageSize);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            // fresh texture: upload the whole page once
+            p.dirtyX0 = 0; p.dirtyY0 = 0; p.dirtyX1 = pageSize; p.dirtyY1 = pageSize;
+        }
+        else {
+            GLwinGLState::Get().BindTexture(0, GL_TEXTURE_2D, p.texture);
+        }
+        const uint8_t* src = p.pixels.data() + (size_t)p.dirtyY0 * pageSize + p.dirtyX0;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, p.dirtyX0, p.dirtyY0, p.dirtyX1 - p.dirtyX0, p.dirtyY1 - p.dirtyY0,
+            GL_RED, GL_UNSIGNED_BYTE, src);
+        p.dirtyX0 = p.dirtyX1 = 0;
+    }
+    if (touched) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+}
+
+GLuint GLwinFontCache::GetPageTexture(int page) const
+{
+    if (page < 0 || page >= (int)pages.size()) return 0;
+    return pages[page].texture;
+}
+
+const uint8_t* GLwinFontCache::GetPagePixels(int page) const
+{
+    if (page < 0 || page >= (int)pages.size()) return nullptr;
+    return pages[page].pixels.data();
+}
+
+float GLwinFontCache::GetKerning(int font, int pixelSize, uint32_t left, uint32_t right)
+{
+    if (left > 0xFFFF || right > 0xFFFF) return 0.0f;
+    HFONT hfont = (HFONT)FontHandle(font, pixelSize);
+    if (!hfont) return 0.0f;
+    FontFace& f = fonts[font];
+
+    // Kerning pairs are read once per size and kept sorted for binary search
+    if (std::find(f.kerningLoaded.begin(), f.kerningLoaded.end(), (uint16_t)pixelSize) == f.kerningLoaded.end()) {
+        f.kerningLoaded.push_back((uint16_t)pixelSize);
+        HDC dc = (HDC)memDC;
+        SelectObject(dc, hfont);
+        DWORD n = GetKerningPairsW(dc, 0, nullptr);
+        if (n > 0) {
+            std::vector<KERNINGPAIR> pairs(n);
+            n = GetKerningPairsW(dc, n, pairs.data());
+            for (DWORD i = 0; i < n; ++i) {
+                uint64_t k = ((uint64_t)pixelSize << 42) | ((uint64_t)pairs[i].wFirst << 21) | pairs[i].wSecond;
+                f.kerning.push_back({ k, (float)pairs[i].iKernAmount });
+            }
+            std::sort(f.kerning.begin(), f.kerning.end());
+        }
+    }
+
+    uint64_t k = ((uint64_t)pixelSize << 42) | ((uint64_t)left << 21) | right;
+    auto it = std::lower_bound(f.kerning.begin(), f.kerning.end(), std::make_pair(k, -1.0e30f));
+    if (it != f.kerning.end() && it->first == k) return it->second;
+    return 0.0f;
+}
+
+void GLwinFontCache::GetLineMetrics(int font, int pixelSize, float* ascent, float* descent, float* lineGap)
+{
+    float a = 0.0f, d = 0.0f, g = 0.0f;
+    HFONT hfont = (HFONT)FontHandle(font, pixelSize);
+    if (hfont && memDC) {
+        TEXTMETRICW tm;
+        SelectObject((HDC)memDC, hfont);
+        if (GetTextMetricsW((HDC)memDC, &tm)) {
+            a = (float)tm.tmAscent;
+            d = (float)tm.tmDescent;
+            g = (float)tm.tmExternalLeading;
+        }
+    }
+    if (ascent) *ascent = a;
+    if (descent) *descent = d;
+    if (lineGap) *lineGap = g;
+}
+
+void GLwinFontCache::BlitGlyphBGRA(void* pixels, int bufWidth, int bufHeight, int penX, int penY,
+    const GLwinGlyph& glyph, uint32_t colorBGRA) const
+{
+    if (!pixels || glyph.w == 0 || glyph.page >= pages.size()) return;
+    const Page& p = pages[glyph.page];
+
+    int dstX = penX + glyph.bearingX;
+    int dstY = penY - glyph.bearingY;
+    int x0 = std::max(0, -dstX), y0 = std::max(0, -dstY);
+    int x1 = std::min((int)glyph.w, bufWidth - dstX);
+    int y1 = std::min((int)glyph.h, bufHeight - dstY);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    uint32_t cb = colorBGRA & 0xFF, cg = (colorBGRA >> 8) & 0xFF, cr = (colorBGRA >> 16) & 0xFF;
+    uint32_t ca = (colorBGRA >> 24) & 0xFF;
+    uint32_t* dst = static_cast<uint32_t*>(pixels);
+
+    for (int row = y0; row < y1; ++row) {
+        const uint8_t* src = p.pixels.data() + (size_t)(glyph.y + row) * pageSize + glyph.x;
+        uint32_t* out = dst + (size_t)(dstY + row) * bufWidth + dstX;
+        for (int col = x0; col < x1; ++col) {
+            uint32_t a = (src[col] * ca + 127) / 255;
+            if (!a) continue;
+            uint32_t d = out[col];
+            uint32_t db = d & 0xFF, dg = (d >> 8) & 0xFF, dr = (d >> 16) & 0xFF;
+            db += ((int)cb - (int)db) * (int)a / 255;
+            dg += ((int)cg - (int)dg) * (int)a / 255;
+            dr += ((int)cr - (int)dr) * (int)a / 255;
+            out[col] = (d & 0xFF000000u) | (dr << 16) | (dg << 8) | db;
+        }
+    }
+}
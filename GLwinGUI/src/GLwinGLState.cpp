@@ -0,0 +1,227 @@
+#include "../include/GLwinGLState.h"
+#include "../../GLwin/include/GLwinContext.h"
+#include <cstring>
+
+GLwinGLFunctions GLwinGLFunctionsFromGlad()
+{
+    GLwinGLFunctions fns;
+    fns.UseProgram = glad_glUseProgram;
+    fns.BindVertexArray = glad_glBindVertexArray;
+    fns.BindBuffer = glad_glBindBuffer;
+    fns.BindBufferRange = glad_glBindBufferRange;
+    fns.ActiveTexture = glad_glActiveTexture;
+    fns.BindTexture = glad_glBindTexture;
+    fns.Enable = glad_glEnable;
+    fns.Disable = glad_glDisable;
+    fns.BlendFuncSeparate = glad_glBlendFuncSeparate;
+    fns.Scissor = glad_glScissor;
+    fns.Viewport = glad_glViewport;
+    fns.GetCurrentContext = GLwinGetCurrentNativeContext;
+    return fns;
+}
+
+GLwinGLState& GLwinGLState::Get()
+{
+    static thread_local GLwinGLState state;
+    state.CheckContext();
+    return state;
+}
+
+// The cached bindings belong to whichever context was current when they were made
+void GLwinGLState::CheckContext()
+{
+    if (!gl.GetCurrentContext) return;
+    void* current = gl.GetCurrentContext();
+    if (current == context) return;
+    context = current;
+    Reset();
+}
+
+GLwinGLState::GLwinGLState()
+{
+    Reset();
+}
+
+void GLwinGLState::SetFunctions(const GLwinGLFunctions& fns)
+{
+    gl = fns;
+    context = gl.GetCurrentContext ? gl.GetCurrentContext() : nullptr;
+    Reset();
+}
+
+void GLwinGLState::Reset()
+{
+    program = Unknown;
+    vertexArray = Unknown;
+    for (GLuint& b : buffers) b = Unknown;
+    for (IndexedBinding& b : uniformBindings) b = { Unknown, 0, 0 };
+    activeUnit = Unknown;
+    for (auto& unit : textures)
+        for (GLuint& t : unit) t = Unknown;
+    blend = StateUnknown;
+    scissorTest = StateUnknown;
+    for (GLenum& f : blendFunc) f = 0;
+    for (GLint& v : scissor) v = -1;
+    for (GLint& v : viewport) v = -1;
+}
+
+int GLwinGLState::BufferSlot(GLenum target)
+{
+    switch (target) {
+    case GL_ARRAY_BUFFER:          return BufArray;
+    case GL_ELEMENT_ARRAY_BUFFER:  return BufElement;
+    case GL_UNIFORM_BUFFER:        return BufUniform;
+    case GL_PIXEL_UNPACK_BUFFER:   return BufPixelUnpack;
+    case GL_PIXEL_PACK_BUFFER:     return BufPixelPack;
+    case GL_COPY_READ_BUFFER:      return BufCopyRead;
+    case GL_COPY_WRITE_BUFFER:     return BufCopyWrite;
+    case GL_SHADER_STORAGE_BUFFER: return BufShaderStorage;
+    case GL_DRAW_INDIRECT_BUFFER:  return BufDrawIndirect;
+    default:                       return -1;
+    }
+}
+
+int GLwinGLState::TextureSlot(GLenum target)
+{
+    switch (target) {
+    case GL_TEXTURE_2D:       return TexTarget2D;
+    case GL_TEXTURE_2D_ARRAY: return TexTarget2DArray;
+    case GL_TEXTURE_BUFFER:   return TexTargetBuffer;
+    case GL_TEXTURE_CUBE_MAP: return TexTargetCube;
+    case GL_TEXTURE_3D:       return TexTarget3D;
+    default:                  return -1;
+    }
+}
+
+void GLwinGLState::UseProgram(GLuint p)
+{
+    if (program == p && Elide()) return;
+    Issue();
+    gl.UseProgram(p);
+    program = p;
+}
+
+void GLwinGLState::BindVertexArray(GLuint vao)
+{
+    if (vertexArray == vao && Elide()) return;
+    Issue();
+    gl.BindVertexArray(vao);
+    vertexArray = vao;
+    // the element buffer binding is part of the VAO
+    buffers[BufElement] = Unknown;
+}
+
+void GLwinGLState::BindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = BufferSlot(target);
+    if (slot >= 0 && buffers[slot] == buffer && Elide()) return;
+    Issue();
+    gl.BindBuffer(target, buffer);
+    if (slot >= 0) buffers[slot] = buffer;
+}
+
+void GLwinGLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    bool cached = target == GL_UNIFORM_BUFFER && index < (GLuint)MaxIndexedBindings;
+    if (cached) {
+        const IndexedBinding& b = uniformBindings[index];
+        if (b.buffer == buffer && b.offset == offset && b.size == size && Elide()) return;
+    }
+    Issue();
+    gl.BindBufferRange(target, index, buffer, offset, size);
+    if (cached) uniformBindings[index] = { buffer, offset, size };
+    // glBindBufferRange also changes the generic binding point
+    int slot = BufferSlot(target);
+    if (slot >= 0) buffers[slot] = buffer;
+}
+
+void GLwinGLState::BindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    int slot = TextureSlot(target);
+    bool cached = slot >= 0 && unit < (GLuint)MaxTextureUnits;
+    if (cached && textures[unit][slot] == texture && Elide()) return;
+
+    if (activeUnit != unit) {
+        Issue();
+        gl.ActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+    Issue();
+    gl.BindTexture(target, texture);
+    if (cached) textures[unit][slot] = texture;
+}
+
+void GLwinGLState::SetCap(GLenum cap, bool enabled, TriState& cached)
+{
+    TriState want = enabled ? StateOn : StateOff;
+    if (cached == want && Elide()) return;
+    Issue();
+    if (enabled) gl.Enable(cap);
+    else gl.Disable(cap);
+    cached = want;
+}
+
+void GLwinGLState::SetBlend(bool enabled)
+{
+    SetCap(GL_BLEND, enabled, blend);
+}
+
+void GLwinGLState::BlendFunc(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+{
+    if (blendFunc[0] == srcRGB && blendFunc[1] == dstRGB && blendFunc[2] == srcAlpha && blendFunc[3] == dstAlpha && Elide())
+        return;
+    Issue();
+    gl.BlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    blendFunc[0] = srcRGB; blendFunc[1] = dstRGB; blendFunc[2] = srcAlpha; blendFunc[3] = dstAlpha;
+}
+
+void GLwinGLState::SetScissorTest(bool enabled)
+{
+    SetCap(GL_SCISSOR_TEST, enabled, scissorTest);
+}
+
+void GLwinGLState::Scissor(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    if (scissor[0] == x && scissor[1] == y && scissor[2] == w && scissor[3] == h && Elide()) return;
+    Issue();
+    gl.Scissor(x, y, w, h);
+    scissor[0] = x; scissor[1] = y; scissor[2] = w; scissor[3] = h;
+}
+
+void GLwinGLState::Viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    if (viewport[0] == x && viewport[1] == y && viewport[2] == w && viewport[3] == h && Elide()) return;
+    Issue();
+    gl.Viewport(x, y, w, h);
+    viewport[0] = x; viewport[1] = y; viewport[2] = w; viewport[3] = h;
+}
+
+void GLwinGLState::ForgetProgram(GLuint p)
+{
+    if (program == p) program = Unknown;
+}
+
+void GLwinGLState::ForgetVertexArray(GLuint vao)
+{
+    if (vertexArray == vao) {
+        vertexArray = Unknown;
+        buffers[BufElement] = Unknown;
+    }
+}
+
+void GLwinGLState::ForgetBuffer(GLuint buffer)
+{
+    for (GLuint& b : buffers) {
+        if (b == buffer) b = Unknown;
+    }
+    for (IndexedBinding& b : uniformBindings) {
+        if (b.buffer == buffer) b.buffer = Unknown;
+    }
+}
+
+void GLwinGLState::ForgetTexture(GLuint texture)
+{
+    for (auto& unit : textures)
+        for (GLuint& t : unit)
+            if (t == texture) t = Unknown;
+}
@@ -1,12 +1,14 @@
 //#include "../../vendors/glad/glad.h" // Include glad to get the OpenGL headers
 #include "../GLwinGUI.h"
 #include "../../GLwin/include/GLwinLog.h"
+#include "../../GLwin/include/GLwinProfile.h"
 #include "../../GLwinGUI/Shader/GLwinShaderManager.h"
 #include "../../vendors/glm/glm.hpp"
 #include "../../vendors/glm/gtc/matrix_transform.hpp" // Include for glm::mat4 transformations
 #include "../../gui/BaseGui.h"
 #include "../../gui/guiWin.h"
 
+#include <algorithm>
 #include <iostream>
 
 GLwinGUI::GLwinGUI() {}
@@ -26,13 +28,71 @@ void GLwinGUI::Initialize() {
     else {
         GLWIN_LOG_INFO("GLAD initialized successfully.");
     }
-    
+
+    // All GUI binds go through the state cache from here on
+    GLwinGLState::Get().SetFunctions(GLwinGLFunctionsFromGlad());
+
+    // Glyphs are rasterised lazily, so this costs nothing until text is drawn
+    fontCache = std::make_unique<GLwinFontCache>();
+    frameUniforms = std::make_unique<GLwinFrameUniforms>();
+    // no texture memory until the first image is added
+    imageAtlas = std::make_unique<GLwinImageAtlas>();
+    imageBatch = std::make_unique<GLwinImageBatch>();
+    // issues nothing until profiling is enabled
+    gpuTimer = std::make_unique<GLwinGpuTimer>();
 }
 
 void GLwinGUI::RenderGUI(const glm::mat4& view, const glm::mat4& projection,
     std::vector<std::unique_ptr<BaseGui>>& guiwWindowsdata, int& currentIndex, Shader& shader)
 {
+    GLWIN_PROFILE_SCOPE("RenderGUI");
+    GLwinGLState& gl = GLwinGLState::Get();
+    gl.BeginFrame();
+    // the app's own GL calls since last frame bypassed the cache, so trust nothing from then;
+    // redundant binds are still dropped within the frame
+    gl.Reset();
+    // GPU times of earlier frames reach the profiler here
+    if (gpuTimer) gpuTimer->BeginFrame();
+    // swap in any programs that finished compiling since last frame
+    GLwinShaderManager::Poll();
+    if (fontCache) fontCache->BeginFrame();
+
+    {
+        GLwinGpuScope gpuZone(gpuTimer.get(), "GUI Upload");
+        // view/projection go to every program at once through the shared block
+        if (frameUniforms) frameUniforms->Update(view, projection, framebufferWidth, framebufferHeight);
+        // queued image pixels go up a budgeted slice at a time
+        if (imageAtlas) imageAtlas->Upload();
+    }
+
     GLwinGUI::CreateGuiWindow(view, projection, guiwWindowsdata, currentIndex, winindex);
+
+    // quads without a window (or whose window wasn't drawn) go over everything
+    if (imageAtlas && imageBatch) {
+        GLwinGpuScope gpuZone(gpuTimer.get(), "GUI Images");
+        imageBatch->Flush(*imageAtlas, GLwinShaderManager::imageShader);
+    }
+
+    // a dragged panel is snapshotted from this frame's pixels (before the swap), then drawn
+    // over everything at the cursor
+    {
+        GLwinGpuScope gpuZone(gpuTimer.get(), "GUI Dock Preview");
+        dockManager.CapturePendingPreview();
+        dockManager.DrawDragPreview();
+    }
+
+    // glyphs rasterised this frame go up in one sub-image per atlas page
+    if (fontCache) {
+        GLwinGpuScope gpuZone(gpuTimer.get(), "GUI Glyph Upload");
+        fontCache->UploadDirtyPages();
+    }
+    if (frameUniforms) frameUniforms->EndFrame();
+
+    // windows leave their VAO bound for the next one; don't let the app's element buffer or
+    // attribute setup after us land in the last window's VAO
+    gl.BindVertexArray(0);
+
+    glFrameStats = gl.GetFrameStats();
 }
 
 void GLwinGUI::CreateGuiWindow(const glm::mat4& view, const glm::mat4& projection,
@@ -66,10 +126,10 @@ void GLwinGUI::CreateGuiWindow(const glm::mat4& view, const glm::mat4& projectio
             break;
         }
 
-        newWindow->modelMatrix = glm::mat4(1.0f);
-        newWindow->modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(newWindow->posX, newWindow->posY, 0.0f));
-        newWindow->modelMatrix = glm::scale(newWindow->modelMatrix, glm::vec3(newWindow->width, newWindow->height, 1.0f));
-        
+        UpdateModelMatrix(newWindow.get());
+
+        // the newest window goes on top
+        hitGrid.Insert(newWindow.get(), ++topZOrder);
 
         guiwWindowsdata.push_back(std::move(newWindow));
 
@@ -80,20 +140,128 @@ void GLwinGUI::CreateGuiWindow(const glm::mat4& view, const glm::mat4& projectio
         ShouldAddNewWindow = false;
     }
 
-    // Draw all windows
+    // Pick up rects written straight to the windows, then draw bottom to top in the z order
+    // picking uses, so a click always lands on the window drawn on top
+    drawOrder.clear();
     for (const auto& win : guiwWindowsdata) {
-        if (auto* guiwin = dynamic_cast<BasewinGUI*>(win.get())) {
+        if (hitGrid.Update(win.get())) UpdateModelMatrix(win.get());
+        drawOrder.push_back(win.get());
+    }
+    std::stable_sort(drawOrder.begin(), drawOrder.end(),
+        [this](BaseGui* a, BaseGui* b) { return hitGrid.GetZOrder(a) < hitGrid.GetZOrder(b); });
+
+    // Draw all windows
+    for (BaseGui* win : drawOrder) {
+        if (auto* guiwin = dynamic_cast<BasewinGUI*>(win)) {
             // Set shader uniforms for model matrix here if using shaders
             /*GLwinShaderManager::defaultShader->Use();
             GLwinShaderManager::defaultShader->setMat4("view", view);
             GLwinShaderManager::defaultShader->setMat4("projection", projection);*/
 
+            GLWIN_PROFILE_SCOPE("DrawGuiWindow");
+            GLwinGpuScope gpuZone(gpuTimer.get(), "DrawGuiWindow");
             guiwin->DrawGuiWindow();
         }
+        // the window's icons go out with it, so the windows drawn after cover them
+        if (imageAtlas && imageBatch && imageBatch->GetCount()) {
+            GLwinGpuScope gpuZone(gpuTimer.get(), "GUI Images");
+            imageBatch->FlushOwner(*imageAtlas, GLwinShaderManager::imageShader, win);
+        }
     }
     
 }
 
+GLwinHoverEvent GLwinGUI::UpdateGuiHover(double x, double y)
+{
+    GLwinHoverEvent ev = hitGrid.UpdateHover(x, y);
+    if (ev.left) ev.left->isHovered = false;
+    if (ev.entered) ev.entered->isHovered = true;
+    return ev;
+}
+
+void GLwinGUI::SetGuiWindowRect(BaseGui* win, int x, int y, int w, int h)
+{
+    if (!win) return;
+    if (win->posX == x && win->posY == y && win->width == w && win->height == h) return;
+    win->posX = x;
+    win->posY = y;
+    win->width = w;
+    win->height = h;
+    UpdateModelMatrix(win);
+    hitGrid.Update(win);
+}
+
+void GLwinGUI::BringGuiWindowToFront(BaseGui* win)
+{
+    if (!win) return;
+    hitGrid.SetZOrder(win, ++topZOrder);
+}
+
+void GLwinGUI::RemoveGuiWindow(std::vector<std::unique_ptr<BaseGui>>& guiwWindowsdata, BaseGui* win)
+{
+    if (!win) return;
+    hitGrid.Remove(win);
+    if (dockManager.GetDrag().panel == win) dockManager.CancelDrag();
+    dockManager.UndockPanel(win);
+    DetachFromLayout(&layoutRoot, win);
+    std::erase(drawOrder, win);
+    std::erase_if(guiwWindowsdata, [win](const std::unique_ptr<BaseGui>& w) { return w.get() == win; });
+}
+
+void GLwinGUI::DetachFromLayout(GLwinLayoutNode* node, BaseGui* win)
+{
+    if (node->GetGui() == win) node->SetGui(nullptr);
+    for (const auto& child : node->GetChildren()) DetachFromLayout(child.get(), win);
+}
+
+void GLwinGUI::SetContentScale(float scale)
+{
+    if (scale <= 0.0f || scale == contentScale) return;
+    contentScale = scale;
+    contentScaleChanged = true;
+    dockManager.SetContentScale(scale);
+}
+
+void GLwinGUI::ApplyLayoutRect(GLwinLayoutNode* node, bool recursive)
+{
+    if (node->GetGui()) {
+        SetGuiWindowRect(node->GetGui(), (int)(node->x * contentScale + 0.5f), (int)(node->y * contentScale + 0.5f),
+            (int)(node->w * contentScale + 0.5f), (int)(node->h * contentScale + 0.5f));
+    }
+    if (!recursive) return;
+    for (const auto& child : node->GetChildren()) ApplyLayoutRect(child.get(), true);
+}
+
+void GLwinGUI::LayoutGuiWindows(int fbWidth, int fbHeight)
+{
+    SetFramebufferSize(fbWidth, fbHeight);
+    // the tree works in 96 DPI units, so a DPI change that scales the framebuffer by the same
+    // factor leaves it untouched and only the rects below change
+    layoutChanged.clear();
+    layoutRoot.Arrange(0.0f, 0.0f, (float)fbWidth / contentScale, (float)fbHeight / contentScale, &layoutChanged);
+    if (contentScaleChanged) {
+        contentScaleChanged = false;
+        ApplyLayoutRect(&layoutRoot, true);
+        return;
+    }
+    for (GLwinLayoutNode* node : layoutChanged) ApplyLayoutRect(node, false);
+}
+
+void GLwinGUI::LayoutDockedWindows(int fbWidth, int fbHeight)
+{
+    SetFramebufferSize(fbWidth, fbHeight);
+    dockManager.SetRootRect(0.0f, 0.0f, (float)fbWidth, (float)fbHeight, fbHeight);
+    dockManager.Layout([this](BaseGui* win, int x, int y, int w, int h) {
+        SetGuiWindowRect(win, x, y, w, h);
+    });
+}
+
+void GLwinGUI::UpdateModelMatrix(BaseGui* win)
+{
+    win->modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(win->posX, win->posY, 0.0f));
+    win->modelMatrix = glm::scale(win->modelMatrix, glm::vec3(win->width, win->height, 1.0f));
+}
+
 //void GLwinGUI::GLwin_DestroyWindow(GuiWindowData* guiwindow)
 //{
 //    // Implement window destruction logic if needed
@@ -0,0 +1,125 @@
+#include "../include/GLwinGpuTimer.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include "../../GLwin/include/GLwinProfile.h"
+
+GLwinGpuTimer::GLwinGpuTimer()
+{
+    if (!GLAD_GL_VERSION_3_3 || !glGenQueries || !glQueryCounter) {
+        GLWIN_LOG_INFO("GPU timer queries need GL 3.3, GPU zones are disabled");
+        return;
+    }
+    GLint bits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &bits);
+    if (bits == 0) {
+        GLWIN_LOG_INFO("Driver has no GPU timer, GPU zones are disabled");
+        return;
+    }
+    GLint timestampBits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &timestampBits);
+    timestamps = timestampBits > 0;
+
+    for (Frame& f : frames) {
+        glGenQueries(GLWIN_GPU_TIMER_MAX_ZONES, f.elapsed);
+        if (timestamps) glGenQueries(GLWIN_GPU_TIMER_MAX_ZONES, f.timestamp);
+    }
+    supported = true;
+}
+
+GLwinGpuTimer::~GLwinGpuTimer()
+{
+    if (!supported) return;
+    if (open) glEndQuery(GL_TIME_ELAPSED);
+    for (Frame& f : frames) {
+        glDeleteQueries(GLWIN_GPU_TIMER_MAX_ZONES, f.elapsed);
+        if (timestamps) glDeleteQueries(GLWIN_GPU_TIMER_MAX_ZONES, f.timestamp);
+    }
+}
+
+bool GLwinGpuTimer::Collect(Frame& f)
+{
+    // queries finish in order, so the last one being ready means they all are
+    GLint available = 0;
+    glGetQueryObjectiv(f.elapsed[f.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return false;
+
+    double ticksPerNs = (double)GLwinGetTickFrequency() / 1e9;
+    for (int i = 0; i < f.count; ++i) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(f.elapsed[i], GL_QUERY_RESULT, &ns);
+        if (firstResult) {
+            // some drivers (llvmpipe) report garbage for the very first query after creation;
+            // it can't have taken longer than the time since its frame began
+            firstResult = false;
+            if ((double)ns > (double)(GLwinGetTicks() - f.cpuBase) / ticksPerNs) continue;
+        }
+        uint64_t begin = f.zones[i].cpuTicks;
+        if (timestamps) {
+            GLuint64 at = 0;
+            glGetQueryObjectui64v(f.timestamp[i], GL_QUERY_RESULT, &at);
+            begin = f.cpuBase + (uint64_t)((double)((int64_t)at - f.gpuBase) * ticksPerNs);
+        }
+        GLwinProfileRecordGpu(f.zones[i].name, begin, begin + (uint64_t)((double)ns * ticksPerNs));
+    }
+    f.pending = false;
+    f.count = 0;
+    return true;
+}
+
+void GLwinGpuTimer::BeginFrame()
+{
+    if (!supported) return;
+    if (current >= 0) {
+        if (open) {
+            // a zone left open: close it so the ring stays consistent
+            glEndQuery(GL_TIME_ELAPSED);
+            frames[current].count++;
+            open = false;
+        }
+        depth = 0;
+        frames[current].pending = frames[current].count > 0;
+        current = -1;
+    }
+
+    // oldest first; a frame still in flight means the ones after it are too
+    for (int i = 0; i < GLWIN_GPU_TIMER_FRAMES; ++i) {
+        Frame& f = frames[(next + i) % GLWIN_GPU_TIMER_FRAMES];
+        if (f.pending && !Collect(f)) break;
+    }
+
+    if (!GLwinProfileIsEnabled()) return;
+    Frame& f = frames[next];
+    if (f.pending) {
+        ++skippedFrames;
+        return;
+    }
+    f.count = 0;
+    f.cpuBase = GLwinGetTicks();
+    if (timestamps) {
+        GLint64 now = 0;
+        glGetInteger64v(GL_TIMESTAMP, &now);
+        f.gpuBase = now;
+    }
+    current = next;
+    next = (next + 1) % GLWIN_GPU_TIMER_FRAMES;
+}
+
+void GLwinGpuTimer::Begin(const char* name)
+{
+    if (current < 0) return;
+    if (depth++ > 0) return;
+    Frame& f = frames[current];
+    if (f.count == GLWIN_GPU_TIMER_MAX_ZONES) return;
+    f.zones[f.count] = { name, GLwinGetTicks() };
+    if (timestamps) glQueryCounter(f.timestamp[f.count], GL_TIMESTAMP);
+    glBeginQuery(GL_TIME_ELAPSED, f.elapsed[f.count]);
+    open = true;
+}
+
+void GLwinGpuTimer::End()
+{
+    if (current < 0 || depth == 0) return;
+    if (--depth > 0 || !open) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    frames[current].count++;
+    open = false;
+}
@@ -0,0 +1,452 @@
+#include "../gui/GLwinImageAtlas.h"
+#include "../Shader/GLwinShader.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include "../include/GLwinGLState.h"
+#include <algorithm>
+#include <cstring>
+
+static const int GLWIN_IMAGE_GUTTER = 1;
+
+// ----------------------------------------------------------------------------
+// Atlas
+// ----------------------------------------------------------------------------
+
+GLwinImageAtlas::GLwinImageAtlas(int layerSize, int maxLayers, size_t uploadBudget, int uploadSlices)
+    : layerSize(layerSize), maxLayers(maxLayers > 0 ? maxLayers : 1)
+{
+    GLint maxArrayLayers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxArrayLayers);
+    if (this->maxLayers > maxArrayLayers) this->maxLayers = maxArrayLayers;
+
+    // a slice must hold at least one full row of the widest image
+    const size_t minBudget = (size_t)layerSize * 4;
+    this->uploadBudget = uploadBudget < minBudget ? minBudget : uploadBudget;
+    const int maxSlices = (int)(sizeof(fences) / sizeof(fences[0]));
+    sliceCount = uploadSlices < 1 ? 1 : (uploadSlices > maxSlices ? maxSlices : uploadSlices);
+
+    // slot 0 is GLWIN_IMAGE_NONE: no texture
+    images.emplace_back();
+    table.push_back({ 0.0f, 0.0f, 0.0f, 0.0f, -1, { 0, 0, 0 } });
+    dirtyBegin = 0;
+    dirtyEnd = 1;
+
+    GLwinGLState& gl = GLwinGLState::Get();
+    const GLsizeiptr pboSize = (GLsizeiptr)(this->uploadBudget * sliceCount);
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &pbo);
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, pboSize, nullptr, flags);
+    pboMapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, pboSize, flags);
+    // anything else uploading pixels (the glyph cache) expects client memory
+    gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!pboMapped) {
+        GLWIN_LOG_ERROR("Failed to map the image upload buffer");
+    }
+
+    glGenBuffers(1, &tableBuffer);
+}
+
+GLwinImageAtlas::~GLwinImageAtlas()
+{
+    GLwinGLState& gl = GLwinGLState::Get();
+    for (int i = 0; i < sliceCount; ++i) {
+        if (fences[i]) glDeleteSync(fences[i]);
+    }
+    if (pbo) {
+        gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        if (pboMapped) glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        gl.ForgetBuffer(pbo);
+        glDeleteBuffers(1, &pbo);
+    }
+    if (tableBuffer) {
+        gl.ForgetBuffer(tableBuffer);
+        glDeleteBuffers(1, &tableBuffer);
+    }
+    if (texture) {
+        gl.ForgetTexture(texture);
+        glDeleteTextures(1, &texture);
+    }
+}
+
+uint32_t GLwinImageAtlas::AddImage(const void* rgba, int width, int height)
+{
+    if (!rgba || width <= 0 || height <= 0) return GLWIN_IMAGE_NONE;
+
+    int layer;
+    Rect r;
+    if (!Allocate(width + GLWIN_IMAGE_GUTTER, height + GLWIN_IMAGE_GUTTER, &layer, &r)) {
+        GLWIN_LOG_WARNING("Image atlas full, could not place a " << width << "x" << height << " image");
+        return GLWIN_IMAGE_NONE;
+    }
+
+    uint32_t id;
+    if (!freeImages.empty()) {
+        id = freeImages.back();
+        freeImages.pop_back();
+    }
+    else {
+        id = (uint32_t)images.size();
+        images.emplace_back();
+        table.emplace_back();
+    }
+    Image& img = images[id];
+    img.layer = layer;
+    img.rect = { r.x, r.y, width, height };
+    img.serial = nextSerial++;
+    img.alive = true;
+    img.ready = false;
+    WriteEntry(id);
+
+    PendingUpload up;
+    up.image = id;
+    up.serial = img.serial;
+    up.pixels.assign((const uint8_t*)rgba, (const uint8_t*)rgba + (size_t)width * height * 4);
+    pendingBytes += up.pixels.size();
+    pending.push_back(std::move(up));
+    return id;
+}
+
+void GLwinImageAtlas::RemoveImage(uint32_t image)
+{
+    if (image == GLWIN_IMAGE_NONE || image >= images.size() || !images[image].alive) return;
+    Image& img = images[image];
+    Release(img.layer, { img.rect.x, img.rect.y, img.rect.w + GLWIN_IMAGE_GUTTER, img.rect.h + GLWIN_IMAGE_GUTTER });
+    img.alive = false;
+    img.ready = false;
+    img.layer = -1;
+    WriteEntry(image);
+    freeImages.push_back(image);
+    // a queued upload is skipped when its serial no longer matches
+}
+
+bool GLwinImageAtlas::IsReady(uint32_t image) const
+{
+    return image < images.size() && images[image].alive && images[image].ready;
+}
+
+bool GLwinImageAtlas::GetImageSize(uint32_t image, int* width, int* height) const
+{
+    if (image == GLWIN_IMAGE_NONE || image >= images.size() || !images[image].alive) return false;
+    if (width) *width = images[image].rect.w;
+    if (height) *height = images[image].rect.h;
+    return true;
+}
+
+// Best area fit over every layer's free list, then a guillotine split along the shorter leftover
+bool GLwinImageAtlas::Allocate(int w, int h, int* outLayer, Rect* out)
+{
+    if (w > layerSize || h > layerSize) return false;
+
+    int bestLayer = -1;
+    size_t bestIndex = 0;
+    long long bestWaste = 0;
+    for (int l = 0; l < (int)layers.size(); ++l) {
+        const std::vector<Rect>& rects = layers[l].freeRects;
+        for (size_t i = 0; i < rects.size(); ++i) {
+            const Rect& f = rects[i];
+            if (f.w < w || f.h < h) continue;
+            long long waste = (long long)f.w * f.h - (long long)w * h;
+            if (bestLayer < 0 || waste < bestWaste) {
+                bestLayer = l;
+                bestIndex = i;
+                bestWaste = waste;
+            }
+        }
+    }
+    if (bestLayer < 0) {
+        if (!AddLayer()) return false;
+        bestLayer = (int)layers.size() - 1;
+        bestIndex = 0;
+    }
+
+    Layer& layer = layers[bestLayer];
+    Rect f = layer.freeRects[bestIndex];
+    layer.freeRects[bestIndex] = layer.freeRects.back();
+    layer.freeRects.pop_back();
+
+    Rect right, bottom;
+    if (f.w - w < f.h - h) {
+        right = { f.x + w, f.y, f.w - w, h };
+        bottom = { f.x, f.y + h, f.w, f.h - h };
+    }
+    else {
+        right = { f.x + w, f.y, f.w - w, f.h };
+        bottom = { f.x, f.y + h, w, f.h - h };
+    }
+    if (right.w > 0 && right.h > 0) layer.freeRects.push_back(right);
+    if (bottom.w > 0 && bottom.h > 0) layer.freeRects.push_back(bottom);
+
+    layer.usedArea += w * h;
+    *outLayer = bestLayer;
+    *out = { f.x, f.y, w, h };
+    return true;
+}
+
+// Return a rect to its layer, merging with free rects that share a whole edge
+void GLwinImageAtlas::Release(int l, const Rect& r)
+{
+    if (l < 0 || l >= (int)layers.size()) return;
+    Layer& layer = layers[l];
+    layer.usedArea -= r.w * r.h;
+    if (layer.usedArea == 0) {
+        // pairwise merging can't always undo a chain of guillotine splits; an empty layer can
+        layer.freeRects.assign(1, { 0, 0, layerSize, layerSize });
+        return;
+    }
+
+    Rect cur = r;
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < layer.freeRects.size(); ++i) {
+            const Rect& f = layer.freeRects[i];
+            if (f.y == cur.y && f.h == cur.h && (f.x + f.w == cur.x || cur.x + cur.w == f.x)) {
+                cur = { std::min(f.x, cur.x), cur.y, f.w + cur.w, cur.h };
+            }
+            else if (f.x == cur.x && f.w == cur.w && (f.y + f.h == cur.y || cur.y + cur.h == f.y)) {
+                cur = { cur.x, std::min(f.y, cur.y), cur.w, f.h + cur.h };
+            }
+            else {
+                continue;
+            }
+            layer.freeRects[i] = layer.freeRects.back();
+            layer.freeRects.pop_back();
+            merged = true;
+            break;
+        }
+    }
+    layer.freeRects.push_back(cur);
+}
+
+bool GLwinImageAtlas::AddLayer()
+{
+    if ((int)layers.size() >= maxLayers) return false;
+    if (!EnsureTextureLayers((int)layers.size() + 1)) return false;
+    layers.emplace_back();
+    layers.back().freeRects.push_back({ 0, 0, layerSize, layerSize });
+    return true;
+}
+
+// Texture storage is immutable, so growing means a new texture and a GPU side copy of the old layers
+bool GLwinImageAtlas::EnsureTextureLayers(int count)
+{
+    if (count <= textureLayers) return true;
+    int newLayers = std::max(count, std::min(maxLayers, textureLayers ? textureLayers * 2 : 1));
+
+    GLwinGLState& gl = GLwinGLState::Get();
+    GLuint grown = 0;
+    glGenTextures(1, &grown);
+    gl.BindTexture(GLWIN_IMAGE_TEXTURE_UNIT, GL_TEXTURE_2D_ARRAY, grown);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, layerSize, layerSize, newLayers);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLWIN_LOG_INFO("Image atlas grown to " << newLayers << " layers of " << layerSize << "x" << layerSize);
+
+    if (texture) {
+        glCopyImageSubData(texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+            grown, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, layerSize, layerSize, textureLayers);
+        gl.ForgetTexture(texture);
+        glDeleteTextures(1, &texture);
+    }
+    texture = grown;
+    textureLayers = newLayers;
+    return true;
+}
+
+void GLwinImageAtlas::WriteEntry(uint32_t id)
+{
+    const Image& img = images[id];
+    GLwinImageEntry& e = table[id];
+    float inv = 1.0f / (float)layerSize;
+    e.u0 = img.rect.x * inv;
+    e.v0 = img.rect.y * inv;
+    e.u1 = (img.rect.x + img.rect.w) * inv;
+    e.v1 = (img.rect.y + img.rect.h) * inv;
+    // drawn flat until the last row has been uploaded
+    e.layer = (img.alive && img.ready) ? img.layer : -1;
+
+    if (dirtyBegin >= dirtyEnd) {
+        dirtyBegin = id;
+        dirtyEnd = id + 1;
+    }
+    else {
+        dirtyBegin = std::min(dirtyBegin, (size_t)id);
+        dirtyEnd = std::max(dirtyEnd, (size_t)id + 1);
+    }
+}
+
+void GLwinImageAtlas::WaitForSlice(int s)
+{
+    if (!fences[s]) return;
+    // normally already signalled: the slice was last used sliceCount uploads ago
+    GLenum r = glClientWaitSync(fences[s], 0, 0);
+    while (r == GL_TIMEOUT_EXPIRED) {
+        r = glClientWaitSync(fences[s], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    glDeleteSync(fences[s]);
+    fences[s] = nullptr;
+}
+
+void GLwinImageAtlas::Upload()
+{
+    GLwinGLState& gl = GLwinGLState::Get();
+
+    if (!pending.empty() && pboMapped && texture) {
+        WaitForSlice(slice);
+        unsigned char* base = pboMapped + uploadBudget * slice;
+        size_t used = 0;
+
+        gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        gl.BindTexture(GLWIN_IMAGE_TEXTURE_UNIT, GL_TEXTURE_2D_ARRAY, texture);
+        while (!pending.empty()) {
+            PendingUpload& up = pending.front();
+            Image& img = images[up.image];
+            if (!img.alive || img.serial != up.serial) {
+                pendingBytes -= up.pixels.size();
+                pending.pop_front();
+                continue;
+            }
+            // partial images continue next frame, row by row
+            size_t rowBytes = (size_t)img.rect.w * 4;
+            int rows = (int)std::min<size_t>((size_t)(img.rect.h - up.rowsDone), (uploadBudget - used) / rowBytes);
+            if (rows <= 0) break;
+
+            size_t bytes = rowBytes * rows;
+            memcpy(base + used, up.pixels.data() + rowBytes * up.rowsDone, bytes);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, img.rect.x, img.rect.y + up.rowsDone, img.layer,
+                img.rect.w, rows, 1, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)(uintptr_t)(uploadBudget * slice + used));
+            used += bytes;
+            up.rowsDone += rows;
+
+            if (up.rowsDone == img.rect.h) {
+                img.ready = true;
+                WriteEntry(up.image);
+                pendingBytes -= up.pixels.size();
+                pending.pop_front();
+            }
+        }
+        gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if (used > 0) {
+            fences[slice] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slice = (slice + 1) % sliceCount;
+        }
+    }
+
+    // image table: grow by doubling, otherwise only the changed range goes up
+    if (dirtyBegin < dirtyEnd) {
+        gl.BindBuffer(GL_SHADER_STORAGE_BUFFER, tableBuffer);
+        if (tableCapacity < table.size()) {
+            tableCapacity = std::max(table.size(), tableCapacity * 2);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)(tableCapacity * sizeof(GLwinImageEntry)), nullptr, GL_DYNAMIC_DRAW);
+            dirtyBegin = 0;
+            dirtyEnd = table.size();
+        }
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, (GLintptr)(dirtyBegin * sizeof(GLwinImageEntry)),
+            (GLsizeiptr)((dirtyEnd - dirtyBegin) * sizeof(GLwinImageEntry)), table.data() + dirtyBegin);
+        dirtyBegin = dirtyEnd = 0;
+    }
+}
+
+void GLwinImageAtlas::Bind()
+{
+    GLwinGLState& gl = GLwinGLState::Get();
+    gl.BindTexture(GLWIN_IMAGE_TEXTURE_UNIT, GL_TEXTURE_2D_ARRAY, texture);
+    if (tableCapacity > 0) {
+        gl.BindBufferRange(GL_SHADER_STORAGE_BUFFER, GLWIN_IMAGE_TABLE_BINDING, tableBuffer, 0,
+            (GLsizeiptr)(tableCapacity * sizeof(GLwinImageEntry)));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Batch
+// ----------------------------------------------------------------------------
+
+GLwinImageBatch::GLwinImageBatch(size_t maxInstances)
+    : capacity(maxInstances > 0 ? maxInstances : 1)
+{
+    instances.reserve(capacity);
+    owners.reserve(capacity);
+
+    GLwinGLState& gl = GLwinGLState::Get();
+    glGenVertexArrays(1, &vao);
+    gl.BindVertexArray(vao);
+    glGenBuffers(1, &instanceBuffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity * sizeof(GLwinImageInstance)), nullptr, GL_STREAM_DRAW);
+
+    // No per-vertex data: the quad corners come from gl_VertexID
+    const GLsizei stride = sizeof(GLwinImageInstance);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(GLwinImageInstance, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, stride, (void*)offsetof(GLwinImageInstance, image));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(GLwinImageInstance, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+}
+
+GLwinImageBatch::~GLwinImageBatch()
+{
+    GLwinGLState& gl = GLwinGLState::Get();
+    gl.ForgetVertexArray(vao);
+    gl.ForgetBuffer(instanceBuffer);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &instanceBuffer);
+}
+
+void GLwinImageBatch::FlushOwner(GLwinImageAtlas& atlas, Shader* shader, const void* owner)
+{
+    // pull this owner's quads out and close the gap behind them
+    ownerScratch.clear();
+    size_t kept = 0;
+    for (size_t i = 0; i < instances.size(); ++i) {
+        if (owners[i] == owner) {
+            ownerScratch.push_back(instances[i]);
+            continue;
+        }
+        instances[kept] = instances[i];
+        owners[kept] = owners[i];
+        ++kept;
+    }
+    if (ownerScratch.empty()) return;
+    instances.resize(kept);
+    owners.resize(kept);
+    ownerDrawCalls += Draw(atlas, shader, ownerScratch.data(), ownerScratch.size());
+}
+
+void GLwinImageBatch::Flush(GLwinImageAtlas& atlas, Shader* shader)
+{
+    lastDrawCalls = ownerDrawCalls + Draw(atlas, shader, instances.data(), instances.size());
+    ownerDrawCalls = 0;
+    Clear();
+}
+
+int GLwinImageBatch::Draw(GLwinImageAtlas& atlas, Shader* shader, const GLwinImageInstance* data, size_t total)
+{
+    if (total == 0 || !shader) return 0;
+
+    GLwinGLState& gl = GLwinGLState::Get();
+    shader->Use();
+    atlas.Bind();
+    gl.SetBlend(true);
+    gl.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    gl.BindVertexArray(vao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+    int draws = 0;
+    for (size_t first = 0; first < total; first += capacity) {
+        size_t count = std::min(capacity, total - first);
+        // orphan so the driver never waits on the previous draw still reading the buffer
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity * sizeof(GLwinImageInstance)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(count * sizeof(GLwinImageInstance)), data + first);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+        ++draws;
+    }
+    return draws;
+}
@@ -0,0 +1,294 @@
+#include "../gui/GLwinLayout.h"
+#include <algorithm>
+
+GLwinLayoutNode* GLwinLayoutNode::AddChild(std::unique_ptr<GLwinLayoutNode> child)
+{
+    if (!child) return nullptr;
+    child->parent = this;
+    children.push_back(std::move(child));
+    MarkDirtyBothAxes();
+    return children.back().get();
+}
+
+GLwinLayoutNode* GLwinLayoutNode::AddChild(GLwinLayoutType childType, BaseGui* childGui)
+{
+    return AddChild(std::make_unique<GLwinLayoutNode>(childType, childGui));
+}
+
+void GLwinLayoutNode::RemoveChild(GLwinLayoutNode* child)
+{
+    auto it = std::find_if(children.begin(), children.end(),
+        [&](const std::unique_ptr<GLwinLayoutNode>& c) { return c.get() == child; });
+    if (it == children.end()) return;
+    children.erase(it);
+    MarkDirtyBothAxes();
+}
+
+void GLwinLayoutNode::SetType(GLwinLayoutType t)
+{
+    if (type == t) return;
+    type = t;
+    MarkDirtyBothAxes();
+}
+
+void GLwinLayoutNode::SetSize(int axis, GLwinLayoutSize s)
+{
+    if (size[axis].unit == s.unit && size[axis].value == s.value) return;
+    size[axis] = s;
+    MarkDirty(axis);
+}
+
+void GLwinLayoutNode::SetMinSize(int axis, float v)
+{
+    if (minSize[axis] == v) return;
+    minSize[axis] = v;
+    MarkDirty(axis);
+}
+
+void GLwinLayoutNode::SetMaxSize(int axis, float v)
+{
+    if (maxSize[axis] == v) return;
+    maxSize[axis] = v;
+    MarkDirty(axis);
+}
+
+void GLwinLayoutNode::SetContentSize(float cw, float ch)
+{
+    if (contentSize[GLWIN_AXIS_X] != cw) {
+        contentSize[GLWIN_AXIS_X] = cw;
+        MarkDirty(GLWIN_AXIS_X);
+    }
+    if (contentSize[GLWIN_AXIS_Y] != ch) {
+        contentSize[GLWIN_AXIS_Y] = ch;
+        MarkDirty(GLWIN_AXIS_Y);
+    }
+}
+
+void GLwinLayoutNode::SetPadding(float p)
+{
+    if (padding == p) return;
+    padding = p;
+    MarkDirtyBothAxes();
+}
+
+void GLwinLayoutNode::SetGap(float g)
+{
+    if (gap == g) return;
+    gap = g;
+    MarkDirtyBothAxes();
+}
+
+void GLwinLayoutNode::SetDock(GLwinDock d)
+{
+    if (dock == d) return;
+    dock = d;
+    if (parent) parent->MarkDirtyBothAxes();
+}
+
+void GLwinLayoutNode::SetGui(BaseGui* g)
+{
+    if (gui == g) return;
+    gui = g;
+    rectPending = g != nullptr;
+    // sizes don't depend on the gui, only the arrange pass has to come down here again
+    for (GLwinLayoutNode* n = this; n; n = n->parent) {
+        bool wasValid = n->arrangeValid;
+        n->arrangeValid = false;
+        if (!wasValid && n != this) break;
+    }
+}
+
+// Invalidate this node and walk up until a parent is already dirty on that axis
+void GLwinLayoutNode::MarkDirty(int axis)
+{
+    GLwinLayoutNode* n = this;
+    while (n) {
+        bool wasValid = n->measureValid[axis] || n->arrangeValid;
+        n->measureValid[axis] = false;
+        n->arrangeValid = false;
+        if (!wasValid && n != this) break;
+        n = n->parent;
+    }
+}
+
+float GLwinLayoutNode::Clamp(int axis, float v) const
+{
+    return std::max(minSize[axis], std::min(maxSize[axis], v));
+}
+
+float GLwinLayoutNode::Measure(int axis)
+{
+    if (!measureValid[axis]) {
+        measured[axis] = ComputeMeasure(axis);
+        measureValid[axis] = true;
+    }
+    return measured[axis];
+}
+
+float GLwinLayoutNode::ComputeMeasure(int axis)
+{
+    if (size[axis].unit == GLwinLayoutSize::Pixels)
+        return Clamp(axis, size[axis].value);
+
+    float result = contentSize[axis];
+    float fromChildren = 0.0f;
+
+    bool mainAxis = (type == GLwinLayoutType::Row && axis == GLWIN_AXIS_X) ||
+        (type == GLwinLayoutType::Column && axis == GLWIN_AXIS_Y);
+
+    if (mainAxis) {
+        for (auto& c : children) fromChildren += c->Measure(axis);
+        if (children.size() > 1) fromChildren += gap * (float)(children.size() - 1);
+    }
+    else if (type == GLwinLayoutType::Dock) {
+        // docked edges along this axis add up, everything else overlaps
+        float edges = 0.0f, rest = 0.0f;
+        for (auto& c : children) {
+            bool alongAxis = axis == GLWIN_AXIS_X
+                ? (c->dock == GLwinDock::Left || c->dock == GLwinDock::Right)
+                : (c->dock == GLwinDock::Top || c->dock == GLwinDock::Bottom);
+            if (alongAxis) edges += c->Measure(axis);
+            else rest = std::max(rest, c->Measure(axis));
+        }
+        fromChildren = edges + rest;
+    }
+    else {
+        for (auto& c : children) fromChildren = std::max(fromChildren, c->Measure(axis));
+    }
+
+    result = std::max(result, fromChildren) + padding * 2.0f;
+    return Clamp(axis, result);
+}
+
+// Size of this node along an axis given the space the parent offers.
+// `stretch` is used for Auto/Flex when the parent wants the node to fill.
+float GLwinLayoutNode::Resolve(int axis, float parentSize, float stretch)
+{
+    switch (size[axis].unit) {
+    case GLwinLayoutSize::Pixels:  return Clamp(axis, size[axis].value);
+    case GLwinLayoutSize::Percent: return Clamp(axis, parentSize * size[axis].value * 0.01f);
+    default:                       return Clamp(axis, stretch);
+    }
+}
+
+void GLwinLayoutNode::Arrange(float ax, float ay, float aw, float ah, std::vector<GLwinLayoutNode*>* changed)
+{
+    bool sameRect = (x == ax && y == ay && w == aw && h == ah);
+    if (sameRect && arrangeValid) return; // nothing above or below us changed
+
+    x = ax; y = ay; w = aw; h = ah;
+    if ((!sameRect || rectPending) && changed) changed->push_back(this);
+    rectPending = false;
+
+    float ix = x + padding;
+    float iy = y + padding;
+    float iw = std::max(0.0f, w - padding * 2.0f);
+    float ih = std::max(0.0f, h - padding * 2.0f);
+
+    switch (type) {
+    case GLwinLayoutType::Row:
+        ArrangeLinear(GLWIN_AXIS_X, ix, iy, iw, ih, changed);
+        break;
+    case GLwinLayoutType::Column:
+        ArrangeLinear(GLWIN_AXIS_Y, ix, iy, iw, ih, changed);
+        break;
+    case GLwinLayoutType::Stack:
+        for (auto& c : children) {
+            float cw = c->Resolve(GLWIN_AXIS_X, iw, iw);
+            float ch = c->Resolve(GLWIN_AXIS_Y, ih, ih);
+            c->Arrange(ix, iy, cw, ch, changed);
+        }
+        break;
+    case GLwinLayoutType::Dock:
+        ArrangeDock(ix, iy, iw, ih, changed);
+        break;
+    }
+
+    arrangeValid = true;
+}
+
+void GLwinLayoutNode::ArrangeLinear(int mainAxis, float ix, float iy, float iw, float ih, std::vector<GLwinLayoutNode*>* changed)
+{
+    int crossAxis = 1 - mainAxis;
+    float mainSize = mainAxis == GLWIN_AXIS_X ? iw : ih;
+    float crossSize = mainAxis == GLWIN_AXIS_X ? ih : iw;
+
+    size_t count = children.size();
+    if (count == 0) return;
+
+    // First pass: fixed, percent and auto sizes, collect flex weights
+    std::vector<float> sizes(count, 0.0f);
+    float used = gap * (float)(count - 1);
+    float totalFlex = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        GLwinLayoutNode* c = children[i].get();
+        if (c->size[mainAxis].unit == GLwinLayoutSize::Flex) {
+            totalFlex += c->size[mainAxis].value;
+            sizes[i] = c->Clamp(mainAxis, 0.0f);
+        }
+        else {
+            sizes[i] = c->Resolve(mainAxis, mainSize, c->Measure(mainAxis));
+        }
+        used += sizes[i];
+    }
+
+    // Second pass: hand out what's left to flex children by weight
+    float remaining = mainSize - used;
+    if (totalFlex > 0.0f && remaining > 0.0f) {
+        for (size_t i = 0; i < count; ++i) {
+            GLwinLayoutNode* c = children[i].get();
+            if (c->size[mainAxis].unit != GLwinLayoutSize::Flex) continue;
+            float share = remaining * (c->size[mainAxis].value / totalFlex);
+            sizes[i] = c->Clamp(mainAxis, sizes[i] + share);
+        }
+    }
+
+    float pos = mainAxis == GLWIN_AXIS_X ? ix : iy;
+    for (size_t i = 0; i < count; ++i) {
+        GLwinLayoutNode* c = children[i].get();
+        float cross = c->Resolve(crossAxis, crossSize, crossSize);
+        if (mainAxis == GLWIN_AXIS_X)
+            c->Arrange(pos, iy, sizes[i], cross, changed);
+        else
+            c->Arrange(ix, pos, cross, sizes[i], changed);
+        pos += sizes[i] + gap;
+    }
+}
+
+void GLwinLayoutNode::ArrangeDock(float ix, float iy, float iw, float ih, std::vector<GLwinLayoutNode*>* changed)
+{
+    float left = ix, top = iy, right = ix + iw, bottom = iy + ih;
+    for (auto& c : children) {
+        float rw = std::max(0.0f, right - left);
+        float rh = std::max(0.0f, bottom - top);
+        switch (c->dock) {
+        case GLwinDock::Left: {
+            float cw = std::min(rw, c->Resolve(GLWIN_AXIS_X, iw, c->Measure(GLWIN_AXIS_X)));
+            c->Arrange(left, top, cw, rh, changed);
+            left += cw + gap;
+            break;
+        }
+        case GLwinDock::Right: {
+            float cw = std::min(rw, c->Resolve(GLWIN_AXIS_X, iw, c->Measure(GLWIN_AXIS_X)));
+            c->Arrange(right - cw, top, cw, rh, changed);
+            right -= cw + gap;
+            break;
+        }
+        case GLwinDock::Top: {
+            float ch = std::min(rh, c->Resolve(GLWIN_AXIS_Y, ih, c->Measure(GLWIN_AXIS_Y)));
+            c->Arrange(left, top, rw, ch, changed);
+            top += ch + gap;
+            break;
+        }
+        case GLwinDock::Bottom: {
+            float ch = std::min(rh, c->Resolve(GLWIN_AXIS_Y, ih, c->Measure(GLWIN_AXIS_Y)));
+            c->Arrange(left, bottom - ch, rw, ch, changed);
+            bottom -= ch + gap;
+            break;
+        }
+        case GLwinDock::Fill:
+            c->Arrange(left, top, rw, rh, changed);
+            break;
+        }
+    }
+}
@@ -0,0 +1,256 @@
+#include "../gui/GLwinTextLayout.h"
+#include <algorithm>
+#include <cstring>
+
+uint32_t GLwinDecodeUtf8(const char* text, size_t length, size_t& i)
+{
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(text);
+    uint8_t c = s[i];
+    if (c < 0x80) {
+        ++i;
+        return c;
+    }
+
+    int extra;
+    uint32_t cp;
+    if ((c & 0xE0) == 0xC0) { extra = 1; cp = c & 0x1F; }
+    else if ((c & 0xF0) == 0xE0) { extra = 2; cp = c & 0x0F; }
+    else if ((c & 0xF8) == 0xF0) { extra = 3; cp = c & 0x07; }
+    else { ++i; return 0xFFFD; }
+
+    for (int k = 1; k <= extra; ++k) {
+        if (i + k >= length || (s[i + k] & 0xC0) != 0x80) {
+            ++i;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (s[i + k] & 0x3F);
+    }
+    // reject overlong forms, surrogates and out of range values
+    static const uint32_t minValue[4] = { 0, 0x80, 0x800, 0x10000 };
+    if (cp < minValue[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        ++i;
+        return 0xFFFD;
+    }
+    i += extra + 1;
+    return cp;
+}
+
+// ----------------------------------------------------------------------------
+// Shaper
+// ----------------------------------------------------------------------------
+
+GLwinTextShaper::GLwinTextShaper(GLwinFontCache* fonts, int font, int pixelSize, size_t cacheCapacity)
+    : fonts(fonts), font(font), pixelSize(pixelSize), capacity(cacheCapacity > 0 ? cacheCapacity : 1)
+{
+    float descent = 0.0f, gap = 0.0f;
+    if (fonts) fonts->GetLineMetrics(font, pixelSize, &ascent, &descent, &gap);
+    lineHeight = ascent + descent + gap;
+    if (lineHeight <= 0.0f) lineHeight = (float)pixelSize * 1.2f;
+}
+
+void GLwinTextShaper::Clear()
+{
+    cache.clear();
+    lru.clear();
+}
+
+// FNV-1a over the bytes, with the wrap width mixed in (same text wraps differently)
+uint64_t GLwinTextShaper::HashLine(const char* text, size_t length, float wrapWidth)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= (uint8_t)text[i];
+        h *= 1099511628211ull;
+    }
+    uint32_t w;
+    memcpy(&w, &wrapWidth, sizeof(w));
+    h ^= w;
+    h *= 1099511628211ull;
+    h ^= length;
+    h *= 1099511628211ull;
+    return h;
+}
+
+const GLwinShapedLine& GLwinTextShaper::Shape(const char* text, size_t length, float wrapWidth)
+{
+    if (wrapWidth < 0.0f) wrapWidth = 0.0f;
+    uint64_t key = HashLine(text, length, wrapWidth);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        Entry& e = it->second;
+        lru.splice(lru.begin(), lru, e.lru);
+        if (e.Matches(text, length, wrapWidth)) return e.line;
+        // another line with the same hash: it takes the slot over
+        e.text.assign(text, length);
+        e.wrapWidth = wrapWidth;
+        ShapeInto(text, length, wrapWidth, e.line);
+        return e.line;
+    }
+
+    if (cache.size() >= capacity) {
+        cache.erase(lru.back());
+        lru.pop_back();
+    }
+    lru.push_front(key);
+    Entry& e = cache[key];
+    e.lru = lru.begin();
+    e.text.assign(text, length);
+    e.wrapWidth = wrapWidth;
+    ShapeInto(text, length, wrapWidth, e.line);
+    return e.line;
+}
+
+uint32_t GLwinTextShaper::CountRows(const char* text, size_t length, float wrapWidth)
+{
+    if (wrapWidth < 0.0f) wrapWidth = 0.0f;
+    auto it = cache.find(HashLine(text, length, wrapWidth));
+    if (it != cache.end() && it->second.Matches(text, length, wrapWidth)) return (uint32_t)it->second.line.rows.size();
+    ShapeInto(text, length, wrapWidth, scratch);
+    return (uint32_t)scratch.rows.size();
+}
+
+void GLwinTextShaper::ShapeInto(const char* text, size_t length, float wrapWidth, GLwinShapedLine& out)
+{
+    out.glyphs.clear();
+    out.rows.clear();
+    out.glyphs.reserve(length);
+
+    // Place glyphs along one long line, applying kerning between neighbours
+    float pen = 0.0f;
+    uint32_t prev = 0;
+    for (size_t i = 0; i < length;) {
+        uint32_t cp = GLwinDecodeUtf8(text, length, i);
+        if (cp == '\r') continue;
+        if (cp == '\t') cp = ' ';
+        GLwinGlyph g;
+        if (!fonts || !fonts->GetGlyph(font, pixelSize, cp, &g)) {
+            if (!fonts || !fonts->GetGlyph(font, pixelSize, '?', &g)) continue;
+            cp = '?';
+        }
+        if (prev && fonts) pen += fonts->GetKerning(font, pixelSize, prev, cp);
+        out.glyphs.push_back({ cp, pen, g.advance });
+        pen += g.advance;
+        prev = cp;
+    }
+
+    // Greedy word wrap: break after the last space that fits, or mid-word if there is none
+    uint32_t count = (uint32_t)out.glyphs.size();
+    if (wrapWidth <= 0.0f || count == 0) {
+        out.rows.push_back({ 0, count, pen });
+        return;
+    }
+
+    uint32_t rowStart = 0;
+    while (rowStart < count) {
+        float origin = out.glyphs[rowStart].x;
+        uint32_t lastBreak = UINT32_MAX;
+        uint32_t end = rowStart;
+        while (end < count) {
+            const GLwinShapedGlyph& g = out.glyphs[end];
+            float right = g.x - origin + g.advance;
+            if (right > wrapWidth && end > rowStart) break;
+            if (g.codepoint == ' ') lastBreak = end;
+            ++end;
+        }
+        if (end < count && lastBreak != UINT32_MAX && lastBreak > rowStart) end = lastBreak + 1;
+
+        GLwinShapedRow row;
+        row.firstGlyph = rowStart;
+        row.glyphCount = end - rowStart;
+        const GLwinShapedGlyph& last = out.glyphs[end - 1];
+        row.width = last.x - origin + last.advance;
+        out.rows.push_back(row);
+        rowStart = end;
+    }
+
+    // Rebase glyph x so each row starts at 0
+    for (const GLwinShapedRow& row : out.rows) {
+        float origin = out.glyphs[row.firstGlyph].x;
+        for (uint32_t k = 0; k < row.glyphCount; ++k) out.glyphs[row.firstGlyph + k].x -= origin;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Text view
+// ----------------------------------------------------------------------------
+
+GLwinTextView::GLwinTextView(GLwinFontCache* fonts, int font, int pixelSize)
+    : shaper(fonts, font, pixelSize)
+{
+    rowPrefix.push_back(0);
+}
+
+void GLwinTextView::AppendLine(const char* text, size_t length)
+{
+    lineStart.push_back((uint32_t)buffer.size());
+    lineLength.push_back((uint32_t)length);
+    buffer.append(text, length);
+}
+
+void GLwinTextView::AppendText(const char* text, size_t length)
+{
+    size_t start = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] == '\n') {
+            AppendLine(text + start, i - start);
+            start = i + 1;
+        }
+    }
+    if (start < length) AppendLine(text + start, length - start);
+}
+
+void GLwinTextView::Clear()
+{
+    buffer.clear();
+    lineStart.clear();
+    lineLength.clear();
+    rowPrefix.assign(1, 0);
+    rowCountsValid = 0;
+    scrollY = 0.0f;
+}
+
+void GLwinTextView::SetWrapWidth(float width)
+{
+    if (width < 0.0f) width = 0.0f;
+    if (width == wrapWidth) return;
+    wrapWidth = width;
+    rowPrefix.assign(1, 0);
+    rowCountsValid = 0;
+}
+
+void GLwinTextView::EnsureRowCounts(size_t upToLine)
+{
+    upToLine = std::min(upToLine, lineStart.size());
+    // counting doesn't go through the line cache, so measuring a large buffer once (for the
+    // scrollbar) doesn't evict the lines on screen
+    while (rowCountsValid < upToLine) {
+        size_t line = rowCountsValid;
+        uint32_t rows = shaper.CountRows(buffer.data() + lineStart[line], lineLength[line], wrapWidth);
+        rowPrefix.push_back(rowPrefix.back() + rows);
+        ++rowCountsValid;
+    }
+}
+
+size_t GLwinTextView::RowsBefore(size_t line)
+{
+    EnsureRowCounts(line);
+    return rowPrefix[std::min(line, rowCountsValid)];
+}
+
+size_t GLwinTextView::LineForRow(size_t row)
+{
+    // Measure forward only as far as needed, then binary search the prefix sums
+    while (rowCountsValid < lineStart.size() && rowPrefix.back() <= row) {
+        EnsureRowCounts(rowCountsValid + 1);
+    }
+    auto it = std::upper_bound(rowPrefix.begin(), rowPrefix.end(), (uint32_t)row);
+    return (size_t)(it - rowPrefix.begin()) - 1;
+}
+
+float GLwinTextView::GetContentHeight()
+{
+    float lh = shaper.GetLineHeight();
+    if (wrapWidth <= 0.0f) return (float)lineStart.size() * lh;
+    EnsureRowCounts(lineStart.size());
+    return (float)rowPrefix.back() * lh;
+}
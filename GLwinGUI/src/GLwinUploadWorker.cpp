@@ -0,0 +1,124 @@
+#include "../include/GLwinUploadWorker.h"
+#include "../../GLwin/include/GLwinContext.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include "../../GLwin/include/GLwinProfile.h"
+
+GLwinUploadWorker::GLwinUploadWorker(GLWIN_context* context, const char* name)
+    : context(context), name(name ? name : "Upload")
+{
+    if (!context) {
+        GLWIN_LOG_ERROR("GLwinUploadWorker '" << this->name << "' has no context, jobs will be dropped");
+        return;
+    }
+    thread = std::thread(&GLwinUploadWorker::Run, this);
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return started; });
+}
+
+GLwinUploadWorker::~GLwinUploadWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+    for (Done& d : done) glDeleteSync(d.fence);
+    GLwinDestroyContext(context);
+}
+
+void GLwinUploadWorker::Run()
+{
+    bool ok = GLwinMakeOffscreenContextCurrent(context) != 0;
+    if (!ok) GLWIN_LOG_ERROR("GLwinUploadWorker '" << name << "' could not make its context current, jobs will be dropped");
+    else GLwinProfileSetThreadName(name.c_str());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started = true;
+        running = ok;
+    }
+    finished.notify_all();
+    if (!ok) return;
+
+    for (;;) {
+        Queued item;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) break;
+            item = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        {
+            GLWIN_PROFILE_SCOPE("UploadJob");
+            item.job();
+        }
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // another context only ever sees the fence signal once it has been flushed to the GPU
+        glFlush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.push_back({ fence, std::move(item.ready) });
+        }
+        finished.notify_all();
+    }
+    GLwinMakeOffscreenContextCurrent(nullptr);
+}
+
+void GLwinUploadWorker::Submit(Job job, Job ready)
+{
+    if (!job) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running || stopping) return;
+        jobs.push_back({ std::move(job), std::move(ready) });
+        ++pending;
+    }
+    wake.notify_one();
+}
+
+int GLwinUploadWorker::Poll()
+{
+    GLWIN_PROFILE_SCOPE("UploadPoll");
+    int handed = 0;
+    for (;;) {
+        Done item;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done.empty()) break;
+            // one context's fences signal in order, so the first unsignalled one ends the scan.
+            // GL_WAIT_FAILED hands the job over too rather than wedging the queue.
+            if (glClientWaitSync(done.front().fence, 0, 0) == GL_TIMEOUT_EXPIRED) break;
+            item = std::move(done.front());
+            done.pop_front();
+            --pending;
+        }
+        glDeleteSync(item.fence);
+        if (item.ready) item.ready();
+        ++handed;
+    }
+    return handed;
+}
+
+void GLwinUploadWorker::Finish()
+{
+    for (;;) {
+        Poll();
+        std::unique_lock<std::mutex> lock(mutex);
+        if (pending == 0) return;
+        if (done.empty()) {
+            finished.wait(lock, [this] { return !done.empty(); });
+            continue;
+        }
+        // only this thread removes from done, so the fence stays valid once unlocked
+        GLsync fence = done.front().fence;
+        lock.unlock();
+        glClientWaitSync(fence, 0, 100000000);     // 100 ms, then look again
+    }
+}
+
+size_t GLwinUploadWorker::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
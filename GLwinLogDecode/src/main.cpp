@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <GLwinLog.h>
+#include <GLwinLogFile.h>
+#include <GLwinResource.h>
+
+// GLwinLogDecode: turns a binary GLwin log (GLwinLogOpenFile) back into text or JSON.
+//
+//   GLwinLogDecode [--json] [--level N] [--sites] <file>
+//
+// Text output is one line per record: seconds since the log was opened, thread, level, message.
+// --json writes a single JSON object with the header fields and a "records" array.
+// --level N keeps records at level N and below (0 INIT ... 5 DEBUG).
+// --sites adds file:line of structured records to the text output.
+
+static void PrintUsage()
+{
+	fprintf(stderr, "usage: GLwinLogDecode [--json] [--level N] [--sites] <file>\n");
+}
+
+static void AppendJsonString(std::string& out, const char* s, size_t n)
+{
+	out += '"';
+	for (size_t i = 0; i < n; ++i) {
+		unsigned char c = (unsigned char)s[i];
+		switch (c) {
+		case '"':  out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if (c < 0x20) {
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", c);
+				out += buf;
+			}
+			else {
+				out += (char)c;
+			}
+		}
+	}
+	out += '"';
+}
+
+static std::string FormatStartTime(int64_t seconds)
+{
+	time_t t = (time_t)seconds;
+	struct tm utc;
+#ifdef _WIN32
+	if (gmtime_s(&utc, &t) != 0) return "?";
+#else
+	if (!gmtime_r(&t, &utc)) return "?";
+#endif
+	char buf[32];
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &utc);
+	return buf;
+}
+
+int main(int argc, char** argv)
+{
+	bool json = false;
+	bool showSites = false;
+	int maxLevel = GLWIN_LOG_LEVEL_DEBUG;
+	const char* path = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--json") == 0) json = true;
+		else if (strcmp(argv[i], "--sites") == 0) showSites = true;
+		else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) maxLevel = atoi(argv[++i]);
+		else if (argv[i][0] == '-' || path) {
+			PrintUsage();
+			return 2;
+		}
+		else path = argv[i];
+	}
+	if (!path) {
+		PrintUsage();
+		return 2;
+	}
+
+	// the decoder's own diagnostics go to stderr, not into the output
+	GLwinLogSetConsole(0);
+
+	GLwinFileView view;
+	if (!GLwinMapFile(path, &view)) {
+		fprintf(stderr, "GLwinLogDecode: cannot open %s\n", path);
+		return 1;
+	}
+	GLwinLogFileReader reader;
+	if (!reader.Open(view.data, view.size)) {
+		fprintf(stderr, "GLwinLogDecode: %s is not a GLwin log file (or a newer version)\n", path);
+		GLwinUnmapFile(&view);
+		return 1;
+	}
+	const GLwinLogFileHeader& header = reader.GetHeader();
+
+	std::string out;
+	std::string message;
+	out.reserve(1 << 16);
+	if (json) {
+		out += "{\n  \"version\": " + std::to_string(header.version);
+		out += ",\n  \"tickFrequency\": " + std::to_string(header.tickFrequency);
+		out += ",\n  \"start\": \"" + FormatStartTime(header.startTime) + "\"";
+		out += ",\n  \"records\": [";
+	}
+	else {
+		out += "# GLwin log started " + FormatStartTime(header.startTime) + "\n";
+	}
+
+	GLwinLogFileEntry entry;
+	bool first = true;
+	char buf[64];
+	while (reader.Next(&entry)) {
+		if (entry.level > maxLevel) continue;
+		message.clear();
+		reader.FormatText(entry, message);
+		double seconds = reader.GetSeconds(entry.ticks);
+
+		if (json) {
+			out += first ? "\n    {" : ",\n    {";
+			first = false;
+			snprintf(buf, sizeof(buf), "\"time\": %.9f", seconds);
+			out += buf;
+			out += ", \"thread\": " + std::to_string(entry.thread);
+			out += ", \"level\": \"";
+			out += GLwinLogLevelName(entry.level);
+			out += "\"";
+			if (entry.kind == GLWIN_LOGFILE_DROPPED) out += ", \"dropped\": " + std::to_string(entry.dropped);
+			if (entry.site) {
+				out += ", \"file\": ";
+				AppendJsonString(out, entry.site->file.data(), entry.site->file.size());
+				out += ", \"line\": " + std::to_string(entry.site->line);
+			}
+			out += ", \"message\": ";
+			AppendJsonString(out, message.data(), message.size());
+			out += "}";
+		}
+		else {
+			snprintf(buf, sizeof(buf), "[%12.6f][T%u][", seconds, entry.thread);
+			out += buf;
+			out += GLwinLogLevelName(entry.level);
+			out += "] ";
+			out += message;
+			if (showSites && entry.site) out += "  (" + entry.site->file + ":" + std::to_string(entry.site->line) + ")";
+			out += '\n';
+		}
+		if (out.size() > (1 << 16) - 1024) {
+			fwrite(out.data(), 1, out.size(), stdout);
+			out.clear();
+		}
+	}
+	if (json) out += first ? "]\n}\n" : "\n  ]\n}\n";
+	fwrite(out.data(), 1, out.size(), stdout);
+
+	bool damaged = reader.IsDamaged();
+	GLwinUnmapFile(&view);
+	if (damaged) {
+		fprintf(stderr, "GLwinLogDecode: %s ends in a damaged record, output stops there\n", path);
+		return 3;
+	}
+	return 0;
+}
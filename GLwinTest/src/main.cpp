@@ -4,6 +4,7 @@
 #include <locale>
 #include <GLwin.h>  // Include the GLwin header file my GLFW
 #include <GLwinLog.h> // Include the GLwin logging header
+#include <GLwinProfile.h> // GLWIN_PROFILE_SCOPE zones and Chrome trace captures
 
 // The new code is on GitHub : https://github.com/Spidex3d/GLwin
 
@@ -32,6 +33,36 @@ static std::string WideToUtf8(const wchar_t* wstr) {
 	return out;
 }
 
+// Window moved to a monitor with another DPI (or the Windows scale setting changed)
+void OnContentScale(float xscale, float yscale) {
+	GLWIN_LOG_INFO("Content scale changed to " << xscale << " x " << yscale);
+}
+
+static GLWIN_window* g_window = nullptr;
+static int g_fbWidth = 0, g_fbHeight = 0;
+
+void OnFramebufferSize(int width, int height) {
+	g_fbWidth = width;
+	g_fbHeight = height;
+}
+
+void DrawFrame() {
+	glViewport(0, 0, g_fbWidth, g_fbHeight);
+	glClearColor(0.17f, 0.17f, 0.18f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	// -------------------------------- Rendering code goes here --------------------------------
+}
+
+// The main loop is blocked while the window frame is dragged; keep the contents up to date
+void OnLiveResize(int width, int height) {
+	DrawFrame();
+	GLwinSwapBuffers(g_window);
+}
+
+void OnIconify(int iconified) {
+	GLWIN_LOG_INFO((iconified ? "Minimised, rendering paused" : "Restored"));
+}
+
 // Drop callback signature:
 // typedef void(*GLwinDropCallback)(int count, const wchar_t** paths);
 void OnDrop(int count, const wchar_t** paths) {
@@ -65,6 +96,15 @@ int main() {
 	GLwinWindowHint(0, 0); // Not implemented
 	GLwinWindowHint(GLWIN_MAXIMIZED, GLWIN_FALSE); // Default is not maximized
 	GLwinWindowHint(GLWIN_RESIZABLE, GLWIN_TRUE); // Default is resizable
+	// The GUI shaders are #version 460
+	GLwinWindowHint(GLWIN_CONTEXT_VERSION_MAJOR, 4);
+	GLwinWindowHint(GLWIN_CONTEXT_VERSION_MINOR, 6);
+	GLwinWindowHint(GLWIN_OPENGL_PROFILE, GLWIN_OPENGL_CORE_PROFILE);
+#ifdef _DEBUG
+	GLwinWindowHint(GLWIN_OPENGL_DEBUG_CONTEXT, GLWIN_TRUE);
+#else
+	GLwinWindowHint(GLWIN_CONTEXT_NO_ERROR, GLWIN_TRUE); // no driver validation in release
+#endif
 
 	GLWIN_window* window = GLwin_CreateWindow(1200, 600, L"Starting GLwin! with Modern OpenGL");
 
@@ -87,9 +127,24 @@ int main() {
 	// Set a custom icon (make sure "icon.ico" exists in working directory next to the .exe file)
 	GLwinSetWindowIcon(window, L"icon_01.ico");
 	GLwinMakeContextCurrent(window);
-	int w, h;
-	GLwinGetFramebufferSize(window, &w, &h);
-	GLWIN_LOG_DEBUG("Framebuffer x= " << w << ", y= " << h);
+	g_window = window;
+	GLwinGetFramebufferSize(window, &g_fbWidth, &g_fbHeight);
+	GLWIN_LOGF_DEBUG("Framebuffer x= {}, y= {}", g_fbWidth, g_fbHeight);
+	GLwinSetFramebufferSizeCallback(window, OnFramebufferSize);
+	GLwinSetLiveResizeCallback(window, OnLiveResize);
+	GLwinSetIconifyCallback(window, OnIconify);
+
+	int monitorCount = 0;
+	const GLwinMonitor* monitors = GLwinGetMonitors(&monitorCount);
+	for (int i = 0; i < monitorCount; ++i) {
+		GLWIN_LOG_INFO("Monitor " << monitors[i].name << ": " << monitors[i].width << "x" << monitors[i].height
+			<< " @ " << monitors[i].refreshRate << " Hz, scale " << monitors[i].contentScale
+			<< (monitors[i].primary ? " (primary)" : ""));
+	}
+	float scaleX, scaleY;
+	GLwinGetContentScale(window, &scaleX, &scaleY);
+	GLWIN_LOG_INFO("Window content scale " << scaleX << " x " << scaleY);
+	GLwinSetContentScaleCallback(window, OnContentScale);
 
 	
 
@@ -127,6 +182,9 @@ int main() {
 
 	GLwinSetWindowTitle(window, L"Changed Window Title");
 
+	GLwinProfileSetThreadName("Main");
+	bool profileKeyDown = false;
+
 	while (!GLwinWindowShouldClose(window, 0)) {
 		double frameStart = GLwinGetTime(); // Start time of the frame
 
@@ -139,6 +197,19 @@ int main() {
 			//break; // Exit loop to close window
 			GLwinWindowShouldClose(window, 1);
 		}
+		// P starts a profile capture, pressing it again writes the trace (open it in ui.perfetto.dev or chrome://tracing)
+		bool profileKey = GLwinGetKey(window, GLWIN_KEY_P) == GLWIN_PRESS;
+		if (profileKey && !profileKeyDown) {
+			if (!GLwinProfileIsEnabled()) {
+				GLwinProfileEnable(true);
+				GLWIN_LOG_INFO("Profiling started, press P again to save the trace");
+			}
+			else {
+				GLwinProfileEnable(false);
+				GLwinProfileWriteTrace("GLwinTest.trace.json");
+			}
+		}
+		profileKeyDown = profileKey;
 		if (GLwinGetKey(window, GLWIN_SPACE) == GLWIN_PRESS) {
 			std::cout << "Space key is being held down." << std::endl;
 
@@ -151,13 +222,8 @@ int main() {
 		}
 			
 
-		glClearColor(0.17f, 0.17f, 0.18f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
-		glViewport(0, 0, w, h);
-		
-		// -------------------------------- Rendering code goes here --------------------------------
-
-		GLwinSwapBuffers(window);
+		DrawFrame();
+		GLwinSwapBuffers(window);	// presents nothing while minimised
 
 		// Throttle to target FPS
 		double frameEnd = GLwinGetTime();
@@ -0,0 +1,54 @@
+#include "GLwinTestHarness.h"
+#include "GLwinTestGL.h"
+#include <glad/glad.h>
+#include <GLwinContext.h>
+
+// Offscreen contexts are made with the version, profile and debug hints
+GLWIN_TEST(OffscreenContextHonoursHints)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+
+    GLwinWindowHint(GLWIN_CONTEXT_VERSION_MAJOR, 3);
+    GLwinWindowHint(GLWIN_CONTEXT_VERSION_MINOR, 3);
+    GLwinWindowHint(GLWIN_OPENGL_PROFILE, GLWIN_OPENGL_CORE_PROFILE);
+    GLwinWindowHint(GLWIN_OPENGL_DEBUG_CONTEXT, GLWIN_TRUE);
+    GLWIN_context* context = GLwinCreateOffscreenContext(nullptr);
+    GLwinDefaultWindowHints();
+    GLWIN_CHECK(context != nullptr);
+    if (!context) return;
+
+    // shares get the hints of the context they share with, not the (now default) current ones
+    GLWIN_context* shared = GLwinCreateOffscreenContext(context);
+    GLWIN_CHECK(shared != nullptr);
+
+    for (GLWIN_context* c : { context, shared }) {
+        if (!c || !GLwinMakeOffscreenContextCurrent(c)) continue;
+        GLint major = 0, minor = 0, flags = 0, mask = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &mask);
+        GLWIN_CHECK(major * 10 + minor >= 33);
+        GLWIN_CHECK((flags & GL_CONTEXT_FLAG_DEBUG_BIT) != 0);
+        GLWIN_CHECK((mask & GL_CONTEXT_CORE_PROFILE_BIT) != 0);
+    }
+
+    GLwinMakeOffscreenContextCurrent(GLwinTestGetGLContext());
+    GLwinDestroyContext(shared);
+    GLwinDestroyContext(context);
+}
+
+// A version the driver can't give fails instead of falling back
+GLWIN_TEST(OffscreenContextRejectsImpossibleVersion)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+
+    GLwinWindowHint(GLWIN_CONTEXT_VERSION_MAJOR, 9);
+    GLwinWindowHint(GLWIN_CONTEXT_VERSION_MINOR, 9);
+    GLwinWindowHint(GLWIN_OPENGL_PROFILE, GLWIN_OPENGL_CORE_PROFILE);
+    GLWIN_context* context = GLwinCreateOffscreenContext(nullptr);
+    GLwinDefaultWindowHints();
+    GLWIN_CHECK(context == nullptr);
+    GLwinDestroyContext(context);
+    GLwinMakeOffscreenContextCurrent(GLwinTestGetGLContext());
+}
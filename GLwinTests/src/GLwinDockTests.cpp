@@ -0,0 +1,121 @@
+#include "GLwinTestHarness.h"
+#include "GLwinTestGL.h"
+#include "../../GLwinGUI/gui/GLwinDock.h"
+#include "../../GLwinGUI/include/GLwinGLState.h"
+
+// Save/load only touches the tree, no GL calls
+struct DockPanels {
+    BaseGui panels[3];
+    DockPanels() {
+        for (int i = 0; i < 3; ++i) panels[i].winindex = i + 1;
+    }
+    // winindex -> panel, with `missing` gone since the layout was saved
+    std::function<BaseGui*(int)> Resolver(int missing) {
+        return [this, missing](int id) -> BaseGui* {
+            if (id == missing || id < 1 || id > 3) return nullptr;
+            return &panels[id - 1];
+        };
+    }
+};
+
+static std::vector<uint8_t> SaveTabs(DockPanels& p, int activeTab)
+{
+    GLwinDockManager dock;
+    for (BaseGui& panel : p.panels) dock.DockPanel(&panel, nullptr, GLwinDockZone::Center);
+    dock.SetActiveTab(dock.GetRoot(), activeTab);
+    return dock.SaveLayout();
+}
+
+GLWIN_TEST(DockLoadKeepsActivePanelWhenEarlierTabIsGone)
+{
+    DockPanels p;
+    std::vector<uint8_t> blob = SaveTabs(p, 2);
+    GLwinDockManager dock;
+    GLWIN_CHECK(dock.LoadLayout(blob.data(), blob.size(), p.Resolver(2)));
+    GLWIN_CHECK(dock.GetRoot()->tabs.size() == 2);
+    GLWIN_CHECK(dock.GetRoot()->ActivePanel() == &p.panels[2]);
+}
+
+GLWIN_TEST(DockLoadFallsBackWhenActivePanelIsGone)
+{
+    DockPanels p;
+    std::vector<uint8_t> blob = SaveTabs(p, 2);
+    GLwinDockManager dock;
+    GLWIN_CHECK(dock.LoadLayout(blob.data(), blob.size(), p.Resolver(3)));
+    GLWIN_CHECK(dock.GetRoot()->ActivePanel() == &p.panels[1]);
+
+    std::vector<uint8_t> first = SaveTabs(p, 0);
+    GLWIN_CHECK(dock.LoadLayout(first.data(), first.size(), p.Resolver(1)));
+    GLWIN_CHECK(dock.GetRoot()->activeTab == 0);
+    GLWIN_CHECK(dock.GetRoot()->ActivePanel() == &p.panels[1]);
+}
+
+GLWIN_TEST(DockAgainstOwnParentSplit)
+{
+    DockPanels p;
+    GLwinDockManager dock;
+    dock.DockPanel(&p.panels[0], nullptr, GLwinDockZone::Center);
+    dock.DockPanel(&p.panels[1], dock.GetRoot(), GLwinDockZone::Right);
+    GLWIN_CHECK(dock.GetRoot()->isSplit);
+
+    // undocking panel 0 collapses the root split that is the target
+    GLwinDockRegion* leaf = dock.DockPanel(&p.panels[0], dock.GetRoot(), GLwinDockZone::Left);
+    GLwinDockRegion* root = dock.GetRoot();
+    GLWIN_CHECK(leaf && leaf->tabs.size() == 1 && leaf->tabs[0] == &p.panels[0]);
+    GLWIN_CHECK(root->isSplit && root->first.get() == leaf && !root->parent);
+    GLWIN_CHECK(root->second && root->second->tabs.size() == 1 && root->second->tabs[0] == &p.panels[1]);
+    GLWIN_CHECK(root->second->parent == root && leaf->parent == root);
+}
+
+// The preview draws into whatever framebuffer the app renders the GUI to, and hands the
+// clear colour and read framebuffer back untouched
+GLWIN_TEST(DockPreviewRestoresAppState)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+    GLwinGLState::Get().SetFunctions(GLwinGLFunctionsFromGlad());
+    const int size = 64;
+    GLuint tex = 0, fbo = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, size, size);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+    GLWIN_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glViewport(0, 0, size, size);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    DockPanels p;
+    {
+        GLwinDockManager dock;
+        dock.SetRootRect(0.0f, 0.0f, (float)size, (float)size, size);
+        dock.DockPanel(&p.panels[0], nullptr, GLwinDockZone::Center);
+        dock.DockPanel(&p.panels[1], dock.GetRoot(), GLwinDockZone::Right);
+        dock.Layout([](BaseGui* g, int x, int y, int w, int h) { g->posX = x; g->posY = y; g->width = w; g->height = h; });
+
+        dock.BeginDrag(&p.panels[0], 8.0, 8.0);
+        dock.CapturePendingPreview();
+        dock.UpdateDrag(48.0, 32.0);
+        dock.DrawDragPreview();
+
+        GLint read = 0, draw = 0;
+        GLfloat clear[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clear);
+        GLWIN_CHECK(read == (GLint)fbo && draw == (GLint)fbo);
+        GLWIN_CHECK(clear[0] == 0.0f && clear[1] == 0.0f && clear[2] == 0.0f && clear[3] == 0.0f);
+
+        // the outline went into the app's framebuffer
+        uint32_t pixel = 0;
+        glReadPixels(size - 2, size / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &pixel);
+        GLWIN_CHECK(pixel != 0);
+        dock.CancelDrag();
+    }
+    GLWIN_CHECK(glGetError() == GL_NO_ERROR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    GLwinGLState::Get().ForgetTexture(tex);
+    glDeleteTextures(1, &tex);
+}
@@ -0,0 +1,134 @@
+#include "GLwinTestHarness.h"
+#include "../../GLwinGUI/include/GLwinGLState.h"
+
+// Mock function table: counts what reaches "GL" and plays the current context from a variable,
+// so the cache can be checked without a driver.
+struct MockGL {
+    int useProgram, bindVertexArray, bindBuffer, activeTexture, bindTexture, enable, disable;
+    GLuint lastProgram, lastTexture, lastUnit;
+    void* context;
+};
+static MockGL g_mock;
+
+static void APIENTRY MockUseProgram(GLuint p) { ++g_mock.useProgram; g_mock.lastProgram = p; }
+static void APIENTRY MockBindVertexArray(GLuint) { ++g_mock.bindVertexArray; }
+static void APIENTRY MockBindBuffer(GLenum, GLuint) { ++g_mock.bindBuffer; }
+static void APIENTRY MockBindBufferRange(GLenum, GLuint, GLuint, GLintptr, GLsizeiptr) {}
+static void APIENTRY MockActiveTexture(GLenum unit) { ++g_mock.activeTexture; g_mock.lastUnit = unit - GL_TEXTURE0; }
+static void APIENTRY MockBindTexture(GLenum, GLuint t) { ++g_mock.bindTexture; g_mock.lastTexture = t; }
+static void APIENTRY MockEnable(GLenum) { ++g_mock.enable; }
+static void APIENTRY MockDisable(GLenum) { ++g_mock.disable; }
+static void APIENTRY MockBlendFuncSeparate(GLenum, GLenum, GLenum, GLenum) {}
+static void APIENTRY MockScissor(GLint, GLint, GLsizei, GLsizei) {}
+static void APIENTRY MockViewport(GLint, GLint, GLsizei, GLsizei) {}
+static void* MockGetCurrentContext() { return g_mock.context; }
+
+// Installs the mock on this thread's cache for one test, then puts back a glad-backed table
+struct MockGLScope {
+    int contextA = 0, contextB = 0;
+    MockGLScope() {
+        g_mock = MockGL();
+        g_mock.context = &contextA;
+        GLwinGLFunctions fns;
+        fns.UseProgram = MockUseProgram;
+        fns.BindVertexArray = MockBindVertexArray;
+        fns.BindBuffer = MockBindBuffer;
+        fns.BindBufferRange = MockBindBufferRange;
+        fns.ActiveTexture = MockActiveTexture;
+        fns.BindTexture = MockBindTexture;
+        fns.Enable = MockEnable;
+        fns.Disable = MockDisable;
+        fns.BlendFuncSeparate = MockBlendFuncSeparate;
+        fns.Scissor = MockScissor;
+        fns.Viewport = MockViewport;
+        fns.GetCurrentContext = MockGetCurrentContext;
+        GLwinGLState::Get().SetFunctions(fns);
+    }
+    ~MockGLScope() { GLwinGLState::Get().SetFunctions(GLwinGLFunctionsFromGlad()); }
+};
+
+GLWIN_TEST(GLStateElidesRedundantCalls)
+{
+    MockGLScope mock;
+    GLwinGLState& gl = GLwinGLState::Get();
+    gl.BeginFrame();
+    gl.UseProgram(3);
+    gl.UseProgram(3);
+    gl.SetBlend(true);
+    gl.SetBlend(true);
+    gl.SetBlend(false);
+    GLWIN_CHECK(g_mock.useProgram == 1 && g_mock.lastProgram == 3);
+    GLWIN_CHECK(g_mock.enable == 1 && g_mock.disable == 1);
+    GLWIN_CHECK(gl.GetFrameStats().issued == 3 && gl.GetFrameStats().elided == 2);
+}
+
+GLWIN_TEST(GLStateVertexArrayOwnsElementBuffer)
+{
+    MockGLScope mock;
+    GLwinGLState& gl = GLwinGLState::Get();
+    gl.BindVertexArray(1);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 7);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 8);
+    GLWIN_CHECK(g_mock.bindBuffer == 2);
+
+    // the element binding is per VAO, the array binding is not
+    gl.BindVertexArray(2);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 7);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 8);
+    GLWIN_CHECK(g_mock.bindVertexArray == 2);
+    GLWIN_CHECK(g_mock.bindBuffer == 3);
+}
+
+GLWIN_TEST(GLStateTextureUnits)
+{
+    MockGLScope mock;
+    GLwinGLState& gl = GLwinGLState::Get();
+    gl.BindTexture(0, GL_TEXTURE_2D, 10);
+    gl.BindTexture(1, GL_TEXTURE_2D, 11);
+    GLWIN_CHECK(g_mock.activeTexture == 2 && g_mock.lastUnit == 1);
+    GLWIN_CHECK(g_mock.bindTexture == 2 && g_mock.lastTexture == 11);
+
+    // already bound on unit 0: neither the unit switch nor the bind is needed
+    gl.BindTexture(0, GL_TEXTURE_2D, 10);
+    GLWIN_CHECK(g_mock.activeTexture == 2 && g_mock.bindTexture == 2);
+    gl.BindTexture(0, GL_TEXTURE_2D, 12);
+    GLWIN_CHECK(g_mock.activeTexture == 3 && g_mock.lastUnit == 0 && g_mock.lastTexture == 12);
+}
+
+GLWIN_TEST(GLStateForgetRecycledName)
+{
+    MockGLScope mock;
+    GLwinGLState& gl = GLwinGLState::Get();
+    gl.UseProgram(5);
+    gl.ForgetProgram(5);
+    gl.UseProgram(5);
+    GLWIN_CHECK(g_mock.useProgram == 2);
+
+    gl.BindTexture(0, GL_TEXTURE_2D, 9);
+    gl.ForgetTexture(9);
+    gl.BindTexture(0, GL_TEXTURE_2D, 9);
+    GLWIN_CHECK(g_mock.bindTexture == 2);
+}
+
+GLWIN_TEST(GLStateResetsOnContextSwitch)
+{
+    MockGLScope mock;
+    GLwinGLState::Get().UseProgram(4);
+    GLwinGLState::Get().BindTexture(0, GL_TEXTURE_2D, 6);
+    GLwinGLState::Get().UseProgram(4);
+    GLWIN_CHECK(g_mock.useProgram == 1);
+
+    // another context made current behind the cache's back: its bindings are unknown
+    g_mock.context = &mock.contextB;
+    GLwinGLState::Get().UseProgram(4);
+    GLwinGLState::Get().BindTexture(0, GL_TEXTURE_2D, 6);
+    GLWIN_CHECK(g_mock.useProgram == 2);
+    GLWIN_CHECK(g_mock.bindTexture == 2);
+
+    // and back again: the cache only knows the last context
+    GLwinGLState::Get().UseProgram(4);
+    GLWIN_CHECK(g_mock.useProgram == 2);
+    g_mock.context = &mock.contextA;
+    GLwinGLState::Get().UseProgram(4);
+    GLWIN_CHECK(g_mock.useProgram == 3);
+}
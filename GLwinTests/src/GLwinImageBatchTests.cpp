@@ -0,0 +1,93 @@
+#include "GLwinTestHarness.h"
+#include "GLwinTestGL.h"
+#include "../../GLwinGUI/gui/GLwinImageAtlas.h"
+#include "../../GLwinGUI/Shader/GLwinShader.h"
+#include "GLwinGLState.h"
+
+// Flat quads straight in clip space, so the test needs neither the frame block nor the atlas
+static const char* kQuadVS = R"(#version 330 core
+layout(location = 0) in vec4 aRect;
+layout(location = 2) in vec4 aColor;
+out vec4 vColor;
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vColor = aColor;
+    gl_Position = vec4(aRect.xy + corner * aRect.zw, 0.0, 1.0);
+}
+)";
+
+static const char* kQuadFS = R"(#version 330 core
+in vec4 vColor;
+out vec4 FragColor;
+void main() { FragColor = vColor; }
+)";
+
+static uint32_t ReadCenter()
+{
+    uint32_t px = 0;
+    glReadPixels(2, 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &px);
+    return px;
+}
+
+// A window's quads go out on their own and the later windows' quads stay queued, in order
+GLWIN_TEST(ImageBatchFlushOwner)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+    GLwinGLState::Get().SetFunctions(GLwinGLFunctionsFromGlad());
+    GLwinGLState::Get().Reset();
+
+    Shader shader = Shader::FromSource(kQuadVS, kQuadFS);
+    GLWIN_CHECK(shader.IsLinked());
+    if (!shader.IsLinked()) return;
+
+    GLuint tex = 0, fbo = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+    glViewport(0, 0, 4, 4);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    {
+        GLwinImageAtlas atlas;
+        GLwinImageBatch batch;
+        int back = 0, front = 0;
+        const uint32_t red = 0xFF0000FFu, green = 0xFF00FF00u, blue = 0xFFFF0000u;
+        batch.Add(-1.0f, -1.0f, 2.0f, 2.0f, GLWIN_IMAGE_NONE, red, &back);
+        batch.Add(-1.0f, -1.0f, 2.0f, 2.0f, GLWIN_IMAGE_NONE, green, &front);
+        batch.Add(-1.0f, -1.0f, 2.0f, 2.0f, GLWIN_IMAGE_NONE, blue, &back);
+
+        batch.FlushOwner(atlas, &shader, &back);
+        GLWIN_CHECK(batch.GetCount() == 1);
+        GLWIN_CHECK(ReadCenter() == blue);
+
+        // nothing queued for this owner: no draw, the rest untouched
+        batch.FlushOwner(atlas, &shader, &back);
+        GLWIN_CHECK(batch.GetCount() == 1);
+
+        // the front window drawn over the back one
+        glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        batch.FlushOwner(atlas, &shader, &front);
+        GLWIN_CHECK(batch.GetCount() == 0);
+        GLWIN_CHECK(ReadCenter() == green);
+
+        // unowned quads go out in Flush, which also reports the owner draws since the last one
+        batch.Add(-1.0f, -1.0f, 2.0f, 2.0f, GLWIN_IMAGE_NONE, red);
+        batch.Flush(atlas, &shader);
+        GLWIN_CHECK(batch.GetCount() == 0);
+        GLWIN_CHECK(batch.GetLastDrawCalls() == 3);
+        GLWIN_CHECK(ReadCenter() == red);
+        GLWIN_CHECK(glGetError() == GL_NO_ERROR);
+    }
+
+    GLwinGLState::Get().BindVertexArray(0);
+    GLwinGLState::Get().UseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &tex);
+    glDeleteProgram(shader.ID);
+}
@@ -0,0 +1,151 @@
+#include "GLwinTestHarness.h"
+#include "../../GLwinGUI/gui/GLwinLayout.h"
+#include <algorithm>
+
+static bool Contains(const std::vector<GLwinLayoutNode*>& v, GLwinLayoutNode* n)
+{
+    return std::find(v.begin(), v.end(), n) != v.end();
+}
+
+GLWIN_TEST(LayoutRowSplitsFlex)
+{
+    GLwinLayoutNode root(GLwinLayoutType::Row);
+    GLwinLayoutNode* fixed = root.AddChild(GLwinLayoutType::Column);
+    fixed->SetSize(GLWIN_AXIS_X, GLwinLayoutSize::Px(100.0f));
+    GLwinLayoutNode* a = root.AddChild(GLwinLayoutType::Column);
+    a->SetSize(GLWIN_AXIS_X, GLwinLayoutSize::Grow(1.0f));
+    GLwinLayoutNode* b = root.AddChild(GLwinLayoutType::Column);
+    b->SetSize(GLWIN_AXIS_X, GLwinLayoutSize::Grow(3.0f));
+    root.Arrange(0.0f, 0.0f, 500.0f, 50.0f);
+    GLWIN_CHECK(fixed->w == 100.0f);
+    GLWIN_CHECK(a->x == 100.0f && a->w == 100.0f);
+    GLWIN_CHECK(b->x == 200.0f && b->w == 300.0f);
+    GLWIN_CHECK(b->h == 50.0f);
+}
+
+GLWIN_TEST(LayoutResizeReportsOnlyMovedNodes)
+{
+    GLwinLayoutNode root(GLwinLayoutType::Dock);
+    GLwinLayoutNode* left = root.AddChild(GLwinLayoutType::Column);
+    left->SetDock(GLwinDock::Left);
+    left->SetSize(GLWIN_AXIS_X, GLwinLayoutSize::Px(200.0f));
+    GLwinLayoutNode* fill = root.AddChild(GLwinLayoutType::Column);
+    std::vector<GLwinLayoutNode*> changed;
+    root.Arrange(0.0f, 0.0f, 800.0f, 600.0f, &changed);
+
+    // wider only: the left panel keeps its rect
+    changed.clear();
+    root.Arrange(0.0f, 0.0f, 1000.0f, 600.0f, &changed);
+    GLWIN_CHECK(Contains(changed, fill));
+    GLWIN_CHECK(!Contains(changed, left));
+
+    changed.clear();
+    root.Arrange(0.0f, 0.0f, 1000.0f, 600.0f, &changed);
+    GLWIN_CHECK(changed.empty());
+}
+
+GLWIN_TEST(LayoutSetGuiOnArrangedNodeReportsIt)
+{
+    GLwinLayoutNode root(GLwinLayoutType::Column);
+    GLwinLayoutNode* mid = root.AddChild(GLwinLayoutType::Row);
+    GLwinLayoutNode* leaf = mid->AddChild(GLwinLayoutType::Column);
+    std::vector<GLwinLayoutNode*> changed;
+    root.Arrange(0.0f, 0.0f, 400.0f, 300.0f, &changed);
+
+    // nothing moves, but the gui attached since has never been given the rect
+    BaseGui gui;
+    leaf->SetGui(&gui);
+    changed.clear();
+    root.Arrange(0.0f, 0.0f, 400.0f, 300.0f, &changed);
+    GLWIN_CHECK(changed.size() == 1 && changed[0] == leaf);
+
+    changed.clear();
+    root.Arrange(0.0f, 0.0f, 400.0f, 300.0f, &changed);
+    GLWIN_CHECK(changed.empty());
+}
+
+GLWIN_TEST(LayoutContentChangeDirtiesAncestors)
+{
+    GLwinLayoutNode root(GLwinLayoutType::Row);
+    GLwinLayoutNode* col = root.AddChild(GLwinLayoutType::Column);
+    GLwinLayoutNode* leaf = col->AddChild(GLwinLayoutType::Column);
+    GLwinLayoutNode* after = root.AddChild(GLwinLayoutType::Column);
+    leaf->SetContentSize(50.0f, 10.0f);
+    root.Arrange(0.0f, 0.0f, 400.0f, 100.0f);
+    GLWIN_CHECK(after->x == 50.0f);
+
+    leaf->SetContentSize(80.0f, 10.0f);
+    root.Arrange(0.0f, 0.0f, 400.0f, 100.0f);
+    GLWIN_CHECK(col->w == 80.0f);
+    GLWIN_CHECK(after->x == 80.0f);
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks: a deep chain and a wide row, each arranged cold, re-arranged with nothing
+// changed, resized, and re-arranged after one leaf changed its content.
+// -----------------------------------------------------------------------------
+
+static const int kDeepDepth = 1000;
+static const int kWideCount = 10000;
+
+static GLwinLayoutNode* BuildDeep(GLwinLayoutNode& root)
+{
+    GLwinLayoutNode* n = &root;
+    for (int i = 0; i < kDeepDepth; ++i) {
+        n = n->AddChild(i % 2 ? GLwinLayoutType::Row : GLwinLayoutType::Column);
+        n->SetPadding(0.01f);
+    }
+    n->SetContentSize(10.0f, 10.0f);
+    return n;
+}
+
+static GLwinLayoutNode* BuildWide(GLwinLayoutNode& root)
+{
+    GLwinLayoutNode* last = nullptr;
+    for (int i = 0; i < kWideCount; ++i) {
+        last = root.AddChild(GLwinLayoutType::Column);
+        if (i % 4 == 0) last->SetSize(GLWIN_AXIS_X, GLwinLayoutSize::Grow(1.0f));
+        else last->SetContentSize(2.0f, 20.0f);
+    }
+    return last;
+}
+
+template <typename Build>
+static void BenchTree(const char* label, GLwinLayoutType rootType, Build build)
+{
+    const int repeats = 20;
+    char what[96];
+    std::vector<GLwinLayoutNode*> changed;
+    changed.reserve(kWideCount + 1);
+
+    double cold = 1e300, cached = 1e300, resize = 1e300, content = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        GLwinLayoutNode root(rootType);
+        GLwinLayoutNode* leaf = build(root);
+        cold = std::min(cold, GLwinBenchBestNs(1, [&] { changed.clear(); root.Arrange(0.0f, 0.0f, 1920.0f, 1080.0f, &changed); }));
+        cached = std::min(cached, GLwinBenchBestNs(1, [&] { changed.clear(); root.Arrange(0.0f, 0.0f, 1920.0f, 1080.0f, &changed); }));
+        // only the height changes: the X axis measures stay cached
+        resize = std::min(resize, GLwinBenchBestNs(1, [&] { changed.clear(); root.Arrange(0.0f, 0.0f, 1920.0f, 1000.0f + (float)r, &changed); }));
+        leaf->SetContentSize(12.0f + (float)r, 10.0f);
+        content = std::min(content, GLwinBenchBestNs(1, [&] { changed.clear(); root.Arrange(0.0f, 0.0f, 1920.0f, 1000.0f + (float)r, &changed); }));
+        GLwinBenchKeep(changed.data());
+    }
+    snprintf(what, sizeof(what), "%s: first arrange", label);
+    GLwinBenchReport(what, cold);
+    snprintf(what, sizeof(what), "%s: arrange, nothing changed", label);
+    GLwinBenchReport(what, cached);
+    snprintf(what, sizeof(what), "%s: arrange after a height change", label);
+    GLwinBenchReport(what, resize);
+    snprintf(what, sizeof(what), "%s: arrange after one leaf's content changed", label);
+    GLwinBenchReport(what, content);
+}
+
+GLWIN_BENCH(LayoutDeepTree)
+{
+    BenchTree("deep (1000 levels)", GLwinLayoutType::Column, BuildDeep);
+}
+
+GLWIN_BENCH(LayoutWideTree)
+{
+    BenchTree("wide (10000 children)", GLwinLayoutType::Row, BuildWide);
+}
@@ -0,0 +1,109 @@
+#include "GLwinTestHarness.h"
+#include "../../GLwin/include/GLwinLog.h"
+#include "../../GLwin/include/GLwinLogFile.h"
+#include "../../GLwin/include/GLwinResource.h"
+#include <filesystem>
+#include <string>
+#include <thread>
+
+// The logger is process wide: each test writes its records to a binary log file of its own,
+// reads them back, then turns the console back on.
+struct LogCapture {
+    std::string path;
+    std::vector<std::string> texts;
+    std::vector<uint32_t> threads;
+
+    LogCapture(const char* name) {
+        path = (std::filesystem::temp_directory_path() / name).string();
+        GLwinLogSetConsole(0);
+        GLWIN_CHECK(GLwinLogOpenFile(path.c_str()));
+    }
+    // Close the file and collect the plain text records in file order
+    void Read() {
+        GLwinLogCloseFile();
+        GLwinLogSetConsole(1);
+        GLwinFileView view;
+        GLWIN_CHECK(GLwinMapFile(path.c_str(), &view));
+        GLwinLogFileReader reader;
+        GLWIN_CHECK(reader.Open(view.data, view.size));
+        GLwinLogFileEntry entry;
+        while (reader.Next(&entry)) {
+            if (entry.kind != GLWIN_LOGFILE_RECORD || entry.siteId != 0) continue;
+            texts.emplace_back(entry.payload, entry.length);
+            threads.push_back(entry.thread);
+        }
+        GLWIN_CHECK(!reader.IsDamaged());
+        GLwinUnmapFile(&view);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+};
+
+static std::string Pattern(size_t n)
+{
+    std::string s;
+    for (size_t i = 0; i < n; ++i) s += (char)('a' + i % 26);
+    return s;
+}
+
+GLWIN_TEST(LogLongMessageContinues)
+{
+    // about what a failed shader compile logs
+    std::string message = Pattern(1000);
+    LogCapture capture("glwin_log_long.glwl");
+    GLWIN_LOG_ERROR("info log: " << message);
+    capture.Read();
+
+    std::string joined;
+    for (size_t i = 0; i < capture.texts.size(); ++i) {
+        const std::string& t = capture.texts[i];
+        GLWIN_CHECK(t.size() <= GLWIN_LOG_MAX_MESSAGE);
+        if (i == 0) joined += t;
+        else if (t.compare(0, 3, "...") == 0) joined += t.substr(3);
+    }
+    GLWIN_CHECK(capture.texts.size() == 5);
+    GLWIN_CHECK(joined == "info log: " + message);
+}
+
+GLWIN_TEST(LogOverlongMessageIsMarkedTruncated)
+{
+    std::string message = Pattern(GLWIN_LOG_MAX_MESSAGE * GLWIN_LOG_MAX_PARTS * 2);
+    LogCapture capture("glwin_log_truncated.glwl");
+    GLwinLogWrite(GLWIN_LOG_LEVEL_ERROR, message.data(), message.size());
+    capture.Read();
+
+    GLWIN_CHECK(capture.texts.size() == GLWIN_LOG_MAX_PARTS);
+    const std::string& last = capture.texts.back();
+    GLWIN_CHECK(last.size() > 14 && last.compare(last.size() - 14, 14, "...[truncated]") == 0);
+    GLWIN_CHECK(capture.texts[0] == message.substr(0, GLWIN_LOG_MAX_MESSAGE));
+}
+
+// Logs from its destructor, at thread exit
+struct LogOnThreadExit {
+    bool armed = false;
+    ~LogOnThreadExit() {
+        if (armed) GLWIN_LOG_ERROR("logged from a thread_local destructor");
+    }
+};
+
+GLWIN_TEST(LogFromThreadLocalDestructor)
+{
+    LogCapture capture("glwin_log_thread_exit.glwl");
+    std::thread worker([] {
+        // constructed before the thread's ring, so destroyed after it has been handed back
+        static thread_local LogOnThreadExit late;
+        late.armed = true;
+        GLWIN_LOG_ERROR("worker running");
+    });
+    worker.join();
+    capture.Read();
+
+    bool running = false, late = false;
+    for (size_t i = 0; i < capture.texts.size(); ++i) {
+        running |= capture.texts[i] == "worker running" && capture.threads[i] != 0;
+        // the ring was gone by then: written straight through, without a ring's thread id
+        late |= capture.texts[i] == "logged from a thread_local destructor" && capture.threads[i] == 0;
+    }
+    GLWIN_CHECK(running);
+    GLWIN_CHECK(late);
+}
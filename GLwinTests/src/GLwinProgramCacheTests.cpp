@@ -0,0 +1,44 @@
+#include "GLwinTestHarness.h"
+#include "GLwinTestGL.h"
+#include "../../GLwinGUI/Shader/GLwinProgramCache.h"
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+// An entry whose header claims more payload than the file holds is dropped without allocating it
+GLWIN_TEST(ProgramCacheRejectsOversizedLength)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "GLwinProgramCacheTests";
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    GLwinProgramCache cache(dir.string());
+    if (!cache.IsAvailable()) {
+        printf("  skipped: no program binary formats\n");
+        return;
+    }
+    uint64_t key = cache.MakeKey("vs", "fs", "", "");
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.glbin", (unsigned long long)key);
+    std::filesystem::path path = dir / name;
+
+    // header layout from GLwinProgramCache.h, packed
+    {
+        std::ofstream file(path, std::ios::binary);
+        const uint32_t version = 1, format = 0, length = 0xFFFFFFF0u;
+        const uint64_t payloadHash = 0;
+        file.write("GLPB", 4);
+        file.write(reinterpret_cast<const char*>(&version), 4);
+        file.write(reinterpret_cast<const char*>(&key), 8);
+        file.write(reinterpret_cast<const char*>(&format), 4);
+        file.write(reinterpret_cast<const char*>(&length), 4);
+        file.write(reinterpret_cast<const char*>(&payloadHash), 8);
+        file.write("payload", 7);
+    }
+
+    GLWIN_CHECK(cache.Load(key) == 0);
+    GLWIN_CHECK(!std::filesystem::exists(path));
+    std::filesystem::remove_all(dir, ec);
+}
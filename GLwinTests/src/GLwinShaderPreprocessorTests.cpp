@@ -0,0 +1,144 @@
+#include "GLwinTestHarness.h"
+#include "../../GLwinGUI/Shader/GLwinShaderPreprocessor.h"
+#include <map>
+
+// Sources are served from memory; names are resolved the way the preprocessor reports them
+struct MemoryFiles {
+    std::map<std::string, std::string> files;
+    int reads = 0;
+    void Add(const std::string& name, const std::string& text) { files[GLwinShaderPreprocessor::NormalisePath(name)] = text; }
+    GLwinShaderPreprocessor::FileLoader Loader() {
+        return [this](const std::string& path, std::string& out) {
+            auto it = files.find(path);
+            if (it == files.end()) return false;
+            ++reads;
+            out = it->second;
+            return true;
+        };
+    }
+};
+
+static bool Has(const std::string& text, const char* what)
+{
+    return text.find(what) != std::string::npos;
+}
+
+static size_t Where(const std::string& text, const char* what)
+{
+    return text.find(what);
+}
+
+GLWIN_TEST(PreprocessorExpandsIncludes)
+{
+    MemoryFiles mem;
+    mem.Add("pp/main.frag", "#version 330 core\n#include \"lib/common.glsl\"\nvoid main() { Common(); }\n");
+    mem.Add("pp/lib/common.glsl", "#pragma once\n#include \"math.glsl\"\nvoid Common() {}\n");
+    mem.Add("pp/lib/math.glsl", "float Twice(float x) { return x * 2.0; }\n");
+    GLwinShaderPreprocessor pp(mem.Loader());
+
+    GLwinShaderPreprocessor::Result r = pp.Process("pp/main.frag");
+    GLWIN_CHECK(r.ok);
+    // includes resolve relative to the including file, in order of first use
+    GLWIN_CHECK(r.files.size() == 3);
+    GLWIN_CHECK(r.files.size() == 3 && r.files[2] == GLwinShaderPreprocessor::NormalisePath("pp/lib/math.glsl"));
+    GLWIN_CHECK(Where(r.source, "float Twice") < Where(r.source, "void Common"));
+    GLWIN_CHECK(Where(r.source, "void Common") < Where(r.source, "void main"));
+    GLWIN_CHECK(!Has(r.source, "#include") && !Has(r.source, "#pragma once"));
+    // back in the root after the include: line 3 of file 0
+    GLWIN_CHECK(Has(r.source, "#line 1 1\n") && Has(r.source, "#line 3 0\n"));
+}
+
+GLWIN_TEST(PreprocessorPragmaOnceAndComments)
+{
+    MemoryFiles mem;
+    mem.Add("pp/once.frag", "#version 330 core\n#include \"a.glsl\"\n#include \"a.glsl\" // again\n/* block\ncomment */ void main() {}\n");
+    mem.Add("pp/a.glsl", "#pragma once\nvoid A() {} // trailing\n");
+    GLwinShaderPreprocessor pp(mem.Loader());
+
+    GLwinShaderPreprocessor::Result r = pp.Process("pp/once.frag");
+    GLWIN_CHECK(r.ok);
+    size_t first = Where(r.source, "void A()");
+    GLWIN_CHECK(first != std::string::npos && r.source.find("void A()", first + 1) == std::string::npos);
+    GLWIN_CHECK(!Has(r.source, "trailing") && !Has(r.source, "block"));
+    // the block comment's newline is kept so line numbers still match
+    GLWIN_CHECK(Has(r.source, " \n void main()"));
+}
+
+GLWIN_TEST(PreprocessorInjectsDefinesAfterVersion)
+{
+    MemoryFiles mem;
+    mem.Add("pp/def.frag", "#version 330 core\n#ifdef SHADOWS\nuniform sampler2D shadowMap;\n#endif\n#if QUALITY > 1\nvoid main() {}\n#endif\n");
+    GLwinShaderPreprocessor pp(mem.Loader());
+
+    GLwinShaderPreprocessor::Result r = pp.Process("pp/def.frag", { "SHADOWS", "QUALITY=2" });
+    GLWIN_CHECK(r.ok);
+    GLWIN_CHECK(r.source.compare(0, 18, "#version 330 core\n") == 0);
+    // defines land between #version and the first #ifdef that tests them; the conditionals
+    // themselves are left to the GLSL compiler
+    GLWIN_CHECK(Has(r.source, "#define SHADOWS\n") && Has(r.source, "#define QUALITY 2\n"));
+    GLWIN_CHECK(Where(r.source, "#define SHADOWS") < Where(r.source, "#ifdef SHADOWS"));
+    GLWIN_CHECK(Where(r.source, "#define QUALITY 2") < Where(r.source, "#if QUALITY > 1"));
+    GLWIN_CHECK(Has(r.source, "#line 2 0\n#ifdef SHADOWS\n"));
+
+    GLwinShaderPreprocessor::Result plain = pp.Process("pp/def.frag");
+    GLWIN_CHECK(plain.ok && !Has(plain.source, "#define"));
+    GLWIN_CHECK(plain.key != r.key);
+}
+
+GLWIN_TEST(PreprocessorDefinesWithoutVersionGoFirst)
+{
+    MemoryFiles mem;
+    mem.Add("pp/noversion.glsl", "#ifdef FAST\nvoid F() {}\n#endif\n");
+    GLwinShaderPreprocessor pp(mem.Loader());
+    GLwinShaderPreprocessor::Result r = pp.Process("pp/noversion.glsl", { "FAST" });
+    GLWIN_CHECK(r.ok);
+    GLWIN_CHECK(r.source.compare(0, 22, "#define FAST\n#line 1 0") == 0);
+}
+
+GLWIN_TEST(PreprocessorMemoisesPermutations)
+{
+    MemoryFiles mem;
+    mem.Add("pp/memo.frag", "#version 330 core\n#include \"inc.glsl\"\n");
+    mem.Add("pp/inc.glsl", "void I() {}\n");
+    GLwinShaderPreprocessor pp(mem.Loader());
+
+    GLWIN_CHECK(pp.Process("pp/memo.frag", { "A", "B" }).ok);
+    GLWIN_CHECK(pp.Process("pp/memo.frag", { "B", "A" }).ok); // same set, other order
+    GLWIN_CHECK(pp.Process("pp/memo.frag", { "C" }).ok);
+    GLWIN_CHECK(pp.GetPermutationCount() == 2);
+    GLWIN_CHECK(mem.reads == 2); // each file parsed once for every permutation
+
+    // an edited include drops the permutations using it and is read again
+    mem.Add("pp/inc.glsl", "void I2() {}\n");
+    pp.Invalidate("pp/inc.glsl");
+    GLWIN_CHECK(pp.GetPermutationCount() == 0);
+    GLwinShaderPreprocessor::Result r = pp.Process("pp/memo.frag", { "C" });
+    GLWIN_CHECK(r.ok && Has(r.source, "void I2()"));
+    GLWIN_CHECK(mem.reads == 3);
+}
+
+GLWIN_TEST(PreprocessorReportsErrors)
+{
+    MemoryFiles mem;
+    mem.Add("pp/missing.frag", "#version 330 core\n#include \"nope.glsl\"\n");
+    mem.Add("pp/malformed.frag", "#version 330 core\n\n#include \"broken.glsl\n");
+    mem.Add("pp/cycle_a.glsl", "#include \"cycle_b.glsl\"\n");
+    mem.Add("pp/cycle_b.glsl", "#include \"cycle_a.glsl\"\n");
+    GLwinShaderPreprocessor pp(mem.Loader());
+
+    GLwinShaderPreprocessor::Result r = pp.Process("pp/missing.frag");
+    GLWIN_CHECK(!r.ok && r.source.empty());
+    GLWIN_CHECK(Has(r.error, "cannot read") && Has(r.error, "nope.glsl"));
+
+    r = pp.Process("pp/malformed.frag");
+    GLWIN_CHECK(!r.ok);
+    GLWIN_CHECK(Has(r.error, "malformed.frag:3: malformed #include"));
+
+    r = pp.Process("pp/cycle_a.glsl");
+    GLWIN_CHECK(!r.ok && Has(r.error, "include cycle through") && Has(r.error, "cycle_a.glsl"));
+
+    // failures aren't memoised: fixing the file fixes the next Process
+    GLWIN_CHECK(pp.GetPermutationCount() == 0);
+    mem.Add("pp/nope.glsl", "void N() {}\n");
+    GLWIN_CHECK(pp.Process("pp/missing.frag").ok);
+}
@@ -0,0 +1,44 @@
+#include "GLwinTestHarness.h"
+#include "GLwinTestGL.h"
+#include "../../GLwinGUI/Shader/GLwinShader.h"
+
+static const char* kArrayVS = R"(#version 330 core
+layout(location = 0) in vec3 aPos;
+void main() { gl_Position = vec4(aPos, 1.0); }
+)";
+
+static const char* kArrayFS = R"(#version 330 core
+uniform vec3 lights[4];
+uniform float weights[3];
+out vec4 FragColor;
+void main() {
+    vec3 c = vec3(0.0);
+    for (int i = 0; i < 4; ++i) c += lights[i] * weights[i % 3];
+    FragColor = vec4(c, 1.0);
+}
+)";
+
+// String setters reach every element of an array, like glGetUniformLocation did
+GLWIN_TEST(ShaderReflectionArrayElements)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+    Shader shader = Shader::FromSource(kArrayVS, kArrayFS);
+    GLWIN_CHECK(shader.IsLinked());
+    if (!shader.IsLinked()) return;
+
+    for (const char* name : { "lights", "lights[0]", "lights[1]", "lights[3]", "weights[2]" }) {
+        GLWIN_CHECK(shader.GetUniformLocation(name) == glGetUniformLocation(shader.ID, name));
+        GLWIN_CHECK(shader.GetUniformLocation(name) >= 0);
+    }
+    GLWIN_CHECK(shader.GetUniformLocation("lights[4]") == -1);
+    GLWIN_CHECK(shader.GetUniformInfo("lights[1]") && shader.GetUniformInfo("lights[1]")->size == 3);
+
+    glUseProgram(shader.ID);
+    shader.setVec3("lights[2]", glm::vec3(1.0f, 2.0f, 3.0f));
+    GLfloat v[3] = {};
+    glGetUniformfv(shader.ID, glGetUniformLocation(shader.ID, "lights[2]"), v);
+    GLWIN_CHECK(v[0] == 1.0f && v[1] == 2.0f && v[2] == 3.0f);
+    GLWIN_CHECK(glGetError() == GL_NO_ERROR);
+    glUseProgram(0);
+    glDeleteProgram(shader.ID);
+}
@@ -0,0 +1,114 @@
+#include "GLwinTestHarness.h"
+#include "GLwinTestGL.h"
+#include "../../GLwinGUI/Shader/GLwinShader.h"
+#include "../../GLwinGUI/vendors/glm/gtc/matrix_transform.hpp"
+
+// Uniform-heavy frame: 1000 draws, each setting the eight uniforms below. Compares the old
+// per-call glGetUniformLocation with the reflected table (string setters) and typed handles.
+// The draw calls themselves are left out so only the per-draw uniform cost is measured.
+
+static const char* kUniformVS = R"(#version 330 core
+layout(location = 0) in vec3 aPos;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec2 offset;
+uniform float time;
+out vec2 vOffset;
+void main() {
+    vOffset = offset * time;
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)";
+
+static const char* kUniformFS = R"(#version 330 core
+in vec2 vOffset;
+uniform vec3 color;
+uniform vec4 tint;
+uniform int mode;
+out vec4 FragColor;
+void main() {
+    vec4 c = vec4(color, 1.0) * tint;
+    FragColor = mode == 1 ? c + vec4(vOffset, 0.0, 0.0) : c;
+}
+)";
+
+static const int kDraws = 1000;
+
+GLWIN_BENCH(ShaderUniformsPerDraw)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+    Shader shader = Shader::FromSource(kUniformVS, kUniformFS);
+    GLWIN_CHECK(shader.IsLinked());
+    if (!shader.IsLinked()) return;
+    glUseProgram(shader.ID);
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(0.8f, 16.0f / 9.0f, 0.1f, 100.0f);
+    std::vector<glm::mat4> models(kDraws);
+    for (int i = 0; i < kDraws; ++i) models[i] = glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, 0.0f));
+    const glm::vec3 color(0.2f, 0.4f, 0.6f);
+    const glm::vec4 tint(1.0f, 1.0f, 1.0f, 0.5f);
+    const glm::vec2 offset(0.25f, 0.5f);
+
+    GLuint id = shader.ID;
+    auto lookupEveryCall = [&] {
+        for (int i = 0; i < kDraws; ++i) {
+            glUniformMatrix4fv(glGetUniformLocation(id, std::string("model").c_str()), 1, GL_FALSE, &models[i][0][0]);
+            glUniformMatrix4fv(glGetUniformLocation(id, std::string("view").c_str()), 1, GL_FALSE, &view[0][0]);
+            glUniformMatrix4fv(glGetUniformLocation(id, std::string("projection").c_str()), 1, GL_FALSE, &projection[0][0]);
+            glUniform3fv(glGetUniformLocation(id, std::string("color").c_str()), 1, &color[0]);
+            glUniform4fv(glGetUniformLocation(id, std::string("tint").c_str()), 1, &tint[0]);
+            glUniform2fv(glGetUniformLocation(id, std::string("offset").c_str()), 1, &offset[0]);
+            glUniform1f(glGetUniformLocation(id, std::string("time").c_str()), (float)i);
+            glUniform1i(glGetUniformLocation(id, std::string("mode").c_str()), i & 1);
+        }
+    };
+    auto stringSetters = [&] {
+        for (int i = 0; i < kDraws; ++i) {
+            shader.setMat4("model", models[i]);
+            shader.setMat4("view", view);
+            shader.setMat4("projection", projection);
+            shader.setVec3("color", color);
+            shader.setVec4("tint", tint);
+            shader.setVec2("offset", offset);
+            shader.setFloat("time", (float)i);
+            shader.setInt("mode", i & 1);
+        }
+    };
+
+    Shader::Uniform<glm::mat4> uModel = shader.GetUniform<glm::mat4>("model");
+    Shader::Uniform<glm::mat4> uView = shader.GetUniform<glm::mat4>("view");
+    Shader::Uniform<glm::mat4> uProjection = shader.GetUniform<glm::mat4>("projection");
+    Shader::Uniform<glm::vec3> uColor = shader.GetUniform<glm::vec3>("color");
+    Shader::Uniform<glm::vec4> uTint = shader.GetUniform<glm::vec4>("tint");
+    Shader::Uniform<glm::vec2> uOffset = shader.GetUniform<glm::vec2>("offset");
+    Shader::Uniform<float> uTime = shader.GetUniform<float>("time");
+    Shader::Uniform<int> uMode = shader.GetUniform<int>("mode");
+    GLWIN_CHECK(uModel.IsValid() && uView.IsValid() && uProjection.IsValid() && uColor.IsValid());
+    GLWIN_CHECK(uTint.IsValid() && uOffset.IsValid() && uTime.IsValid() && uMode.IsValid());
+    auto typedHandles = [&] {
+        for (int i = 0; i < kDraws; ++i) {
+            shader.setMat4(uModel, models[i]);
+            shader.setMat4(uView, view);
+            shader.setMat4(uProjection, projection);
+            shader.setVec3(uColor, color);
+            shader.setVec4(uTint, tint);
+            shader.setVec2(uOffset, offset);
+            shader.setFloat(uTime, (float)i);
+            shader.setInt(uMode, i & 1);
+        }
+    };
+
+    const int repeats = 30;
+    // warm up the driver's paths once before timing
+    lookupEveryCall(); stringSetters(); typedHandles();
+    glFinish();
+    GLwinBenchReport("glGetUniformLocation every call, per draw", GLwinBenchBestNs(repeats, lookupEveryCall) / kDraws);
+    glFinish();
+    GLwinBenchReport("string setters (reflected table), per draw", GLwinBenchBestNs(repeats, stringSetters) / kDraws);
+    glFinish();
+    GLwinBenchReport("typed handles, per draw", GLwinBenchBestNs(repeats, typedHandles) / kDraws);
+    GLWIN_CHECK(glGetError() == GL_NO_ERROR);
+    glDeleteProgram(shader.ID);
+}
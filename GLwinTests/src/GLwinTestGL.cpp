@@ -0,0 +1,31 @@
+#include "GLwinTestGL.h"
+#include <glad/glad.h>
+#include <GLwinContext.h>
+#include <stdio.h>
+
+static GLWIN_context* g_GLwinTestContext = nullptr;
+
+bool GLwinTestMakeGLCurrent()
+{
+    GLWIN_context*& context = g_GLwinTestContext;
+    static bool tried = false;
+    if (!tried) {
+        tried = true;
+        context = GLwinCreateOffscreenContext(nullptr);
+        if (context && (!GLwinMakeOffscreenContextCurrent(context) || !gladLoadGLLoader((GLADloadproc)GLwinGetProcAddress))) {
+            GLwinDestroyContext(context);
+            context = nullptr;
+        }
+        if (context) printf("  (GL %s, %s)\n", (const char*)glGetString(GL_VERSION), (const char*)glGetString(GL_RENDERER));
+    }
+    if (!context) {
+        printf("  skipped: no OpenGL context\n");
+        return false;
+    }
+    return GLwinMakeOffscreenContextCurrent(context) != 0;
+}
+
+GLWIN_context* GLwinTestGetGLContext()
+{
+    return g_GLwinTestContext;
+}
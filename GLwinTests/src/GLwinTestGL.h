@@ -0,0 +1,10 @@
+#pragma once
+
+typedef struct GLWIN_context GLWIN_context;
+
+// Offscreen GL context for the cases that need one: a WGL helper window on Windows, EGL
+// (surfaceless on Mesa, e.g. llvmpipe) elsewhere. Created on first use, made current on the
+// calling thread, glad loaded. Returns false when no context can be had; the case then skips.
+bool GLwinTestMakeGLCurrent();
+// That context, for creating others that share with it (NULL before GLwinTestMakeGLCurrent)
+GLWIN_context* GLwinTestGetGLContext();
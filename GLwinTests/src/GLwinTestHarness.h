@@ -0,0 +1,80 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+// Minimal test/benchmark registry for GLwinTests. No framework on purpose: a case is a plain
+// function registered by the macro, a failed check prints file:line and carries on.
+//
+//   GLWIN_TEST(LayoutKeepsRects) { GLWIN_CHECK(node.w == 100.0f); }
+//   GLWIN_BENCH(LayoutDeepResize) { ... GLwinBenchReport("resize", ns, count); }
+
+struct GLwinTestCase {
+    const char* name;
+    void (*fn)();
+    bool bench;
+};
+
+inline std::vector<GLwinTestCase>& GLwinTestRegistry()
+{
+    static std::vector<GLwinTestCase> cases;
+    return cases;
+}
+
+struct GLwinTestRegistrar {
+    GLwinTestRegistrar(const char* name, void (*fn)(), bool bench) { GLwinTestRegistry().push_back({ name, fn, bench }); }
+};
+
+inline int& GLwinTestFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline void GLwinTestFail(const char* file, int line, const char* expr)
+{
+    fprintf(stderr, "  FAILED %s(%d): %s\n", file, line, expr);
+    ++GLwinTestFailures();
+}
+
+#define GLWIN_TEST(name) \
+    static void name(); \
+    static GLwinTestRegistrar name##_registrar(#name, name, false); \
+    static void name()
+
+#define GLWIN_BENCH(name) \
+    static void name(); \
+    static GLwinTestRegistrar name##_registrar(#name, name, true); \
+    static void name()
+
+#define GLWIN_CHECK(expr) \
+    do { if (!(expr)) GLwinTestFail(__FILE__, __LINE__, #expr); } while (0)
+
+// Best of `repeats` runs of fn, in nanoseconds per call
+template <typename Fn>
+double GLwinBenchBestNs(int repeats, Fn&& fn)
+{
+    double best = 1e300;
+    for (int i = 0; i < repeats; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+inline void GLwinBenchReport(const char* what, double ns)
+{
+    if (ns >= 1e6) printf("  %-56s %10.3f ms\n", what, ns / 1e6);
+    else if (ns >= 1e3) printf("  %-56s %10.3f us\n", what, ns / 1e3);
+    else printf("  %-56s %10.1f ns\n", what, ns);
+}
+
+// Keeps the optimiser from dropping a benchmarked result
+inline const void* volatile g_GLwinBenchSink = nullptr;
+inline void GLwinBenchKeep(const void* p)
+{
+    g_GLwinBenchSink = p;
+}
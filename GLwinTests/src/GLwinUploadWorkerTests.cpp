@@ -0,0 +1,94 @@
+#include "GLwinTestHarness.h"
+#include "GLwinTestGL.h"
+#include <GLwinUploadWorker.h>
+#include <GLwinContext.h>
+#include <chrono>
+#include <thread>
+
+static const int kTextures = 16;
+static const int kSize = 4;
+
+static uint32_t Texel(int texture, int i)
+{
+    return 0xFF000000u | ((uint32_t)texture << 16) | ((uint32_t)i << 8) | 0x5Au;
+}
+
+// Textures are filled on the worker's context and read back on the test's own context
+GLWIN_TEST(UploadWorkerHandsOverByFence)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+    GLWIN_context* context = GLwinCreateOffscreenContext(GLwinTestGetGLContext());
+    GLWIN_CHECK(context != nullptr);
+    if (!context) return;
+
+    GLuint textures[kTextures];
+    glGenTextures(kTextures, textures);
+    for (GLuint t : textures) {
+        glBindTexture(GL_TEXTURE_2D, t);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kSize, kSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // the storage has to exist before the worker writes into it
+    glFinish();
+
+    std::vector<int> order;
+    int wrongThread = 0;
+    {
+        GLwinUploadWorker worker(context, "TestUpload");
+        GLWIN_CHECK(worker.IsRunning());
+        const std::thread::id renderThread = std::this_thread::get_id();
+        for (int i = 0; i < kTextures; ++i) {
+            GLuint tex = textures[i];
+            worker.Submit([tex, i] {
+                uint32_t pixels[kSize * kSize];
+                for (int p = 0; p < kSize * kSize; ++p) pixels[p] = Texel(i, p);
+                glBindTexture(GL_TEXTURE_2D, tex);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kSize, kSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }, [&order, &wrongThread, renderThread, i] {
+                order.push_back(i);
+                if (std::this_thread::get_id() != renderThread) ++wrongThread;
+            });
+        }
+
+        // Poll never blocks; keep going until everything has been handed over
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (worker.GetPendingCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+            worker.Poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        GLWIN_CHECK(worker.GetPendingCount() == 0);
+    }
+
+    GLWIN_CHECK((int)order.size() == kTextures);
+    for (int i = 0; i < (int)order.size(); ++i) GLWIN_CHECK(order[i] == i);
+    GLWIN_CHECK(wrongThread == 0);
+
+    int bad = 0;
+    for (int i = 0; i < kTextures; ++i) {
+        uint32_t pixels[kSize * kSize] = {};
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        for (int p = 0; p < kSize * kSize; ++p) bad += pixels[p] != Texel(i, p);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLWIN_CHECK(bad == 0);
+    GLWIN_CHECK(glGetError() == GL_NO_ERROR);
+    glDeleteTextures(kTextures, textures);
+}
+
+GLWIN_TEST(UploadWorkerFinishRunsEveryReadyCallback)
+{
+    if (!GLwinTestMakeGLCurrent()) return;
+    GLWIN_context* context = GLwinCreateOffscreenContext(GLwinTestGetGLContext());
+    if (!context) return;
+
+    int ran = 0, ready = 0;
+    GLwinUploadWorker worker(context, "TestFinish");
+    for (int i = 0; i < 64; ++i) worker.Submit([&ran] { ++ran; }, [&ready] { ++ready; });
+    worker.Finish();
+    GLWIN_CHECK(ran == 64);
+    GLWIN_CHECK(ready == 64);
+    GLWIN_CHECK(worker.GetPendingCount() == 0);
+    GLWIN_CHECK(worker.Poll() == 0);
+}
@@ -0,0 +1,34 @@
+#include "GLwinTestHarness.h"
+#include <string.h>
+
+// GLwinTests: unit tests for the GLwin/GLwinGUI pieces that run without a window, and the
+// benchmarks their performance claims rest on.
+//
+//   GLwinTests                 run every test
+//   GLwinTests --bench         run the benchmarks instead (build Release for real numbers)
+//   GLwinTests [--bench] name  only cases whose name contains `name`
+//
+// Exit code is the number of failed checks.
+
+int main(int argc, char** argv)
+{
+    bool bench = false;
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--bench") == 0) bench = true;
+        else filter = argv[i];
+    }
+
+    int ran = 0;
+    for (const GLwinTestCase& c : GLwinTestRegistry()) {
+        if (c.bench != bench) continue;
+        if (filter && !strstr(c.name, filter)) continue;
+        int before = GLwinTestFailures();
+        printf("%s\n", c.name);
+        c.fn();
+        if (GLwinTestFailures() != before) printf("  ...failed\n");
+        ++ran;
+    }
+    printf("%d %s, %d failed check(s)\n", ran, bench ? "benchmark(s)" : "test(s)", GLwinTestFailures());
+    return GLwinTestFailures();
+}